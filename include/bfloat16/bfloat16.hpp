@@ -10,12 +10,15 @@
 #ifndef BFLOAT16_HPP
 #define BFLOAT16_HPP
 
+#include <compare>
 #include <cstdint>
 #include <cmath>
 #include <limits>
 #include <bit>
 #include <iostream>
 
+#include <bfloat16/detail/constexpr_math.hpp>
+
 namespace bf16 {
 
 	class bfloat16_t {
@@ -53,91 +56,150 @@ namespace bf16 {
 			}
 
 			// Comparison operators
-			auto operator<=>(const bfloat16_t& other) const noexcept = default;
-			bool operator==(const bfloat16_t& other) const noexcept = default;
+			// Ordering and equality follow the values (the raw bits order negatives
+			// backwards): NaN != NaN and -0 == +0. bitwise_equal compares the bits.
+			constexpr std::partial_ordering operator<=>(const bfloat16_t& other) const noexcept {
+				return static_cast<float>(*this) <=> static_cast<float>(other);
+			}
+			constexpr bool operator==(const bfloat16_t& other) const noexcept {
+				return static_cast<float>(*this) == static_cast<float>(other);
+			}
 
 			// Arithmetic operators
-			bfloat16_t operator-() const noexcept {
+			constexpr bfloat16_t operator-() const noexcept {
 				bfloat16_t result;
 				result.data = data ^ SIGN_MASK; // Flip sign bit
 				return result;
 			}
 
-			bfloat16_t& operator+=(const bfloat16_t& other) noexcept {
+			constexpr bfloat16_t& operator+=(const bfloat16_t& other) noexcept {
 				*this = static_cast<float>(*this) + static_cast<float>(other);
 				return *this;
 			}
 
-			bfloat16_t& operator-=(const bfloat16_t& other) noexcept {
+			constexpr bfloat16_t& operator-=(const bfloat16_t& other) noexcept {
 				*this = static_cast<float>(*this) - static_cast<float>(other);
 				return *this;
 			}
 
-			bfloat16_t& operator*=(const bfloat16_t& other) noexcept {
+			constexpr bfloat16_t& operator*=(const bfloat16_t& other) noexcept {
 				*this = static_cast<float>(*this) * static_cast<float>(other);
 				return *this;
 			}
 
-			bfloat16_t& operator/=(const bfloat16_t& other) noexcept {
+			constexpr bfloat16_t& operator/=(const bfloat16_t& other) noexcept {
 				*this = static_cast<float>(*this) / static_cast<float>(other);
 				return *this;
 			}
 
 			// Binary arithmetic operators
-			friend bfloat16_t operator+(bfloat16_t lhs, const bfloat16_t& rhs) noexcept {
+			friend constexpr bfloat16_t operator+(bfloat16_t lhs, const bfloat16_t& rhs) noexcept {
 				lhs += rhs;
 				return lhs;
 			}
 
-			friend bfloat16_t operator-(bfloat16_t lhs, const bfloat16_t& rhs) noexcept {
+			friend constexpr bfloat16_t operator-(bfloat16_t lhs, const bfloat16_t& rhs) noexcept {
 				lhs -= rhs;
 				return lhs;
 			}
 
-			friend bfloat16_t operator*(bfloat16_t lhs, const bfloat16_t& rhs) noexcept {
+			friend constexpr bfloat16_t operator*(bfloat16_t lhs, const bfloat16_t& rhs) noexcept {
 				lhs *= rhs;
 				return lhs;
 			}
 
-			friend bfloat16_t operator/(bfloat16_t lhs, const bfloat16_t& rhs) noexcept {
+			friend constexpr bfloat16_t operator/(bfloat16_t lhs, const bfloat16_t& rhs) noexcept {
 				lhs /= rhs;
 				return lhs;
 			}
 
+			// Mixed bf16/float operators: the bf16 side is widened exactly and the
+			// result stays in fp32, so fp32 accumulators are never rounded to bf16
+			// mid-expression. Without these, bf16 op float is ambiguous between the
+			// bf16 operators and the built-in float ones.
+			constexpr std::partial_ordering operator<=>(float other) const noexcept {
+				return static_cast<float>(*this) <=> other;
+			}
+
+			constexpr bool operator==(float other) const noexcept {
+				return static_cast<float>(*this) == other;
+			}
+
+			// bf16 op= float rounds to bf16 once, after the fp32 operation
+			constexpr bfloat16_t& operator+=(float other) noexcept {
+				*this = static_cast<float>(*this) + other;
+				return *this;
+			}
+
+			constexpr bfloat16_t& operator-=(float other) noexcept {
+				*this = static_cast<float>(*this) - other;
+				return *this;
+			}
+
+			constexpr bfloat16_t& operator*=(float other) noexcept {
+				*this = static_cast<float>(*this) * other;
+				return *this;
+			}
+
+			constexpr bfloat16_t& operator/=(float other) noexcept {
+				*this = static_cast<float>(*this) / other;
+				return *this;
+			}
+
+			friend constexpr float operator+(bfloat16_t lhs, float rhs) noexcept { return static_cast<float>(lhs) + rhs; }
+			friend constexpr float operator+(float lhs, bfloat16_t rhs) noexcept { return lhs + static_cast<float>(rhs); }
+			friend constexpr float operator-(bfloat16_t lhs, float rhs) noexcept { return static_cast<float>(lhs) - rhs; }
+			friend constexpr float operator-(float lhs, bfloat16_t rhs) noexcept { return lhs - static_cast<float>(rhs); }
+			friend constexpr float operator*(bfloat16_t lhs, float rhs) noexcept { return static_cast<float>(lhs) * rhs; }
+			friend constexpr float operator*(float lhs, bfloat16_t rhs) noexcept { return lhs * static_cast<float>(rhs); }
+			friend constexpr float operator/(bfloat16_t lhs, float rhs) noexcept { return static_cast<float>(lhs) / rhs; }
+			friend constexpr float operator/(float lhs, bfloat16_t rhs) noexcept { return lhs / static_cast<float>(rhs); }
+
+			friend constexpr float& operator+=(float& lhs, bfloat16_t rhs) noexcept { return lhs += static_cast<float>(rhs); }
+			friend constexpr float& operator-=(float& lhs, bfloat16_t rhs) noexcept { return lhs -= static_cast<float>(rhs); }
+			friend constexpr float& operator*=(float& lhs, bfloat16_t rhs) noexcept { return lhs *= static_cast<float>(rhs); }
+			friend constexpr float& operator/=(float& lhs, bfloat16_t rhs) noexcept { return lhs /= static_cast<float>(rhs); }
+
 			// Utility functions
-			bool is_nan() const noexcept {
+			constexpr bool is_nan() const noexcept {
 				return ((data & EXP_MASK) == EXP_MASK) && ((data & MANT_MASK) != 0);
 			}
 
-			bool is_infinity() const noexcept {
+			constexpr bool is_infinity() const noexcept {
 				return ((data & EXP_MASK) == EXP_MASK) && ((data & MANT_MASK) == 0);
 			}
 
-			bool is_zero() const noexcept {
+			constexpr bool is_zero() const noexcept {
 				return (data & ~SIGN_MASK) == 0;
 			}
 
-			bool is_negative() const noexcept {
+			constexpr bool is_negative() const noexcept {
 				return (data & SIGN_MASK) != 0;
 			}
 
 			// Extract components
-			int16_t get_exponent() const noexcept {
+			constexpr int16_t get_exponent() const noexcept {
 				if (is_zero()) return 0;
 				if (is_nan() || is_infinity()) return std::numeric_limits<int16_t>::max();
 
 				return static_cast<int16_t>(((data & EXP_MASK) >> EXP_SHIFT) - EXP_BIAS);
 			}
 
-			uint16_t get_mantissa() const noexcept {
+			constexpr uint16_t get_mantissa() const noexcept {
 				return data & MANT_MASK;
 			}
 
-			bool get_sign() const noexcept {
+			constexpr bool get_sign() const noexcept {
 				return is_negative();
 			}
 
 			// Special value constructors
+			static constexpr bfloat16_t from_bits(uint16_t raw) noexcept {
+				bfloat16_t result;
+				result.data = raw;
+				return result;
+			}
+
 			static constexpr bfloat16_t zero() noexcept {
 				bfloat16_t result;
 				result.data = 0;
@@ -168,47 +230,94 @@ namespace bf16 {
 			}
 
 			// Get/set raw bits
-			uint16_t bits() const noexcept {
+			constexpr uint16_t bits() const noexcept {
 				return data;
 			}
 
-			uint16_t& bits() noexcept {
+			constexpr uint16_t& bits() noexcept {
 				return data;
 			}
 	};
 
+	// Same bit pattern: a NaN equals itself, -0 and +0 differ
+	constexpr bool bitwise_equal(bfloat16_t a, bfloat16_t b) noexcept {
+		return a.bits() == b.bits();
+	}
+
 	// Math functions for bfloat16_t
-	inline bfloat16_t abs(const bfloat16_t& x) noexcept {
-		bfloat16_t result;
-		result.bits() = x.bits() & ~bfloat16_t::get_sign_mask();
-		return result;
+	// In constant evaluation these use the double-precision routines in
+	// detail/constexpr_math.hpp, which round to the same bf16 results
+	constexpr bfloat16_t abs(const bfloat16_t& x) noexcept {
+		return bfloat16_t::from_bits(static_cast<uint16_t>(x.bits() & ~bfloat16_t::get_sign_mask()));
 	}
 
-	inline bfloat16_t sqrt(const bfloat16_t& x) noexcept {
+	constexpr bfloat16_t sqrt(const bfloat16_t& x) noexcept {
+		if consteval {
+			return bfloat16_t(detail::cx::to_float(detail::cx::sqrt(x)));
+		}
 		return bfloat16_t(std::sqrt(static_cast<float>(x)));
 	}
 
-	inline bfloat16_t exp(const bfloat16_t& x) noexcept {
+	constexpr bfloat16_t exp(const bfloat16_t& x) noexcept {
+		if consteval {
+			return bfloat16_t(detail::cx::to_float(detail::cx::exp(x)));
+		}
 		return bfloat16_t(std::exp(static_cast<float>(x)));
 	}
 
-	inline bfloat16_t log(const bfloat16_t& x) noexcept {
+	constexpr bfloat16_t log(const bfloat16_t& x) noexcept {
+		if consteval {
+			return bfloat16_t(detail::cx::to_float(detail::cx::log(x)));
+		}
 		return bfloat16_t(std::log(static_cast<float>(x)));
 	}
 
-	inline bfloat16_t sin(const bfloat16_t& x) noexcept {
+	// a * b + c in fp32. The product of two bf16 values has at most 16
+	// significant bits, so unless it underflows it is exact in fp32 and this
+	// rounds only once, like a true fused multiply-add, while compiling to a
+	// plain mul/add that vectorises without -ffp-contract
+	constexpr float fma(bfloat16_t a, bfloat16_t b, float c) noexcept {
+		return static_cast<float>(a) * static_cast<float>(b) + c;
+	}
+
+	// Same, rounded to bf16: a second rounding after the fp32 one
+	constexpr bfloat16_t fma(bfloat16_t a, bfloat16_t b, bfloat16_t c) noexcept {
+		return bfloat16_t(fma(a, b, static_cast<float>(c)));
+	}
+
+	// Compile-time trig covers |x| < detail::cx::trig_limit; larger finite
+	// arguments fall back to <cmath>, which only some compilers fold
+	constexpr bfloat16_t sin(const bfloat16_t& x) noexcept {
+		if consteval {
+			if (detail::cx::in_trig_range(x)) {
+				return bfloat16_t(detail::cx::to_float(detail::cx::sin(x)));
+			}
+		}
 		return bfloat16_t(std::sin(static_cast<float>(x)));
 	}
 
-	inline bfloat16_t cos(const bfloat16_t& x) noexcept {
+	constexpr bfloat16_t cos(const bfloat16_t& x) noexcept {
+		if consteval {
+			if (detail::cx::in_trig_range(x)) {
+				return bfloat16_t(detail::cx::to_float(detail::cx::cos(x)));
+			}
+		}
 		return bfloat16_t(std::cos(static_cast<float>(x)));
 	}
 
-	inline bfloat16_t tan(const bfloat16_t& x) noexcept {
+	constexpr bfloat16_t tan(const bfloat16_t& x) noexcept {
+		if consteval {
+			if (detail::cx::in_trig_range(x)) {
+				return bfloat16_t(detail::cx::to_float(detail::cx::tan(x)));
+			}
+		}
 		return bfloat16_t(std::tan(static_cast<float>(x)));
 	}
 
-	inline bfloat16_t pow(const bfloat16_t& x, const bfloat16_t& y) noexcept {
+	constexpr bfloat16_t pow(const bfloat16_t& x, const bfloat16_t& y) noexcept {
+		if consteval {
+			return bfloat16_t(detail::cx::to_float(detail::cx::pow(x, y)));
+		}
 		return bfloat16_t(std::pow(static_cast<float>(x), static_cast<float>(y)));
 	}
 
@@ -245,28 +354,20 @@ namespace std {
 				static constexpr bool traps = false;
 				static constexpr bool tinyness_before = false;
 
-				static constexpr bf16::bfloat16_t min() noexcept { 
-					bf16::bfloat16_t result;
-					result.bits() = 0x0080;
-					return result;
+				static constexpr bf16::bfloat16_t min() noexcept {
+					return bf16::bfloat16_t::from_bits(0x0080);
 				}
 
 				static constexpr bf16::bfloat16_t lowest() noexcept {
-					bf16::bfloat16_t result;
-					result.bits() = 0xFF7F;
-					return result;
+					return bf16::bfloat16_t::from_bits(0xFF7F);
 				}
 
 				static constexpr bf16::bfloat16_t max() noexcept {
-					bf16::bfloat16_t result;
-					result.bits() = 0x7F7F;
-					return result;
+					return bf16::bfloat16_t::from_bits(0x7F7F);
 				}
 
 				static constexpr bf16::bfloat16_t epsilon() noexcept {
-					bf16::bfloat16_t result;
-					result.bits() = 0x3C00;
-					return result;
+					return bf16::bfloat16_t::from_bits(0x3C00);
 				}
 
 				static constexpr bf16::bfloat16_t round_error() noexcept {
@@ -282,9 +383,7 @@ namespace std {
 				}
 
 				static constexpr bf16::bfloat16_t denorm_min() noexcept {
-					bf16::bfloat16_t result;
-					result.bits() = 0x0001;
-					return result;
+					return bf16::bfloat16_t::from_bits(0x0001);
 				}
 		};
 }
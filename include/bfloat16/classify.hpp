@@ -0,0 +1,189 @@
+/**
+ * @file classify.hpp
+ * @brief Bulk non-finite scanning and classification of bfloat16_t buffers
+ *
+ * These mirror bfloat16_t::is_nan() / is_infinity() / is_zero() on raw bits,
+ * so no lane is ever widened to float. The find/all variants stop at the
+ * first block that contains a match.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_CLASSIFY_HPP
+#define BFLOAT16_CLASSIFY_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace bf16 {
+
+	enum class value_class : uint8_t { zero, subnormal, normal, infinite, nan };
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		inline constexpr uint16_t exp_bits = 0x7F80;
+		inline constexpr uint16_t abs_bits = 0x7FFF;
+
+		constexpr bool is_nonfinite_bits(uint16_t bits) noexcept {
+			return (bits & exp_bits) == exp_bits;
+		}
+
+		constexpr value_class classify_bits(uint16_t bits) noexcept {
+			const uint16_t a = bits & abs_bits;
+			if (a == 0) return value_class::zero;
+			if (a < 0x0080) return value_class::subnormal;
+			if (a < exp_bits) return value_class::normal;
+			return a == exp_bits ? value_class::infinite : value_class::nan;
+		}
+
+		// Index of the first element matching pred in [i, n) of 16-bit words, or n
+		template<typename Pred>
+		std::size_t find_scalar(const bfloat16_t* p, std::size_t i, std::size_t n, Pred pred) noexcept {
+			for (; i < n; ++i) {
+				if (pred(p[i].bits())) return i;
+			}
+			return n;
+		}
+
+#if defined(BF16_HAVE_AVX512)
+		inline __mmask32 nonfinite_mask32(__m512i v) noexcept {
+			const __m512i e = _mm512_set1_epi16(static_cast<int16_t>(exp_bits));
+			return _mm512_cmpeq_epi16_mask(_mm512_and_si512(v, e), e);
+		}
+
+		inline __mmask32 nan32(__m512i v) noexcept {
+			return _mm512_cmpgt_epu16_mask(_mm512_and_si512(v, _mm512_set1_epi16(static_cast<int16_t>(abs_bits))),
+				_mm512_set1_epi16(static_cast<int16_t>(exp_bits)));
+		}
+#elif defined(BF16_HAVE_AVX2)
+		// One bit per byte, so every matching 16-bit lane sets two bits
+		inline uint32_t nonfinite_bytes16(__m256i v) noexcept {
+			const __m256i e = _mm256_set1_epi16(static_cast<int16_t>(exp_bits));
+			return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(v, e), e)));
+		}
+
+		inline uint32_t nan_bytes16(__m256i v) noexcept {
+			// abs > 0x7F80 as a signed compare is safe: abs never has the sign bit
+			const __m256i a = _mm256_and_si256(v, _mm256_set1_epi16(static_cast<int16_t>(abs_bits)));
+			return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi16(a, _mm256_set1_epi16(static_cast<int16_t>(exp_bits)))));
+		}
+#endif
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// Number of NaN and infinite elements
+	inline std::size_t count_nonfinite(std::span<const bfloat16_t> x) noexcept {
+		const bfloat16_t* p = x.data();
+		const std::size_t n = x.size();
+		std::size_t i = 0, count = 0;
+#if defined(BF16_HAVE_AVX512)
+		for (; i + 64 <= n; i += 64) {
+			const __mmask32 a = detail::nonfinite_mask32(_mm512_loadu_si512(p + i));
+			const __mmask32 b = detail::nonfinite_mask32(_mm512_loadu_si512(p + i + 32));
+			count += static_cast<std::size_t>(std::popcount(a) + std::popcount(b));
+		}
+		for (; i < n; i += 32) {
+			const __mmask32 t = detail::tail_mask32(n - i);
+			count += static_cast<std::size_t>(std::popcount(detail::nonfinite_mask32(_mm512_maskz_loadu_epi16(t, p + i)) & t));
+		}
+#elif defined(BF16_HAVE_AVX2)
+		for (; i + 16 <= n; i += 16) {
+			count += static_cast<std::size_t>(std::popcount(detail::nonfinite_bytes16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)))) / 2);
+		}
+#endif
+		for (; i < n; ++i) {
+			count += detail::is_nonfinite_bits(p[i].bits());
+		}
+		return count;
+	}
+
+	// Index of the first NaN, or x.size() if there is none
+	inline std::size_t find_first_nan(std::span<const bfloat16_t> x) noexcept {
+		const bfloat16_t* p = x.data();
+		const std::size_t n = x.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		for (; i < n; i += 32) {
+			const __mmask32 t = detail::tail_mask32(n - i);
+			const __mmask32 m = detail::nan32(_mm512_maskz_loadu_epi16(t, p + i)) & t;
+			if (m) return i + static_cast<std::size_t>(std::countr_zero(m));
+		}
+#elif defined(BF16_HAVE_AVX2)
+		for (; i + 16 <= n; i += 16) {
+			const uint32_t m = detail::nan_bytes16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+			if (m) return i + static_cast<std::size_t>(std::countr_zero(m)) / 2;
+		}
+#endif
+		return detail::find_scalar(p, i, n, detail::is_nan_bits);
+	}
+
+	// True if no element is NaN or infinite
+	inline bool all_finite(std::span<const bfloat16_t> x) noexcept {
+		const bfloat16_t* p = x.data();
+		const std::size_t n = x.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		// OR four registers together and test once per 128 elements. OR-ing finite
+		// values can also produce an all-ones exponent, so a hit is re-checked exactly.
+		for (; i + 128 <= n; i += 128) {
+			const __m512i a = _mm512_loadu_si512(p + i), b = _mm512_loadu_si512(p + i + 32);
+			const __m512i c = _mm512_loadu_si512(p + i + 64), d = _mm512_loadu_si512(p + i + 96);
+			if (detail::nonfinite_mask32(_mm512_or_si512(_mm512_or_si512(a, b), _mm512_or_si512(c, d)))) {
+				if (detail::nonfinite_mask32(a) | detail::nonfinite_mask32(b) | detail::nonfinite_mask32(c) | detail::nonfinite_mask32(d)) {
+					return false;
+				}
+			}
+		}
+		for (; i < n; i += 32) {
+			const __mmask32 t = detail::tail_mask32(n - i);
+			if (detail::nonfinite_mask32(_mm512_maskz_loadu_epi16(t, p + i)) & t) return false;
+		}
+#elif defined(BF16_HAVE_AVX2)
+		for (; i + 16 <= n; i += 16) {
+			if (detail::nonfinite_bytes16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)))) return false;
+		}
+#endif
+		return detail::find_scalar(p, i, n, detail::is_nonfinite_bits) == n;
+	}
+
+	// out[i] = category of x[i]
+	inline void classify(std::span<const bfloat16_t> x, std::span<value_class> out) noexcept {
+		assert(out.size() >= x.size());
+		const std::size_t n = x.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		const __m512i abs_mask = _mm512_set1_epi16(static_cast<int16_t>(detail::abs_bits));
+		const __m512i inf = _mm512_set1_epi16(static_cast<int16_t>(detail::exp_bits));
+		const __m512i min_normal = _mm512_set1_epi16(0x0080);
+		for (; i < n; i += 32) {
+			const __mmask32 t = detail::tail_mask32(n - i);
+			const __m512i a = _mm512_and_si512(_mm512_maskz_loadu_epi16(t, x.data() + i), abs_mask);
+			__m512i c = _mm512_set1_epi16(static_cast<int16_t>(value_class::normal));
+			c = _mm512_mask_mov_epi16(c, _mm512_cmplt_epu16_mask(a, min_normal), _mm512_set1_epi16(static_cast<int16_t>(value_class::subnormal)));
+			c = _mm512_mask_mov_epi16(c, _mm512_cmpeq_epi16_mask(a, _mm512_setzero_si512()), _mm512_set1_epi16(static_cast<int16_t>(value_class::zero)));
+			c = _mm512_mask_mov_epi16(c, _mm512_cmpeq_epi16_mask(a, inf), _mm512_set1_epi16(static_cast<int16_t>(value_class::infinite)));
+			c = _mm512_mask_mov_epi16(c, _mm512_cmpgt_epu16_mask(a, inf), _mm512_set1_epi16(static_cast<int16_t>(value_class::nan)));
+			_mm256_mask_storeu_epi8(out.data() + i, t, _mm512_maskz_cvtepi16_epi8(detail::full32, c));
+		}
+#endif
+		for (; i < n; ++i) {
+			out[i] = detail::classify_bits(x[i].bits());
+		}
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
@@ -0,0 +1,416 @@
+/**
+ * @file conv.hpp
+ * @brief 2D convolution over bfloat16_t tensors with fp32 accumulation
+ *
+ * Activations are NCHW or NHWC; weights are always OIHW, i.e.
+ * [out_channels][in_channels / groups][kernel_height][kernel_width].
+ * Two implementations are provided: im2col followed by the blocked GEMM, and
+ * a direct register-blocked kernel that avoids materialising the patch matrix
+ * for small filters and depthwise convolutions.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_CONV_HPP
+#define BFLOAT16_CONV_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/gemm.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace bf16 {
+
+	enum class tensor_layout { nchw, nhwc };
+
+	enum class conv_algorithm { automatic, im2col, direct };
+
+	struct conv2d_shape {
+		std::size_t batch = 1;
+		std::size_t in_channels = 1;
+		std::size_t in_height = 1;
+		std::size_t in_width = 1;
+		std::size_t out_channels = 1;
+		std::size_t kernel_height = 1;
+		std::size_t kernel_width = 1;
+		std::size_t stride_h = 1;
+		std::size_t stride_w = 1;
+		std::size_t pad_h = 0;
+		std::size_t pad_w = 0;
+		std::size_t dilation_h = 1;
+		std::size_t dilation_w = 1;
+		std::size_t groups = 1;
+		tensor_layout layout = tensor_layout::nchw;
+
+		// Outputs along one axis, 0 when the dilated kernel is larger than the
+		// padded input or the shape is not valid()
+		static constexpr std::size_t out_extent(std::size_t in, std::size_t pad, std::size_t kernel,
+				std::size_t dilation, std::size_t stride) noexcept {
+			if (kernel == 0 || dilation == 0 || stride == 0) return 0;
+			const std::size_t padded = in + 2 * pad, span = dilation * (kernel - 1) + 1;
+			return span > padded ? 0 : (padded - span) / stride + 1;
+		}
+
+		constexpr std::size_t out_height() const noexcept {
+			return out_extent(in_height, pad_h, kernel_height, dilation_h, stride_h);
+		}
+
+		constexpr std::size_t out_width() const noexcept {
+			return out_extent(in_width, pad_w, kernel_width, dilation_w, stride_w);
+		}
+
+		constexpr std::size_t input_size() const noexcept {
+			return batch * in_channels * in_height * in_width;
+		}
+
+		constexpr std::size_t weight_size() const noexcept {
+			return out_channels * (in_channels / groups) * kernel_height * kernel_width;
+		}
+
+		constexpr std::size_t output_size() const noexcept {
+			return batch * out_channels * out_height() * out_width();
+		}
+
+		// Nonzero kernel extents, strides and dilations, and groups dividing both
+		// channel counts. A kernel that does not fit the padded input is valid
+		// and gives an empty output.
+		constexpr bool valid() const noexcept {
+			return kernel_height > 0 && kernel_width > 0 && stride_h > 0 && stride_w > 0 && dilation_h > 0 && dilation_w > 0
+				&& groups > 0 && in_channels % groups == 0 && out_channels % groups == 0;
+		}
+
+		constexpr bool is_depthwise() const noexcept {
+			return groups > 1 && groups == in_channels;
+		}
+	};
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		// The direct kernel wins when the reduction per output is too short to
+		// amortise building a patch matrix and packing it for the GEMM.
+		constexpr conv_algorithm choose_conv_algorithm(const conv2d_shape& s) noexcept {
+			const std::size_t reduction = (s.in_channels / s.groups) * s.kernel_height * s.kernel_width;
+			const std::size_t out_per_group = s.out_channels / s.groups;
+			if (s.is_depthwise() || reduction < 32 || out_per_group < 8) {
+				return conv_algorithm::direct;
+			}
+			return conv_algorithm::im2col;
+		}
+
+		constexpr bool is_pointwise(const conv2d_shape& s) noexcept {
+			return s.kernel_height == 1 && s.kernel_width == 1 && s.stride_h == 1 && s.stride_w == 1
+				&& s.pad_h == 0 && s.pad_w == 0;
+		}
+
+		inline float bias_at(std::span<const bfloat16_t> bias, std::size_t oc) noexcept {
+			return bias.empty() ? 0.0f : widen(bias[oc]);
+		}
+
+		// im2col, NCHW: per (image, group) a [icg*kh*kw][oh*ow] patch matrix feeding
+		// C[ocg][oh*ow] = W[ocg][icg*kh*kw] * col
+		inline void conv2d_im2col_nchw(const conv2d_shape& s, const bfloat16_t* in, const bfloat16_t* w,
+				std::span<const bfloat16_t> bias, bfloat16_t* out) {
+			const std::size_t oh = s.out_height(), ow = s.out_width(), plane = oh * ow;
+			const std::size_t icg = s.in_channels / s.groups, ocg = s.out_channels / s.groups;
+			const std::size_t kk = icg * s.kernel_height * s.kernel_width;
+			const std::size_t in_plane = s.in_height * s.in_width;
+			const bool pointwise = is_pointwise(s);
+
+			std::vector<bfloat16_t> col(pointwise ? 0 : kk * plane);
+
+			for (std::size_t n = 0; n < s.batch; ++n) {
+				for (std::size_t g = 0; g < s.groups; ++g) {
+					const bfloat16_t* src = in + (n * s.in_channels + g * icg) * in_plane;
+					const bfloat16_t* patches = src;
+
+					if (!pointwise) {
+						bfloat16_t* row = col.data();
+						for (std::size_t c = 0; c < icg; ++c) {
+							for (std::size_t ky = 0; ky < s.kernel_height; ++ky) {
+								for (std::size_t kx = 0; kx < s.kernel_width; ++kx, row += plane) {
+									for (std::size_t y = 0; y < oh; ++y) {
+										const std::ptrdiff_t iy = static_cast<std::ptrdiff_t>(y * s.stride_h + ky * s.dilation_h) - static_cast<std::ptrdiff_t>(s.pad_h);
+										bfloat16_t* dst = row + y * ow;
+										if (iy < 0 || iy >= static_cast<std::ptrdiff_t>(s.in_height)) {
+											std::fill(dst, dst + ow, bfloat16_t::zero());
+											continue;
+										}
+										const bfloat16_t* src_row = src + c * in_plane + static_cast<std::size_t>(iy) * s.in_width;
+										for (std::size_t x = 0; x < ow; ++x) {
+											const std::ptrdiff_t ix = static_cast<std::ptrdiff_t>(x * s.stride_w + kx * s.dilation_w) - static_cast<std::ptrdiff_t>(s.pad_w);
+											dst[x] = (ix < 0 || ix >= static_cast<std::ptrdiff_t>(s.in_width)) ? bfloat16_t::zero() : src_row[ix];
+										}
+									}
+								}
+							}
+						}
+						patches = col.data();
+					}
+
+					// Bias is added and the result narrowed as each GEMM tile is stored
+					bfloat16_t* dst = out + (n * s.out_channels + g * ocg) * plane;
+					if (bias.empty()) {
+						gemm(ocg, plane, kk, w + g * ocg * kk, kk, patches, plane, dst, plane, epilogue::none{});
+					} else {
+						gemm(ocg, plane, kk, w + g * ocg * kk, kk, patches, plane, dst, plane, epilogue::row_bias{bias.data() + g * ocg});
+					}
+				}
+			}
+		}
+
+		// im2col, NHWC: per image a [oh*ow][kh*kw*icg] patch matrix per group against
+		// weights repacked to [group][kh][kw][icg][ocg]
+		inline void conv2d_im2col_nhwc(const conv2d_shape& s, const bfloat16_t* in, const bfloat16_t* w,
+				std::span<const bfloat16_t> bias, bfloat16_t* out) {
+			const std::size_t oh = s.out_height(), ow = s.out_width(), plane = oh * ow;
+			const std::size_t icg = s.in_channels / s.groups, ocg = s.out_channels / s.groups;
+			const std::size_t kh = s.kernel_height, kw = s.kernel_width;
+			const std::size_t kk = kh * kw * icg;
+			const bool direct_input = is_pointwise(s) && s.groups == 1;
+
+			std::vector<bfloat16_t> wt(s.groups * kk * ocg);
+			for (std::size_t g = 0; g < s.groups; ++g) {
+				for (std::size_t o = 0; o < ocg; ++o) {
+					for (std::size_t c = 0; c < icg; ++c) {
+						for (std::size_t ky = 0; ky < kh; ++ky) {
+							for (std::size_t kx = 0; kx < kw; ++kx) {
+								const std::size_t src = (((g * ocg + o) * icg + c) * kh + ky) * kw + kx;
+								const std::size_t dst = ((g * kh + ky) * kw + kx) * icg * ocg + c * ocg + o;
+								wt[dst] = w[src];
+							}
+						}
+					}
+				}
+			}
+
+			std::vector<bfloat16_t> col(direct_input ? 0 : plane * kk);
+
+			for (std::size_t n = 0; n < s.batch; ++n) {
+				const bfloat16_t* img = in + n * s.in_height * s.in_width * s.in_channels;
+				for (std::size_t g = 0; g < s.groups; ++g) {
+					const bfloat16_t* patches = img;
+					std::size_t ld = s.in_channels;
+
+					if (!direct_input) {
+						for (std::size_t y = 0; y < oh; ++y) {
+							for (std::size_t x = 0; x < ow; ++x) {
+								bfloat16_t* dst = col.data() + (y * ow + x) * kk;
+								for (std::size_t ky = 0; ky < kh; ++ky) {
+									const std::ptrdiff_t iy = static_cast<std::ptrdiff_t>(y * s.stride_h + ky * s.dilation_h) - static_cast<std::ptrdiff_t>(s.pad_h);
+									for (std::size_t kx = 0; kx < kw; ++kx, dst += icg) {
+										const std::ptrdiff_t ix = static_cast<std::ptrdiff_t>(x * s.stride_w + kx * s.dilation_w) - static_cast<std::ptrdiff_t>(s.pad_w);
+										if (iy < 0 || iy >= static_cast<std::ptrdiff_t>(s.in_height) || ix < 0 || ix >= static_cast<std::ptrdiff_t>(s.in_width)) {
+											std::fill(dst, dst + icg, bfloat16_t::zero());
+										} else {
+											const bfloat16_t* px = img + (static_cast<std::size_t>(iy) * s.in_width + static_cast<std::size_t>(ix)) * s.in_channels + g * icg;
+											std::copy(px, px + icg, dst);
+										}
+									}
+								}
+							}
+						}
+						patches = col.data();
+						ld = kk;
+					}
+
+					bfloat16_t* dst = out + n * plane * s.out_channels + g * ocg;
+					if (bias.empty()) {
+						gemm(plane, ocg, kk, patches, ld, wt.data() + g * kk * ocg, ocg, dst, s.out_channels, epilogue::none{});
+					} else {
+						gemm(plane, ocg, kk, patches, ld, wt.data() + g * kk * ocg, ocg, dst, s.out_channels, epilogue::bias{bias.data() + g * ocg});
+					}
+				}
+			}
+		}
+
+		// Direct NCHW: each group's input is widened once into a zero-padded plane
+		// stack, then tiles of conv_ocb output channels x conv_owb output columns are
+		// accumulated in registers across the whole (icg, kh, kw) reduction.
+		inline constexpr std::size_t conv_ocb = 4;
+		inline constexpr std::size_t conv_owb = 16;
+
+		inline void conv2d_direct_nchw(const conv2d_shape& s, const bfloat16_t* in, const bfloat16_t* w,
+				std::span<const bfloat16_t> bias, bfloat16_t* out) {
+			const std::size_t oh = s.out_height(), ow = s.out_width();
+			const std::size_t icg = s.in_channels / s.groups, ocg = s.out_channels / s.groups;
+			const std::size_t kh = s.kernel_height, kw = s.kernel_width;
+			const std::size_t ph = s.in_height + 2 * s.pad_h, pw = s.in_width + 2 * s.pad_w;
+			const std::size_t in_plane = s.in_height * s.in_width;
+
+			std::vector<float> wf(s.weight_size());
+			to_float({w, wf.size()}, wf);
+			std::vector<float> padded(icg * ph * pw);
+
+			for (std::size_t n = 0; n < s.batch; ++n) {
+				for (std::size_t g = 0; g < s.groups; ++g) {
+					std::fill(padded.begin(), padded.end(), 0.0f);
+					for (std::size_t c = 0; c < icg; ++c) {
+						const bfloat16_t* src = in + (n * s.in_channels + g * icg + c) * in_plane;
+						for (std::size_t y = 0; y < s.in_height; ++y) {
+							to_float({src + y * s.in_width, s.in_width},
+								{padded.data() + (c * ph + y + s.pad_h) * pw + s.pad_w, s.in_width});
+						}
+					}
+
+					for (std::size_t o0 = 0; o0 < ocg; o0 += conv_ocb) {
+						const std::size_t ocn = std::min(conv_ocb, ocg - o0);
+						for (std::size_t y = 0; y < oh; ++y) {
+							for (std::size_t x0 = 0; x0 < ow; x0 += conv_owb) {
+								const std::size_t own = std::min(conv_owb, ow - x0);
+								float acc[conv_ocb][conv_owb] = {};
+
+								for (std::size_t c = 0; c < icg; ++c) {
+									for (std::size_t ky = 0; ky < kh; ++ky) {
+										const float* row = padded.data() + (c * ph + y * s.stride_h + ky * s.dilation_h) * pw;
+										for (std::size_t kx = 0; kx < kw; ++kx) {
+											float xs[conv_owb] = {};
+											for (std::size_t j = 0; j < own; ++j) {
+												xs[j] = row[(x0 + j) * s.stride_w + kx * s.dilation_w];
+											}
+											for (std::size_t o = 0; o < ocn; ++o) {
+												const float wv = wf[(((g * ocg + o0 + o) * icg + c) * kh + ky) * kw + kx];
+												for (std::size_t j = 0; j < conv_owb; ++j) {
+													acc[o][j] += wv * xs[j];
+												}
+											}
+										}
+									}
+								}
+
+								for (std::size_t o = 0; o < ocn; ++o) {
+									const std::size_t oc = g * ocg + o0 + o;
+									const float b = bias_at(bias, oc);
+									for (std::size_t j = 0; j < own; ++j) acc[o][j] += b;
+									from_float({acc[o], own}, {out + ((n * s.out_channels + oc) * oh + y) * ow + x0, own});
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		// Direct NHWC: output channels are contiguous, so the accumulator for a run of
+		// conv_pxb output pixels is a [conv_pxb][out_channels] block updated with
+		// unit-stride FMAs. Weights are widened into [kh][kw][icg][out_channels].
+		inline constexpr std::size_t conv_pxb = 4;
+
+		inline void conv2d_direct_nhwc(const conv2d_shape& s, const bfloat16_t* in, const bfloat16_t* w,
+				std::span<const bfloat16_t> bias, bfloat16_t* out) {
+			const std::size_t oh = s.out_height(), ow = s.out_width();
+			const std::size_t ci = s.in_channels, co = s.out_channels;
+			const std::size_t icg = ci / s.groups, ocg = co / s.groups;
+			const std::size_t kh = s.kernel_height, kw = s.kernel_width;
+
+			std::vector<float> wt(kh * kw * icg * co);
+			for (std::size_t oc = 0; oc < co; ++oc) {
+				for (std::size_t c = 0; c < icg; ++c) {
+					for (std::size_t ky = 0; ky < kh; ++ky) {
+						for (std::size_t kx = 0; kx < kw; ++kx) {
+							wt[((ky * kw + kx) * icg + c) * co + oc] = widen(w[((oc * icg + c) * kh + ky) * kw + kx]);
+						}
+					}
+				}
+			}
+
+			std::vector<float> bias_f(co, 0.0f);
+			if (!bias.empty()) to_float(bias.first(co), bias_f);
+
+			std::vector<float> acc(conv_pxb * co);
+			std::vector<float> px(ci);
+			// Depthwise with multiplier m reads input channel oc / m for output oc
+			std::vector<float> gathered(s.groups > 1 && icg == 1 ? co : 0);
+
+			for (std::size_t n = 0; n < s.batch; ++n) {
+				const bfloat16_t* img = in + n * s.in_height * s.in_width * ci;
+				for (std::size_t y = 0; y < oh; ++y) {
+					for (std::size_t x0 = 0; x0 < ow; x0 += conv_pxb) {
+						const std::size_t pxn = std::min(conv_pxb, ow - x0);
+						for (std::size_t p = 0; p < pxn; ++p) {
+							std::copy(bias_f.begin(), bias_f.end(), acc.begin() + p * co);
+						}
+
+						for (std::size_t p = 0; p < pxn; ++p) {
+							float* a = acc.data() + p * co;
+							for (std::size_t ky = 0; ky < kh; ++ky) {
+								const std::ptrdiff_t iy = static_cast<std::ptrdiff_t>(y * s.stride_h + ky * s.dilation_h) - static_cast<std::ptrdiff_t>(s.pad_h);
+								if (iy < 0 || iy >= static_cast<std::ptrdiff_t>(s.in_height)) continue;
+								for (std::size_t kx = 0; kx < kw; ++kx) {
+									const std::ptrdiff_t ix = static_cast<std::ptrdiff_t>((x0 + p) * s.stride_w + kx * s.dilation_w) - static_cast<std::ptrdiff_t>(s.pad_w);
+									if (ix < 0 || ix >= static_cast<std::ptrdiff_t>(s.in_width)) continue;
+
+									to_float({img + (static_cast<std::size_t>(iy) * s.in_width + static_cast<std::size_t>(ix)) * ci, ci}, px);
+									const float* wk = wt.data() + (ky * kw + kx) * icg * co;
+
+									if (!gathered.empty()) {
+										const std::size_t mult = ocg;
+										for (std::size_t oc = 0; oc < co; ++oc) gathered[oc] = px[oc / mult];
+										for (std::size_t oc = 0; oc < co; ++oc) a[oc] += gathered[oc] * wk[oc];
+									} else {
+										for (std::size_t g = 0; g < s.groups; ++g) {
+											for (std::size_t c = 0; c < icg; ++c) {
+												const float xv = px[g * icg + c];
+												const float* wr = wk + c * co + g * ocg;
+												float* ar = a + g * ocg;
+												for (std::size_t o = 0; o < ocg; ++o) ar[o] += xv * wr[o];
+											}
+										}
+									}
+								}
+							}
+						}
+
+						bfloat16_t* dst = out + ((n * oh + y) * ow + x0) * co;
+						from_float({acc.data(), pxn * co}, {dst, pxn * co});
+					}
+				}
+			}
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// Convolve input with OIHW weights; bias may be empty or hold out_channels values.
+	// shape must be valid(); a shape with no outputs writes nothing.
+	inline void conv2d(const conv2d_shape& shape,
+			std::span<const bfloat16_t> input,
+			std::span<const bfloat16_t> weights,
+			std::span<const bfloat16_t> bias,
+			std::span<bfloat16_t> output,
+			conv_algorithm algorithm = conv_algorithm::automatic) {
+		assert(shape.valid());
+		assert(input.size() >= shape.input_size());
+		assert(weights.size() >= shape.weight_size());
+		assert(bias.empty() || bias.size() >= shape.out_channels);
+		assert(output.size() >= shape.output_size());
+		if (shape.output_size() == 0) return;
+
+		if (algorithm == conv_algorithm::automatic) {
+			algorithm = detail::choose_conv_algorithm(shape);
+		}
+
+		const bool nchw = shape.layout == tensor_layout::nchw;
+		if (algorithm == conv_algorithm::im2col) {
+			nchw ? detail::conv2d_im2col_nchw(shape, input.data(), weights.data(), bias, output.data())
+				: detail::conv2d_im2col_nhwc(shape, input.data(), weights.data(), bias, output.data());
+		} else {
+			nchw ? detail::conv2d_direct_nchw(shape, input.data(), weights.data(), bias, output.data())
+				: detail::conv2d_direct_nhwc(shape, input.data(), weights.data(), bias, output.data());
+		}
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
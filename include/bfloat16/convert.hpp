@@ -0,0 +1,75 @@
+/**
+ * @file convert.hpp
+ * @brief Bulk conversion between bfloat16_t and float buffers
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_CONVERT_HPP
+#define BFLOAT16_CONVERT_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <span>
+
+namespace bf16 {
+
+	BF16_ISA_BEGIN
+
+	// Widen src into dst (dst.size() >= src.size())
+	inline void to_float(std::span<const bfloat16_t> src, std::span<float> dst) noexcept {
+		assert(dst.size() >= src.size());
+		const std::size_t n = src.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		for (; i + 16 <= n; i += 16) {
+			_mm512_storeu_ps(dst.data() + i, detail::load16(src.data() + i));
+		}
+		if (i < n) {
+			__mmask16 m = detail::tail_mask16(n - i);
+			_mm512_mask_storeu_ps(dst.data() + i, m, detail::maskz_load16(src.data() + i, m));
+			i = n;
+		}
+#elif defined(BF16_HAVE_AVX2)
+		// Explicit bound: with i + 8 <= n, GCC 12 cannot tell that the scalar
+		// tails here are empty for constant multiples of 8 and warns about them
+		for (const std::size_t end = n / 8 * 8; i < end; i += 8) {
+			_mm256_storeu_ps(dst.data() + i, detail::load8(src.data() + i));
+		}
+#endif
+		for (; i < n; ++i) {
+			dst[i] = detail::widen(src[i]);
+		}
+	}
+
+	// Narrow src into dst with the same rounding as bfloat16_t(float)
+	inline void from_float(std::span<const float> src, std::span<bfloat16_t> dst) noexcept {
+		assert(dst.size() >= src.size());
+		const std::size_t n = src.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		for (; i + 16 <= n; i += 16) {
+			detail::store16(dst.data() + i, _mm512_loadu_ps(src.data() + i));
+		}
+		if (i < n) {
+			__mmask16 m = detail::tail_mask16(n - i);
+			detail::mask_store16(dst.data() + i, m, _mm512_maskz_loadu_ps(m, src.data() + i));
+			i = n;
+		}
+#elif defined(BF16_HAVE_AVX2)
+		for (const std::size_t end = n / 8 * 8; i < end; i += 8) {
+			detail::store8(dst.data() + i, _mm256_loadu_ps(src.data() + i));
+		}
+#endif
+		for (; i < n; ++i) {
+			dst[i] = detail::narrow(src[i]);
+		}
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
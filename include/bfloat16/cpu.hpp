@@ -0,0 +1,76 @@
+/**
+ * @file cpu.hpp
+ * @brief Run-time CPU feature detection
+ *
+ * Reports what the host supports, independent of the flags this translation
+ * unit was compiled with. The flags reflect CPUID, which also covers whether
+ * the OS saves the wider vector state.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_CPU_HPP
+#define BFLOAT16_CPU_HPP
+
+namespace bf16 {
+
+	struct cpu_feature_set {
+		bool sse42 = false;
+		bool popcnt = false;
+		bool avx2 = false;
+		bool fma = false;
+		bool f16c = false;
+		bool bmi1 = false;
+		bool bmi2 = false;
+		bool avx512f = false;
+		bool avx512bw = false;
+		bool avx512vl = false;
+		bool avx512dq = false;
+		bool avx512vbmi2 = false;
+		bool avx512bf16 = false;
+		bool amx_bf16 = false;
+	};
+
+	namespace detail {
+
+		inline cpu_feature_set detect_cpu_features() noexcept {
+			cpu_feature_set f;
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+			__builtin_cpu_init();
+			f.sse42 = __builtin_cpu_supports("sse4.2");
+			f.popcnt = __builtin_cpu_supports("popcnt");
+			f.avx2 = __builtin_cpu_supports("avx2");
+			f.fma = __builtin_cpu_supports("fma");
+			f.bmi1 = __builtin_cpu_supports("bmi");
+			f.bmi2 = __builtin_cpu_supports("bmi2");
+			f.avx512f = __builtin_cpu_supports("avx512f");
+			f.avx512bw = __builtin_cpu_supports("avx512bw");
+			f.avx512vl = __builtin_cpu_supports("avx512vl");
+			f.avx512dq = __builtin_cpu_supports("avx512dq");
+			f.avx512vbmi2 = __builtin_cpu_supports("avx512vbmi2");
+			f.avx512bf16 = __builtin_cpu_supports("avx512bf16");
+			// No __builtin_cpu_supports names for these: CPUID leaf 1 ECX bit 29 and
+			// leaf 7 EDX bit 22. AMX also needs the OS to grant tile state (Linux
+			// arch_prctl), which is left to the caller.
+			unsigned a, b, c, d;
+			__asm__("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(1), "c"(0));
+			f.f16c = f.avx2 && ((c >> 29) & 1);
+			__asm__("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(0), "c"(0));
+			if (a >= 7) {
+				__asm__("cpuid" : "=a"(a), "=b"(b), "=c"(c), "=d"(d) : "a"(7), "c"(0));
+				f.amx_bf16 = (d >> 22) & 1;
+			}
+#endif
+			return f;
+		}
+
+	} // namespace detail
+
+	// Detected once; later calls return the cached result
+	inline const cpu_feature_set& cpu_features() noexcept {
+		static const cpu_feature_set features = detail::detect_cpu_features();
+		return features;
+	}
+
+} // namespace bf16
+
+#endif
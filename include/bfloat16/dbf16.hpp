@@ -0,0 +1,229 @@
+/**
+ * @file dbf16.hpp
+ * @brief Double-bfloat16: an unevaluated sum of two bfloat16_t in 32 bits
+ *
+ * dbf16 holds hi + lo with |lo| <= half an ulp of hi, which gives 16-17
+ * significant bits over the full fp32 exponent range. That is twice the
+ * precision of bfloat16_t and half the footprint of a float plus a bf16 copy,
+ * for state such as optimizer moments that bf16 rounds away. The value always
+ * fits in a float exactly, so arithmetic works in fp32. The exact result is
+ * recovered with TwoSum / TwoProd (or an fma remainder for / and sqrt) and
+ * rounded back into a hi/lo pair. Only the final rounding to ~16 bits loses
+ * anything. Storage is hi then lo, so a dbf16 array is one 32-bit word per
+ * element with hi in the low half.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_DBF16_HPP
+#define BFLOAT16_DBF16_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace bf16 {
+
+	class dbf16 {
+		private:
+			bfloat16_t hi_;
+			bfloat16_t lo_;
+
+			// Round s + e (|e| well below an ulp of s) into a pair
+			static dbf16 from_sum(float s, float e) noexcept {
+				dbf16 r(s);
+				if (std::isfinite(s)) r.lo_ = bfloat16_t((s - static_cast<float>(r.hi_)) + e);
+				return r;
+			}
+
+			static float two_sum_error(float a, float b, float s) noexcept {
+				const float bb = s - a;
+				return (a - (s - bb)) + (b - bb);
+			}
+
+		public:
+			constexpr dbf16() noexcept = default;
+
+			constexpr dbf16(bfloat16_t v) noexcept : hi_(v) {}
+
+			// Nearest pair: hi = bfloat16_t(v) and lo the rounded remainder. Values
+			// that would round up to infinity truncate both terms instead.
+			constexpr dbf16(float v) noexcept {
+				const uint32_t bits = std::bit_cast<uint32_t>(v);
+				const uint32_t hb = detail::leading_bits(bits);
+				hi_ = bfloat16_t::from_bits(static_cast<uint16_t>(hb >> 16));
+				if ((bits & 0x7F800000u) == 0x7F800000u) return;
+				uint32_t rb = std::bit_cast<uint32_t>(v - std::bit_cast<float>(hb));
+				// A zero remainder keeps the sign of v, so hi + lo is -0 for -0
+				if ((rb & 0x7FFFFFFFu) == 0) rb = bits & 0x80000000u;
+				const bool truncated = hb != ((bits + 0x7FFF) & 0xFFFF0000u);
+				lo_ = bfloat16_t::from_bits(static_cast<uint16_t>((truncated ? rb : rb + 0x7FFF) >> 16));
+			}
+
+			static constexpr dbf16 from_parts(bfloat16_t hi, bfloat16_t lo) noexcept {
+				dbf16 r;
+				r.hi_ = hi;
+				r.lo_ = lo;
+				return r;
+			}
+
+			constexpr bfloat16_t hi() const noexcept { return hi_; }
+			constexpr bfloat16_t lo() const noexcept { return lo_; }
+
+			// Exact
+			constexpr explicit operator float() const noexcept {
+				return static_cast<float>(hi_) + static_cast<float>(lo_);
+			}
+
+			// Rounds to the leading term
+			constexpr explicit operator bfloat16_t() const noexcept {
+				return hi_;
+			}
+
+			constexpr std::partial_ordering operator<=>(const dbf16& other) const noexcept {
+				return static_cast<float>(*this) <=> static_cast<float>(other);
+			}
+
+			constexpr bool operator==(const dbf16& other) const noexcept {
+				return static_cast<float>(*this) == static_cast<float>(other);
+			}
+
+			constexpr dbf16 operator-() const noexcept {
+				return from_parts(-hi_, -lo_);
+			}
+
+			dbf16& operator+=(const dbf16& other) noexcept {
+				const float a = static_cast<float>(*this), b = static_cast<float>(other);
+				const float s = a + b;
+				return *this = from_sum(s, two_sum_error(a, b, s));
+			}
+
+			dbf16& operator-=(const dbf16& other) noexcept {
+				return *this += -other;
+			}
+
+			dbf16& operator*=(const dbf16& other) noexcept {
+				const float a = static_cast<float>(*this), b = static_cast<float>(other);
+				const float p = a * b;
+				return *this = from_sum(p, std::fma(a, b, -p));
+			}
+
+			dbf16& operator/=(const dbf16& other) noexcept {
+				const float a = static_cast<float>(*this), b = static_cast<float>(other);
+				const float q = a / b;
+				return *this = from_sum(q, std::fma(-q, b, a) / b);
+			}
+
+			friend dbf16 operator+(dbf16 lhs, const dbf16& rhs) noexcept { return lhs += rhs; }
+			friend dbf16 operator-(dbf16 lhs, const dbf16& rhs) noexcept { return lhs -= rhs; }
+			friend dbf16 operator*(dbf16 lhs, const dbf16& rhs) noexcept { return lhs *= rhs; }
+			friend dbf16 operator/(dbf16 lhs, const dbf16& rhs) noexcept { return lhs /= rhs; }
+
+			friend dbf16 sqrt(const dbf16& x) noexcept {
+				const float a = static_cast<float>(x);
+				const float s = std::sqrt(a);
+				if (!(s > 0.0f) || !std::isfinite(s)) return dbf16(s);
+				return from_sum(s, std::fma(-s, s, a) / (2.0f * s));
+			}
+
+			friend constexpr dbf16 abs(const dbf16& x) noexcept {
+				return x.hi_.bits() & 0x8000 ? -x : x;
+			}
+	};
+
+	static_assert(sizeof(dbf16) == 4, "dbf16 must pack into 32 bits");
+
+	BF16_ISA_BEGIN
+
+	// Widen src into dst (dst.size() >= src.size()); exact
+	inline void to_float(std::span<const dbf16> src, std::span<float> dst) noexcept {
+		assert(dst.size() >= src.size());
+		const std::size_t n = src.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		const uint32_t* words = reinterpret_cast<const uint32_t*>(src.data());
+		const __m512i upper = _mm512_set1_epi32(static_cast<int>(0xFFFF0000u));
+		for (; i < n; i += 16) {
+			const __mmask16 m = detail::tail_mask16(n - i);
+			const __m512i w = _mm512_maskz_loadu_epi32(m, words + i);
+			const __m512 hi = _mm512_castsi512_ps(_mm512_maskz_slli_epi32(detail::full16, w, 16));
+			const __m512 lo = _mm512_castsi512_ps(_mm512_and_si512(w, upper));
+			_mm512_mask_storeu_ps(dst.data() + i, m, _mm512_add_ps(hi, lo));
+		}
+		i = n;
+#elif defined(BF16_HAVE_AVX2)
+		const uint32_t* words = reinterpret_cast<const uint32_t*>(src.data());
+		const __m256i upper = _mm256_set1_epi32(static_cast<int>(0xFFFF0000u));
+		for (; i + 8 <= n; i += 8) {
+			const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(words + i));
+			const __m256 hi = _mm256_castsi256_ps(_mm256_slli_epi32(w, 16));
+			const __m256 lo = _mm256_castsi256_ps(_mm256_and_si256(w, upper));
+			_mm256_storeu_ps(dst.data() + i, _mm256_add_ps(hi, lo));
+		}
+#endif
+		for (; i < n; ++i) dst[i] = static_cast<float>(src[i]);
+	}
+
+	// Narrow src into dst with the same rounding as dbf16(float)
+	inline void from_float(std::span<const float> src, std::span<dbf16> dst) noexcept {
+		assert(dst.size() >= src.size());
+		const std::size_t n = src.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		uint32_t* words = reinterpret_cast<uint32_t*>(dst.data());
+		const __m512i exponent = _mm512_set1_epi32(0x7F800000);
+		const __m512i upper = _mm512_set1_epi32(static_cast<int>(0xFFFF0000u));
+		const __m512i half = _mm512_set1_epi32(0x7FFF);
+		const __m512i sign = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+		const __m512i magnitude = _mm512_set1_epi32(0x7FFFFFFF);
+		for (; i < n; i += 16) {
+			const __mmask16 m = detail::tail_mask16(n - i);
+			const __m512 v = _mm512_maskz_loadu_ps(m, src.data() + i);
+			const __m512i xb = _mm512_castps_si512(v);
+			const __mmask16 finite = _mm512_cmpneq_epi32_mask(_mm512_and_si512(xb, exponent), exponent);
+			__m512i hb = _mm512_and_si512(_mm512_add_epi32(xb, half), upper);
+			const __mmask16 overflow = _mm512_mask_cmpeq_epi32_mask(finite, _mm512_and_si512(hb, exponent), exponent);
+			hb = _mm512_mask_and_epi32(hb, overflow, xb, upper);
+			__m512i rb = _mm512_castps_si512(_mm512_maskz_sub_ps(finite, v, _mm512_castsi512_ps(hb)));
+			rb = _mm512_mask_and_epi32(rb, _mm512_mask_testn_epi32_mask(finite, rb, magnitude), xb, sign);
+			__m512i lb = _mm512_and_si512(_mm512_add_epi32(rb, half), upper);
+			lb = _mm512_mask_and_epi32(lb, overflow, rb, upper);
+			_mm512_mask_storeu_epi32(words + i, m, _mm512_or_si512(_mm512_maskz_srli_epi32(detail::full16, hb, 16), lb));
+		}
+		i = n;
+#elif defined(BF16_HAVE_AVX2)
+		uint32_t* words = reinterpret_cast<uint32_t*>(dst.data());
+		const __m256i exponent = _mm256_set1_epi32(0x7F800000);
+		const __m256i upper = _mm256_set1_epi32(static_cast<int>(0xFFFF0000u));
+		const __m256i half = _mm256_set1_epi32(0x7FFF);
+		const __m256i sign = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+		const __m256i magnitude = _mm256_set1_epi32(0x7FFFFFFF);
+		for (; i + 8 <= n; i += 8) {
+			const __m256 v = _mm256_loadu_ps(src.data() + i);
+			const __m256i xb = _mm256_castps_si256(v);
+			const __m256i nonfinite = _mm256_cmpeq_epi32(_mm256_and_si256(xb, exponent), exponent);
+			__m256i hb = _mm256_and_si256(_mm256_add_epi32(xb, half), upper);
+			const __m256i overflow = _mm256_andnot_si256(nonfinite, _mm256_cmpeq_epi32(_mm256_and_si256(hb, exponent), exponent));
+			hb = _mm256_blendv_epi8(hb, _mm256_and_si256(xb, upper), overflow);
+			__m256i rb = _mm256_castps_si256(_mm256_andnot_ps(_mm256_castsi256_ps(nonfinite), _mm256_sub_ps(v, _mm256_castsi256_ps(hb))));
+			const __m256i zero = _mm256_andnot_si256(nonfinite, _mm256_cmpeq_epi32(_mm256_and_si256(rb, magnitude), _mm256_setzero_si256()));
+			rb = _mm256_blendv_epi8(rb, _mm256_and_si256(xb, sign), zero);
+			__m256i lb = _mm256_and_si256(_mm256_add_epi32(rb, half), upper);
+			lb = _mm256_blendv_epi8(lb, _mm256_and_si256(rb, upper), overflow);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(words + i), _mm256_or_si256(_mm256_srli_epi32(hb, 16), lb));
+		}
+#endif
+		for (; i < n; ++i) dst[i] = dbf16(src[i]);
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
@@ -0,0 +1,251 @@
+/**
+ * @file denormal.hpp
+ * @brief Scoped flush-to-zero control and kernels that flush bf16 subnormals explicitly
+ *
+ * bfloat16_t has subnormals, and every kernel widens to fp32, where x86 handles
+ * subnormal operands and results in microcode at 100+ cycles each. Two ways
+ * out, usable together:
+ *  - flush_denormals_guard sets FTZ and DAZ in MXCSR (FZ in FPCR on AArch64)
+ *    for the current thread and restores the previous state on scope exit;
+ *  - the denormal_mode::flush overloads below turn subnormal bf16 inputs (and
+ *    converted outputs) into signed zeros as part of the call, independent of
+ *    the FP environment. Subnormal intermediates of the reductions (tiny
+ *    products, partial sums) are flushed only where the guard has a control
+ *    register to set: x86 and AArch64.
+ * Integer-only conversions never slow down on subnormals, so for them flushing
+ * is only about the values produced. The dot product on AVX-512 BF16 already
+ * flushes (vdpbf16ps is DAZ/FTZ) in either mode.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_DENORMAL_HPP
+#define BFLOAT16_DENORMAL_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/detail/isa.hpp>
+#include <bfloat16/reduce.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#endif
+
+namespace bf16 {
+
+	// Per-call subnormal handling for the overloads in this header
+	enum class denormal_mode : uint8_t { preserve, flush };
+
+	namespace detail {
+
+#if defined(__SSE__) || defined(_M_X64)
+		// MXCSR FTZ (results) and DAZ (operands)
+		inline constexpr unsigned fp_flush_bits = 0x8040;
+
+		inline unsigned read_fp_control() noexcept { return _mm_getcsr(); }
+		inline void write_fp_control(unsigned v) noexcept { _mm_setcsr(v); }
+#elif defined(__aarch64__) && defined(__GNUC__)
+		// FPCR.FZ covers both operands and results
+		inline constexpr unsigned fp_flush_bits = 1u << 24;
+
+		inline unsigned read_fp_control() noexcept {
+			uint64_t v;
+			__asm__ __volatile__("mrs %0, fpcr" : "=r"(v));
+			return static_cast<unsigned>(v);
+		}
+
+		inline void write_fp_control(unsigned v) noexcept {
+			__asm__ __volatile__("msr fpcr, %0" : : "r"(static_cast<uint64_t>(v)));
+		}
+#else
+		// No known control register: the guard does nothing
+		inline constexpr unsigned fp_flush_bits = 0;
+
+		inline unsigned read_fp_control() noexcept { return 0; }
+		inline void write_fp_control(unsigned) noexcept {}
+#endif
+
+	} // namespace detail
+
+	// Whether subnormals are currently flushed in this thread's fp32 arithmetic
+	inline bool denormals_flushed() noexcept {
+		return detail::fp_flush_bits != 0 && (detail::read_fp_control() & detail::fp_flush_bits) == detail::fp_flush_bits;
+	}
+
+	// Flush subnormal operands and results to zero in this thread until the
+	// guard goes out of scope. Guards nest; each restores what it found.
+	class flush_denormals_guard {
+		private:
+			unsigned saved;
+
+		public:
+			flush_denormals_guard() noexcept : saved(detail::read_fp_control()) {
+				detail::write_fp_control(saved | detail::fp_flush_bits);
+			}
+
+			~flush_denormals_guard() {
+				detail::write_fp_control(saved);
+			}
+
+			flush_denormals_guard(const flush_denormals_guard&) = delete;
+			flush_denormals_guard& operator=(const flush_denormals_guard&) = delete;
+	};
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		// Subnormal bits -> zero of the same sign; everything else unchanged
+		constexpr uint16_t flush_subnormal_bits(uint16_t bits) noexcept {
+			return (bits & 0x7F80) == 0 ? static_cast<uint16_t>(bits & 0x8000) : bits;
+		}
+
+#if defined(BF16_HAVE_AVX2)
+		// 16 lanes of bf16 bits
+		inline __m256i flush_subnormal_bits(__m256i v) noexcept {
+			const __m256i tiny = _mm256_cmpeq_epi16(_mm256_and_si256(v, _mm256_set1_epi16(0x7F80)), _mm256_setzero_si256());
+			return _mm256_andnot_si256(_mm256_and_si256(tiny, _mm256_set1_epi16(0x7FFF)), v);
+		}
+#endif
+
+		inline void flush_subnormals(bfloat16_t* x, std::size_t n) noexcept {
+			std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+			const __m512i exponent = _mm512_set1_epi16(0x7F80);
+			const __m512i sign = _mm512_set1_epi16(static_cast<int16_t>(0x8000));
+			for (; i < n; i += 32) {
+				const __mmask32 m = tail_mask32(n - i);
+				const __m512i v = _mm512_maskz_loadu_epi16(m, x + i);
+				const __mmask32 tiny = _mm512_mask_testn_epi16_mask(m, v, exponent);
+				_mm512_mask_storeu_epi16(x + i, tiny, _mm512_and_si512(v, sign));
+			}
+			i = n;
+#elif defined(BF16_HAVE_AVX2)
+			for (; i + 16 <= n; i += 16) {
+				__m256i* p = reinterpret_cast<__m256i*>(x + i);
+				_mm256_storeu_si256(p, flush_subnormal_bits(_mm256_loadu_si256(p)));
+			}
+#endif
+			for (; i < n; ++i) x[i].bits() = flush_subnormal_bits(x[i].bits());
+		}
+
+		// Copy of n values with subnormals flushed
+		inline void copy_flushed(const bfloat16_t* src, std::size_t n, bfloat16_t* dst) noexcept {
+			std::copy_n(src, n, dst);
+			flush_subnormals(dst, n);
+		}
+
+		// Reductions with flush read their operands through buffers this size
+		inline constexpr std::size_t flush_chunk = 1024;
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// Replace every subnormal in x by a zero of the same sign
+	inline void flush_denormals(std::span<bfloat16_t> x) noexcept {
+		detail::flush_subnormals(x.data(), x.size());
+	}
+
+	// to_float; flush widens subnormal inputs as signed zeros
+	inline void to_float(std::span<const bfloat16_t> src, std::span<float> dst, denormal_mode mode) noexcept {
+		if (mode == denormal_mode::preserve) return to_float(src, dst);
+		assert(dst.size() >= src.size());
+		const std::size_t n = src.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX2)
+		for (; i + 16 <= n; i += 16) {
+			const __m256i raw = detail::flush_subnormal_bits(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src.data() + i)));
+#if defined(BF16_HAVE_AVX512)
+			_mm512_storeu_ps(dst.data() + i, detail::widen16(raw));
+#else
+			const __m256i lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(raw));
+			const __m256i hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(raw, 1));
+			_mm256_storeu_ps(dst.data() + i, _mm256_castsi256_ps(_mm256_slli_epi32(lo, 16)));
+			_mm256_storeu_ps(dst.data() + i + 8, _mm256_castsi256_ps(_mm256_slli_epi32(hi, 16)));
+#endif
+		}
+#endif
+		for (; i < n; ++i) dst[i] = detail::widen_bits(detail::flush_subnormal_bits(src[i].bits()));
+	}
+
+	// from_float; flush also turns results that round to a bf16 subnormal into signed zeros
+	inline void from_float(std::span<const float> src, std::span<bfloat16_t> dst, denormal_mode mode) noexcept {
+		if (mode == denormal_mode::preserve) return from_float(src, dst);
+		assert(dst.size() >= src.size());
+		// Chunks small enough that the flush pass reads dst back from L1
+		constexpr std::size_t chunk = 1024;
+		for (std::size_t i = 0; i < src.size(); i += chunk) {
+			const std::size_t len = std::min(chunk, src.size() - i);
+			from_float(src.subspan(i, len), dst.subspan(i, len));
+			detail::flush_subnormals(dst.data() + i, len);
+		}
+	}
+
+	// The reductions with flush read the operands through an L1-sized buffer
+	// with subnormals flushed, under a flush_denormals_guard that also keeps
+	// subnormal products and partial sums off the slow path
+	inline float dot(std::span<const bfloat16_t> a, std::span<const bfloat16_t> b, denormal_mode mode) noexcept {
+		if (mode == denormal_mode::preserve) return dot(a, b);
+		assert(a.size() == b.size());
+		flush_denormals_guard guard;
+		bfloat16_t fa[detail::flush_chunk], fb[detail::flush_chunk];
+		float s = 0.0f;
+		for (std::size_t i = 0; i < a.size(); i += detail::flush_chunk) {
+			const std::size_t len = std::min(detail::flush_chunk, a.size() - i);
+			detail::copy_flushed(a.data() + i, len, fa);
+			detail::copy_flushed(b.data() + i, len, fb);
+			s += detail::dot_kernel(fa, fb, len);
+		}
+		return s;
+	}
+
+	inline float sum(std::span<const bfloat16_t> x, denormal_mode mode) noexcept {
+		if (mode == denormal_mode::preserve) return sum(x);
+		flush_denormals_guard guard;
+		bfloat16_t fx[detail::flush_chunk];
+		float s = 0.0f;
+		for (std::size_t i = 0; i < x.size(); i += detail::flush_chunk) {
+			const std::size_t len = std::min(detail::flush_chunk, x.size() - i);
+			detail::copy_flushed(x.data() + i, len, fx);
+			s += detail::sum_kernel(fx, len);
+		}
+		return s;
+	}
+
+	// Same range fallback as norm(x)
+	inline float norm(std::span<const bfloat16_t> x, denormal_mode mode) noexcept {
+		if (mode == denormal_mode::preserve) return norm(x);
+		flush_denormals_guard guard;
+		bfloat16_t fx[detail::flush_chunk];
+		const auto sumsq = [&](float scale) noexcept {
+			float ss = 0.0f;
+			for (std::size_t i = 0; i < x.size(); i += detail::flush_chunk) {
+				const std::size_t len = std::min(detail::flush_chunk, x.size() - i);
+				detail::copy_flushed(x.data() + i, len, fx);
+				ss += detail::sumsq_kernel(fx, len, scale);
+			}
+			return ss;
+		};
+		const float ss = sumsq(1.0f);
+		if (!detail::norm_out_of_range(ss)) return std::sqrt(ss);
+
+		const uint16_t amax = detail::max_abs_bits(x.data(), x.size());
+		if (amax == 0) return 0.0f;
+		if (amax >= 0x7F80) return detail::widen_bits(amax);  // inf, or NaN
+		const float scale = detail::norm_scale(amax);
+		return scale * std::sqrt(sumsq(1.0f / scale));
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
@@ -0,0 +1,197 @@
+/**
+ * @file constexpr_math.hpp
+ * @brief Constant-evaluable sqrt/exp/log/pow/sin/cos/tan backing the bfloat16_t math functions
+ *
+ * Evaluated in double, so after rounding to float and then to bf16 the results
+ * match the <cmath> float functions used at run time. Only selected inside
+ * `if consteval`; run-time calls never reach this code.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_DETAIL_CONSTEXPR_MATH_HPP
+#define BFLOAT16_DETAIL_CONSTEXPR_MATH_HPP
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+namespace bf16::detail::cx {
+
+	inline constexpr double inf = std::numeric_limits<double>::infinity();
+	inline constexpr double qnan = std::numeric_limits<double>::quiet_NaN();
+	inline constexpr double ln2 = 0.69314718055994530942;
+
+	// fdlibm's three-part pi/2: n * pio2_1 and n * pio2_2 are exact for |n| < 2^20
+	inline constexpr double pio2_1 = 1.57079632673412561417e+00;
+	inline constexpr double pio2_2 = 6.07710050630396597660e-11;
+	inline constexpr double pio2_2t = 2.02226624879595063154e-21;
+
+	constexpr bool is_nan(double x) noexcept { return x != x; }
+
+	constexpr int64_t round_to_int(double x) noexcept {
+		return static_cast<int64_t>(x < 0.0 ? x - 0.5 : x + 0.5);
+	}
+
+	// x * 2^e without overflowing intermediates
+	constexpr double ldexp(double x, int64_t e) noexcept {
+		for (; e > 0; --e) x *= 2.0;
+		for (; e < 0; ++e) x *= 0.5;
+		return x;
+	}
+
+	// Double to float with saturation: out-of-range conversions are not constant expressions
+	constexpr float to_float(double x) noexcept {
+		constexpr double max = std::numeric_limits<float>::max();
+		if (x > max) return std::numeric_limits<float>::infinity();
+		if (x < -max) return -std::numeric_limits<float>::infinity();
+		return static_cast<float>(x);
+	}
+
+	constexpr double sqrt(double x) noexcept {
+		if (is_nan(x) || x == 0.0 || x == inf) return x;
+		if (x < 0.0) return qnan;
+		// Scale into [1, 4) by powers of four, then Newton from a linear guess
+		int64_t half_exp = 0;
+		for (; x >= 4.0; x *= 0.25) ++half_exp;
+		for (; x < 1.0; x *= 4.0) --half_exp;
+		double y = 0.5 * (1.0 + x);
+		for (int i = 0; i < 6; ++i) y = 0.5 * (y + x / y);
+		return ldexp(y, half_exp);
+	}
+
+	constexpr double exp(double x) noexcept {
+		if (is_nan(x)) return x;
+		if (x > 710.0) return inf;
+		if (x < -746.0) return 0.0;
+		// x = n ln2 + r with |r| <= ln2 / 2, Taylor series for e^r
+		const int64_t n = round_to_int(x / ln2);
+		const double r = x - static_cast<double>(n) * ln2;
+		double term = 1.0, sum = 1.0;
+		for (int i = 1; i < 24; ++i) {
+			term *= r / i;
+			sum += term;
+		}
+		return ldexp(sum, n);
+	}
+
+	constexpr double log(double x) noexcept {
+		if (is_nan(x) || x == inf) return x;
+		if (x < 0.0) return qnan;
+		if (x == 0.0) return -inf;
+		// x = m 2^e with m in [sqrt(1/2), sqrt(2)); log m = 2 atanh((m - 1) / (m + 1))
+		int64_t e = 0;
+		for (; x >= 1.4142135623730951; x *= 0.5) ++e;
+		for (; x < 0.7071067811865476; x *= 2.0) --e;
+		const double s = (x - 1.0) / (x + 1.0), s2 = s * s;
+		double term = s, sum = 0.0;
+		for (int i = 1; i < 60; i += 2) {
+			sum += term / i;
+			term *= s2;
+		}
+		return static_cast<double>(e) * ln2 + 2.0 * sum;
+	}
+
+	constexpr bool is_integer(double y) noexcept {
+		if (y >= 9007199254740992.0 || y <= -9007199254740992.0) return true;
+		return static_cast<double>(static_cast<int64_t>(y)) == y;
+	}
+
+	constexpr bool is_odd_integer(double y) noexcept {
+		if (y >= 9007199254740992.0 || y <= -9007199254740992.0) return false;
+		return is_integer(y) && static_cast<int64_t>(y) % 2 != 0;
+	}
+
+	// Special cases follow C's pow()
+	constexpr double pow(double x, double y) noexcept {
+		if (y == 0.0 || x == 1.0) return 1.0;
+		if (is_nan(x) || is_nan(y)) return qnan;
+		if (x == -1.0 && (y == inf || y == -inf)) return 1.0;
+		if (x == 0.0) {
+			const bool negative = is_odd_integer(y) && (std::bit_cast<uint64_t>(x) >> 63) != 0;
+			const double r = y > 0.0 ? 0.0 : inf;
+			return negative ? -r : r;
+		}
+		if (x == -inf) {
+			const double r = y > 0.0 ? inf : 0.0;
+			return is_odd_integer(y) ? -r : r;
+		}
+		if (x < 0.0) {
+			if (!is_integer(y)) return qnan;
+			const double r = pow(-x, y);
+			return is_odd_integer(y) ? -r : r;
+		}
+		if (y == inf) return x > 1.0 ? inf : 0.0;
+		if (y == -inf) return x > 1.0 ? 0.0 : inf;
+		return exp(y * log(x));
+	}
+
+	// sin and cos of |r| <= pi/4 by Taylor series
+	constexpr double sin_kernel(double r) noexcept {
+		double term = r, sum = r;
+		for (int i = 1; i < 14; ++i) {
+			term *= -r * r / ((2 * i) * (2 * i + 1));
+			sum += term;
+		}
+		return sum;
+	}
+
+	constexpr double cos_kernel(double r) noexcept {
+		double term = 1.0, sum = 1.0;
+		for (int i = 1; i < 14; ++i) {
+			term *= -r * r / ((2 * i - 1) * (2 * i));
+			sum += term;
+		}
+		return sum;
+	}
+
+	// Largest argument the three-part reduction handles exactly
+	inline constexpr double trig_limit = 1.0e6;
+
+	constexpr bool in_trig_range(double x) noexcept {
+		return is_nan(x) || x == inf || x == -inf || (x > -trig_limit && x < trig_limit);
+	}
+
+	// x = n pi/2 + r; returns r and the quadrant n mod 4
+	constexpr double reduce_pio2(double x, int& quadrant) noexcept {
+		const int64_t n = round_to_int(x / pio2_1);
+		const double nd = static_cast<double>(n);
+		quadrant = static_cast<int>(n & 3);
+		return ((x - nd * pio2_1) - nd * pio2_2) - nd * pio2_2t;
+	}
+
+	constexpr double sin(double x) noexcept {
+		if (x == 0.0) return x;
+		if (is_nan(x) || x == inf || x == -inf) return qnan;
+		int q = 0;
+		const double r = reduce_pio2(x, q);
+		switch (q) {
+			case 0: return sin_kernel(r);
+			case 1: return cos_kernel(r);
+			case 2: return -sin_kernel(r);
+			default: return -cos_kernel(r);
+		}
+	}
+
+	constexpr double cos(double x) noexcept {
+		if (is_nan(x) || x == inf || x == -inf) return qnan;
+		int q = 0;
+		const double r = reduce_pio2(x, q);
+		switch (q) {
+			case 0: return cos_kernel(r);
+			case 1: return -sin_kernel(r);
+			case 2: return -cos_kernel(r);
+			default: return sin_kernel(r);
+		}
+	}
+
+	constexpr double tan(double x) noexcept {
+		if (x == 0.0) return x;
+		if (is_nan(x) || x == inf || x == -inf) return qnan;
+		int q = 0;
+		const double r = reduce_pio2(x, q);
+		return (q & 1) ? -cos_kernel(r) / sin_kernel(r) : sin_kernel(r) / cos_kernel(r);
+	}
+
+} // namespace bf16::detail::cx
+
+#endif
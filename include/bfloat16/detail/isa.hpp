@@ -0,0 +1,229 @@
+/**
+ * @file isa.hpp
+ * @brief Instruction-set selection and vector helpers shared by the bulk kernels
+ *
+ * Kernels pick their implementation from the compiler's target macros, so a
+ * translation unit built with -mavx512bf16 / -mavx2 gets the matching code path
+ * and anything else falls back to portable scalar loops.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_DETAIL_ISA_HPP
+#define BFLOAT16_DETAIL_ISA_HPP
+
+#include <bfloat16/bfloat16.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// AVX-512 builds also take the AVX2 paths (layout transposes), so require both
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VL__) && defined(__AVX2__) && defined(__FMA__)
+#define BF16_HAVE_AVX512 1
+#endif
+
+#if defined(BF16_HAVE_AVX512) && defined(__AVX512BF16__)
+#define BF16_HAVE_AVX512BF16 1
+#endif
+
+#if defined(BF16_HAVE_AVX512) && defined(__AVX512VBMI2__)
+#define BF16_HAVE_AVX512VBMI2 1
+#endif
+
+#if defined(__AVX2__) && defined(__FMA__)
+#define BF16_HAVE_AVX2 1
+#endif
+
+// PDEP/PEXT are microcoded on AMD before Zen 3 (tens to hundreds of cycles,
+// depending on the mask), so the paths using them are opt-in: define
+// BF16_USE_PDEP, for the whole program, when every target has a fast
+// implementation. They give the same bits as the shift paths.
+#if defined(BF16_USE_PDEP) && defined(BF16_HAVE_AVX2) && defined(__BMI2__)
+#define BF16_HAVE_PDEP 1
+#endif
+
+#if defined(BF16_HAVE_AVX512) || defined(BF16_HAVE_AVX2)
+#include <immintrin.h>
+#endif
+
+// Everything whose code depends on the macros above lives in an inline
+// namespace named after the selected instruction set. Translation units built
+// with different -m flags then never share an inline kernel symbol that the
+// linker could merge into the wrong one. Builds that compile the same headers
+// several times with different flags (the bfloat16_kernels library) pin a
+// distinct name per copy with -DBF16_ISA_NAMESPACE=...
+#if !defined(BF16_ISA_NAMESPACE)
+#if defined(BF16_HAVE_AVX512BF16) && defined(BF16_HAVE_AVX512VBMI2)
+#define BF16_ISA_NAMESPACE isa_avx512bf16_vbmi2
+#elif defined(BF16_HAVE_AVX512BF16)
+#define BF16_ISA_NAMESPACE isa_avx512bf16
+#elif defined(BF16_HAVE_AVX512VBMI2)
+#define BF16_ISA_NAMESPACE isa_avx512_vbmi2
+#elif defined(BF16_HAVE_AVX512)
+#define BF16_ISA_NAMESPACE isa_avx512
+#elif defined(BF16_HAVE_AVX2)
+#define BF16_ISA_NAMESPACE isa_avx2
+#else
+#define BF16_ISA_NAMESPACE isa_generic
+#endif
+#endif
+
+#define BF16_ISA_BEGIN inline namespace BF16_ISA_NAMESPACE {
+#define BF16_ISA_END }
+
+namespace bf16::detail {
+
+	BF16_ISA_BEGIN
+
+	// Same rounding as bfloat16_t(float): add 0x7FFF and keep the upper half.
+	// Every bulk kernel narrows through this so results match the scalar type bit for bit.
+	constexpr uint16_t narrow_bits(uint32_t float_bits) noexcept {
+		return static_cast<uint16_t>((float_bits + 0x7FFF) >> 16);
+	}
+
+	// The leading bf16 term of a multi-term representation, as fp32 bits:
+	// narrow_bits rounding, except that finite values rounding up to infinity
+	// are truncated instead so the remainder stays finite
+	constexpr uint32_t leading_bits(uint32_t float_bits) noexcept {
+		const uint32_t hb = (float_bits + 0x7FFF) & 0xFFFF0000u;
+		const bool finite = (float_bits & 0x7F800000u) != 0x7F800000u;
+		return finite && (hb & 0x7F800000u) == 0x7F800000u ? (float_bits & 0xFFFF0000u) : hb;
+	}
+
+	constexpr float widen_bits(uint16_t bits) noexcept {
+		return std::bit_cast<float>(static_cast<uint32_t>(bits) << 16);
+	}
+
+	// Map bf16 bits to a signed 16-bit key whose integer order is the total order
+	// of the values: -NaN < -inf < ... < -0 < +0 < ... < +inf < +NaN
+	constexpr int16_t order_key(uint16_t bits) noexcept {
+		const uint16_t flip = (bits & 0x8000) ? 0x7FFF : 0;
+		return static_cast<int16_t>(bits ^ flip);
+	}
+
+	constexpr uint16_t from_order_key(int16_t key) noexcept {
+		const uint16_t bits = static_cast<uint16_t>(key);
+		return bits ^ ((bits & 0x8000) ? 0x7FFF : 0);
+	}
+
+	constexpr bool is_nan_bits(uint16_t bits) noexcept {
+		return (bits & 0x7FFF) > 0x7F80;
+	}
+
+	inline float widen(const bfloat16_t& x) noexcept {
+		return widen_bits(x.bits());
+	}
+
+	inline bfloat16_t narrow(float f) noexcept {
+		bfloat16_t result;
+		result.bits() = narrow_bits(std::bit_cast<uint32_t>(f));
+		return result;
+	}
+
+#if defined(BF16_HAVE_AVX512)
+	// GCC 12 builds the unmasked forms of several AVX-512 intrinsics (immediate
+	// shifts, widening/narrowing conversions, min/max, alignr, broadcasts and the
+	// _mm512_reduce_* macros) on an undefined source register and reports it as
+	// uninitialized wherever they inline. The kernels use the zero-masked forms
+	// with a full mask, which compile to the same unmasked instructions, and the
+	// hsum16 / hmin16 / hmax16 reductions below.
+	inline constexpr __mmask16 full16 = 0xFFFF;
+	inline constexpr __mmask32 full32 = 0xFFFFFFFFu;
+
+	// 16 lanes: bf16 -> fp32 is a zero-extend and a shift
+	inline __m512 widen16(__m256i raw) noexcept {
+		return _mm512_castsi512_ps(_mm512_maskz_slli_epi32(full16, _mm512_maskz_cvtepu16_epi32(full16, raw), 16));
+	}
+
+	inline __m512 load16(const bfloat16_t* p) noexcept {
+		return widen16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+	}
+
+	inline __m512 maskz_load16(const bfloat16_t* p, __mmask16 m) noexcept {
+		return widen16(_mm256_maskz_loadu_epi16(m, p));
+	}
+
+	inline __m256i narrow16(__m512 v) noexcept {
+		__m512i bits = _mm512_add_epi32(_mm512_castps_si512(v), _mm512_set1_epi32(0x7FFF));
+		return _mm512_maskz_cvtepi32_epi16(full16, _mm512_maskz_srli_epi32(full16, bits, 16));
+	}
+
+	inline void store16(bfloat16_t* p, __m512 v) noexcept {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), narrow16(v));
+	}
+
+	inline void mask_store16(bfloat16_t* p, __mmask16 m, __m512 v) noexcept {
+		_mm256_mask_storeu_epi16(p, m, narrow16(v));
+	}
+
+	inline __mmask16 tail_mask16(std::size_t n) noexcept {
+		return static_cast<__mmask16>(n >= 16 ? 0xFFFF : (1u << n) - 1);
+	}
+
+	inline __mmask32 tail_mask32(std::size_t n) noexcept {
+		return n >= 32 ? 0xFFFFFFFFu : (1u << n) - 1;
+	}
+#endif
+
+#if defined(BF16_HAVE_AVX2)
+	// 8 lanes
+	inline __m256 load8(const bfloat16_t* p) noexcept {
+		__m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(raw), 16));
+	}
+
+	inline __m128i narrow8(__m256 v) noexcept {
+		__m256i bits = _mm256_add_epi32(_mm256_castps_si256(v), _mm256_set1_epi32(0x7FFF));
+		bits = _mm256_srli_epi32(bits, 16);
+		// packus keeps lanes in 128-bit halves; the values fit in 16 bits so saturation never triggers
+		__m128i lo = _mm256_castsi256_si128(bits);
+		__m128i hi = _mm256_extracti128_si256(bits, 1);
+		return _mm_packus_epi32(lo, hi);
+	}
+
+	inline void store8(bfloat16_t* p, __m256 v) noexcept {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p), narrow8(v));
+	}
+
+	inline float hsum8(__m256 v) noexcept {
+		__m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+		s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+		s = _mm_add_ss(s, _mm_movehdup_ps(s));
+		return _mm_cvtss_f32(s);
+	}
+#endif
+
+#if defined(BF16_HAVE_AVX512)
+	// Half H of v (_mm512_castps512_ps256 is also built on an undefined register)
+	template<int H>
+	inline __m256 half8(__m512 v) noexcept {
+		return _mm256_castpd_ps(_mm512_maskz_extractf64x4_pd(0xF, _mm512_castps_pd(v), H));
+	}
+
+	// Same tree as _mm512_reduce_add_ps: halves, quarters, then pairs
+	inline float hsum16(__m512 v) noexcept {
+		return hsum8(_mm256_add_ps(half8<1>(v), half8<0>(v)));
+	}
+
+	inline float hmin16(__m512 v) noexcept {
+		const __m256 h = _mm256_min_ps(half8<1>(v), half8<0>(v));
+		__m128 s = _mm_min_ps(_mm256_extractf128_ps(h, 1), _mm256_castps256_ps128(h));
+		s = _mm_min_ps(s, _mm_movehl_ps(s, s));
+		s = _mm_min_ss(s, _mm_movehdup_ps(s));
+		return _mm_cvtss_f32(s);
+	}
+
+	inline float hmax16(__m512 v) noexcept {
+		const __m256 h = _mm256_max_ps(half8<1>(v), half8<0>(v));
+		__m128 s = _mm_max_ps(_mm256_extractf128_ps(h, 1), _mm256_castps256_ps128(h));
+		s = _mm_max_ps(s, _mm_movehl_ps(s, s));
+		s = _mm_max_ss(s, _mm_movehdup_ps(s));
+		return _mm_cvtss_f32(s);
+	}
+#endif
+
+	BF16_ISA_END
+
+} // namespace bf16::detail
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file math.hpp
+ * @brief Vector-friendly fp32 exp used by the activation kernels and bf16::exp
+ *
+ * Cody-Waite range reduction and a degree-6 polynomial: relative error below
+ * 2 ulp of fp32 over the normal range, far finer than the bf16 outputs it feeds.
+ * Results below 2^-126 come out as correctly scaled subnormals; inputs below
+ * -104 give +0 and inputs above exp_hi give +inf.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_DETAIL_MATH_HPP
+#define BFLOAT16_DETAIL_MATH_HPP
+
+#include <bfloat16/detail/isa.hpp>
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace bf16::detail {
+
+	BF16_ISA_BEGIN
+
+	// ln(FLT_MAX); every path builds 2^n for n up to 128 without overflowing a factor
+	inline constexpr float exp_hi = 88.72283935546875f;
+	// Below exp_lo, e^x is under half the smallest fp32 subnormal and rounds to +0
+	inline constexpr float exp_lo = -104.0f;
+	inline constexpr float log2e = 1.44269504088896341f;
+	inline constexpr float ln2_hi = 0.693359375f;
+	inline constexpr float ln2_lo = -2.12194440e-4f;
+	inline constexpr float exp_c[6] = {
+		1.9875691500e-4f, 1.3981999507e-3f, 8.3334519073e-3f,
+		4.1665795894e-2f, 1.6666665459e-1f, 5.0000001201e-1f};
+
+	inline float exp_approx(float x) noexcept {
+		if (std::isnan(x)) return x;
+		if (x < exp_lo) return 0.0f;
+		if (x > exp_hi) return std::numeric_limits<float>::infinity();
+		const float n = std::nearbyint(x * log2e);
+		const float r = x - n * ln2_hi - n * ln2_lo;
+		float p = exp_c[0];
+		for (int i = 1; i < 6; ++i) p = p * r + exp_c[i];
+		p = p * r * r + r + 1.0f;
+		// 2^n in two normal factors, so results below 2^-126 round once into subnormals
+		const float n1 = std::floor(n * 0.5f);
+		const float s1 = std::bit_cast<float>(static_cast<int32_t>(n1 + 127.0f) << 23);
+		const float s2 = std::bit_cast<float>(static_cast<int32_t>(n - n1 + 127.0f) << 23);
+		return p * s1 * s2;
+	}
+
+#if defined(BF16_HAVE_AVX512)
+	inline __m512 exp16(__m512 x) noexcept {
+		const __mmask16 nan = _mm512_cmp_ps_mask(x, x, _CMP_UNORD_Q);
+		const __mmask16 zero = _mm512_cmp_ps_mask(x, _mm512_set1_ps(exp_lo), _CMP_LT_OQ);
+		const __mmask16 inf = _mm512_cmp_ps_mask(x, _mm512_set1_ps(exp_hi), _CMP_GT_OQ);
+		const __m512 in = x;
+		x = _mm512_maskz_min_ps(full16, _mm512_maskz_max_ps(full16, x, _mm512_set1_ps(exp_lo)), _mm512_set1_ps(exp_hi));
+		const __m512 n = _mm512_maskz_roundscale_ps(full16, _mm512_mul_ps(x, _mm512_set1_ps(log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		__m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(ln2_hi), x);
+		r = _mm512_fnmadd_ps(n, _mm512_set1_ps(ln2_lo), r);
+		__m512 p = _mm512_set1_ps(exp_c[0]);
+		for (int i = 1; i < 6; ++i) p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(exp_c[i]));
+		p = _mm512_fmadd_ps(p, _mm512_mul_ps(r, r), _mm512_add_ps(r, _mm512_set1_ps(1.0f)));
+		// scalef rounds results below 2^-126 into subnormals directly
+		__m512 result = _mm512_maskz_scalef_ps(static_cast<__mmask16>(~zero), p, n);
+		result = _mm512_mask_mov_ps(result, inf, _mm512_set1_ps(std::numeric_limits<float>::infinity()));
+		return _mm512_mask_mov_ps(result, nan, in);
+	}
+#endif
+
+#if defined(BF16_HAVE_AVX2)
+	inline __m256 exp8(__m256 x) noexcept {
+		const __m256 nan = _mm256_cmp_ps(x, x, _CMP_UNORD_Q);
+		const __m256 zero = _mm256_cmp_ps(x, _mm256_set1_ps(exp_lo), _CMP_LT_OQ);
+		const __m256 inf = _mm256_cmp_ps(x, _mm256_set1_ps(exp_hi), _CMP_GT_OQ);
+		const __m256 in = x;
+		x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(exp_lo)), _mm256_set1_ps(exp_hi));
+		const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+		__m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(ln2_hi), x);
+		r = _mm256_fnmadd_ps(n, _mm256_set1_ps(ln2_lo), r);
+		__m256 p = _mm256_set1_ps(exp_c[0]);
+		for (int i = 1; i < 6; ++i) p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(exp_c[i]));
+		p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+		// Same two-factor 2^n as exp_approx
+		const __m256 n1 = _mm256_floor_ps(_mm256_mul_ps(n, _mm256_set1_ps(0.5f)));
+		const __m256i bias = _mm256_set1_epi32(127);
+		const __m256i e1 = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n1), bias), 23);
+		const __m256i e2 = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(_mm256_sub_ps(n, n1)), bias), 23);
+		const __m256 result = _mm256_mul_ps(_mm256_mul_ps(p, _mm256_castsi256_ps(e1)), _mm256_castsi256_ps(e2));
+		const __m256 clamped = _mm256_blendv_ps(_mm256_andnot_ps(zero, result), _mm256_set1_ps(std::numeric_limits<float>::infinity()), inf);
+		return _mm256_blendv_ps(clamped, in, nan);
+	}
+#endif
+
+	BF16_ISA_END
+
+} // namespace bf16::detail
+
+#endif
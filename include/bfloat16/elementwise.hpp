@@ -0,0 +1,254 @@
+/**
+ * @file elementwise.hpp
+ * @brief Comparison, selection, clamping and activation kernels over bfloat16_t spans
+ *
+ * Most of these never widen to float: bf16 bits are mapped to a signed 16-bit
+ * key whose integer order matches the value order, so comparisons, min/max and
+ * clamping are plain 16-bit integer operations (32 lanes per AVX-512 register).
+ * Masks are one byte per element, 0 or 1.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_ELEMENTWISE_HPP
+#define BFLOAT16_ELEMENTWISE_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/detail/isa.hpp>
+#include <bfloat16/detail/math.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+namespace bf16 {
+
+	// IEEE semantics: any comparison with NaN is false except ne; -0 == +0
+	enum class compare_op { eq, ne, lt, le, gt, ge };
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		// Order key with -0 folded onto +0, for IEEE-style comparisons
+		constexpr int16_t compare_key(uint16_t bits) noexcept {
+			return (bits & 0x7FFF) == 0 ? int16_t{0} : order_key(bits);
+		}
+
+		constexpr bool compare_bits(uint16_t a, uint16_t b, compare_op op) noexcept {
+			if (is_nan_bits(a) || is_nan_bits(b)) return op == compare_op::ne;
+			const int16_t ka = compare_key(a), kb = compare_key(b);
+			switch (op) {
+				case compare_op::eq: return ka == kb;
+				case compare_op::ne: return ka != kb;
+				case compare_op::lt: return ka < kb;
+				case compare_op::le: return ka <= kb;
+				case compare_op::gt: return ka > kb;
+				case compare_op::ge: return ka >= kb;
+			}
+			return false;
+		}
+
+#if defined(BF16_HAVE_AVX512)
+		inline __m512i load32(const bfloat16_t* p, __mmask32 m) noexcept {
+			return _mm512_maskz_loadu_epi16(m, p);
+		}
+
+		inline void store32(bfloat16_t* p, __mmask32 m, __m512i v) noexcept {
+			_mm512_mask_storeu_epi16(p, m, v);
+		}
+
+		// The key flips the magnitude bits of negative values: x ^ (sign >>> 1)
+		inline __m512i order_key32(__m512i x) noexcept {
+			return _mm512_xor_si512(x, _mm512_srli_epi16(_mm512_srai_epi16(x, 15), 1));
+		}
+
+		inline __mmask32 nan_mask32(__m512i x) noexcept {
+			return _mm512_cmpgt_epu16_mask(_mm512_and_si512(x, _mm512_set1_epi16(0x7FFF)), _mm512_set1_epi16(0x7F80));
+		}
+
+		inline __m512i compare_key32(__m512i x) noexcept {
+			return _mm512_maskz_mov_epi16(_mm512_test_epi16_mask(x, _mm512_set1_epi16(0x7FFF)), order_key32(x));
+		}
+
+		inline __mmask32 compare32(__m512i a, __m512i b, compare_op op) noexcept {
+			const __m512i ka = compare_key32(a), kb = compare_key32(b);
+			const __mmask32 nan = nan_mask32(a) | nan_mask32(b);
+			switch (op) {
+				case compare_op::eq: return _mm512_cmpeq_epi16_mask(ka, kb) & ~nan;
+				case compare_op::ne: return _mm512_cmpneq_epi16_mask(ka, kb) | nan;
+				case compare_op::lt: return _mm512_cmplt_epi16_mask(ka, kb) & ~nan;
+				case compare_op::le: return _mm512_cmple_epi16_mask(ka, kb) & ~nan;
+				case compare_op::gt: return _mm512_cmpgt_epi16_mask(ka, kb) & ~nan;
+				case compare_op::ge: return _mm512_cmpge_epi16_mask(ka, kb) & ~nan;
+			}
+			return 0;
+		}
+#endif
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// mask[i] = a[i] op b[i]
+	inline void compare(std::span<const bfloat16_t> a, std::span<const bfloat16_t> b, compare_op op, std::span<uint8_t> mask) noexcept {
+		assert(b.size() >= a.size() && mask.size() >= a.size());
+		const std::size_t n = a.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		const __m256i ones = _mm256_set1_epi8(1);
+		for (; i < n; i += 32) {
+			const __mmask32 t = detail::tail_mask32(n - i);
+			const __mmask32 m = detail::compare32(detail::load32(a.data() + i, t), detail::load32(b.data() + i, t), op);
+			_mm256_mask_storeu_epi8(mask.data() + i, t, _mm256_maskz_mov_epi8(m, ones));
+		}
+#endif
+		for (; i < n; ++i) {
+			mask[i] = detail::compare_bits(a[i].bits(), b[i].bits(), op) ? 1 : 0;
+		}
+	}
+
+	// out[i] = mask[i] ? a[i] : b[i]
+	inline void where(std::span<const uint8_t> mask, std::span<const bfloat16_t> a, std::span<const bfloat16_t> b, std::span<bfloat16_t> out) noexcept {
+		assert(a.size() >= mask.size() && b.size() >= mask.size() && out.size() >= mask.size());
+		const std::size_t n = mask.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		for (; i < n; i += 32) {
+			const __mmask32 t = detail::tail_mask32(n - i);
+			const __m256i mb = _mm256_maskz_loadu_epi8(t, mask.data() + i);
+			const __mmask32 m = _mm256_test_epi8_mask(mb, mb);
+			detail::store32(out.data() + i, t, _mm512_mask_blend_epi16(m, detail::load32(b.data() + i, t), detail::load32(a.data() + i, t)));
+		}
+#endif
+		for (; i < n; ++i) {
+			out[i] = mask[i] ? a[i] : b[i];
+		}
+	}
+
+	// out[i] = min(max(x[i], lo), hi); NaN elements pass through unchanged
+	inline void clamp(std::span<const bfloat16_t> x, bfloat16_t lo, bfloat16_t hi, std::span<bfloat16_t> out) noexcept {
+		assert(out.size() >= x.size());
+		const std::size_t n = x.size();
+		const int16_t klo = detail::order_key(lo.bits()), khi = detail::order_key(hi.bits());
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		const __m512i vlo = _mm512_set1_epi16(klo), vhi = _mm512_set1_epi16(khi);
+		for (; i < n; i += 32) {
+			const __mmask32 t = detail::tail_mask32(n - i);
+			const __m512i v = detail::load32(x.data() + i, t);
+			const __m512i k = _mm512_min_epi16(_mm512_max_epi16(detail::order_key32(v), vlo), vhi);
+			detail::store32(out.data() + i, t, _mm512_mask_blend_epi16(detail::nan_mask32(v), detail::order_key32(k), v));
+		}
+#endif
+		for (; i < n; ++i) {
+			const uint16_t bits = x[i].bits();
+			if (detail::is_nan_bits(bits)) {
+				out[i] = x[i];
+				continue;
+			}
+			const int16_t k = std::min(std::max(detail::order_key(bits), klo), khi);
+			out[i].bits() = detail::from_order_key(k);
+		}
+	}
+
+	// out[i] = x[i] > 0 ? x[i] : +0; NaN passes through
+	inline void relu(std::span<const bfloat16_t> x, std::span<bfloat16_t> out) noexcept {
+		assert(out.size() >= x.size());
+		const std::size_t n = x.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		for (; i < n; i += 32) {
+			const __mmask32 t = detail::tail_mask32(n - i);
+			const __m512i v = detail::load32(x.data() + i, t);
+			const __mmask32 keep = ~_mm512_movepi16_mask(v) | detail::nan_mask32(v);
+			detail::store32(out.data() + i, t, _mm512_maskz_mov_epi16(keep, v));
+		}
+#endif
+		for (; i < n; ++i) {
+			const uint16_t bits = x[i].bits();
+			out[i].bits() = ((bits & 0x8000) && !detail::is_nan_bits(bits)) ? uint16_t{0} : bits;
+		}
+	}
+
+	// out[i] = x[i] >= 0 ? x[i] : x[i] * slope
+	inline void leaky_relu(std::span<const bfloat16_t> x, float slope, std::span<bfloat16_t> out) noexcept {
+		assert(out.size() >= x.size());
+		const std::size_t n = x.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		// Only negative lanes are multiplied; everything else round-trips bit-exactly
+		const __m512 s = _mm512_set1_ps(slope);
+		for (; i < n; i += 16) {
+			const __mmask16 t = detail::tail_mask16(n - i);
+			const __m512 v = detail::maskz_load16(x.data() + i, t);
+			const __mmask16 neg = _mm512_cmp_ps_mask(v, _mm512_setzero_ps(), _CMP_LT_OQ);
+			detail::mask_store16(out.data() + i, t, _mm512_mask_mul_ps(v, neg, v, s));
+		}
+#endif
+		for (; i < n; ++i) {
+			const float v = detail::widen(x[i]);
+			out[i] = v < 0.0f ? detail::narrow(v * slope) : x[i];
+		}
+	}
+
+	// Replace NaN, +inf and -inf; by default with 0 and the largest finite values
+	inline void nan_to_num(std::span<const bfloat16_t> x, std::span<bfloat16_t> out,
+			bfloat16_t nan = bfloat16_t::zero(),
+			bfloat16_t posinf = std::numeric_limits<bfloat16_t>::max(),
+			bfloat16_t neginf = std::numeric_limits<bfloat16_t>::lowest()) noexcept {
+		assert(out.size() >= x.size());
+		const std::size_t n = x.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		const __m512i vnan = _mm512_set1_epi16(static_cast<int16_t>(nan.bits()));
+		const __m512i vpos = _mm512_set1_epi16(static_cast<int16_t>(posinf.bits()));
+		const __m512i vneg = _mm512_set1_epi16(static_cast<int16_t>(neginf.bits()));
+		const __m512i pinf = _mm512_set1_epi16(0x7F80);
+		const __m512i ninf = _mm512_set1_epi16(static_cast<int16_t>(0xFF80));
+		for (; i < n; i += 32) {
+			const __mmask32 t = detail::tail_mask32(n - i);
+			const __m512i v = detail::load32(x.data() + i, t);
+			__m512i r = _mm512_mask_mov_epi16(v, _mm512_cmpeq_epi16_mask(v, pinf), vpos);
+			r = _mm512_mask_mov_epi16(r, _mm512_cmpeq_epi16_mask(v, ninf), vneg);
+			detail::store32(out.data() + i, t, _mm512_mask_mov_epi16(r, detail::nan_mask32(v), vnan));
+		}
+#endif
+		for (; i < n; ++i) {
+			const uint16_t bits = x[i].bits();
+			if (detail::is_nan_bits(bits)) out[i] = nan;
+			else if (bits == 0x7F80) out[i] = posinf;
+			else if (bits == 0xFF80) out[i] = neginf;
+			else out[i] = x[i];
+		}
+	}
+
+	// out[i] = e^x[i], through the fp32 polynomial in detail/math.hpp
+	inline void exp(std::span<const bfloat16_t> x, std::span<bfloat16_t> out) noexcept {
+		assert(out.size() >= x.size());
+		const std::size_t n = x.size();
+		std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+		for (; i < n; i += 16) {
+			const __mmask16 t = detail::tail_mask16(n - i);
+			detail::mask_store16(out.data() + i, t, detail::exp16(detail::maskz_load16(x.data() + i, t)));
+		}
+#elif defined(BF16_HAVE_AVX2)
+		for (; i + 8 <= n; i += 8) {
+			detail::store8(out.data() + i, detail::exp8(detail::load8(x.data() + i)));
+		}
+#endif
+		for (; i < n; ++i) {
+			out[i] = detail::narrow(detail::exp_approx(detail::widen(x[i])));
+		}
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
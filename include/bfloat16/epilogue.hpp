@@ -0,0 +1,198 @@
+/**
+ * @file epilogue.hpp
+ * @brief Compile-time output epilogues fused into the GEMM/GEMV stores
+ *
+ * An epilogue is a functor called once per finished output row segment,
+ * after the full K reduction and before the single store to C:
+ *
+ *     ep(float* v, std::size_t len, std::size_t row, std::size_t col)
+ *
+ * where v[j] holds C(row, col + j) in fp32. The segment is a micro-kernel
+ * tile row (at most one or two vector registers) that was just written to
+ * L1, so bias, activation, scaling and residual adds cost no extra pass over
+ * C, and a bf16 C is narrowed exactly once at the end. GEMV passes its
+ * output vector as row 0, with col the index into y.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_EPILOGUE_HPP
+#define BFLOAT16_EPILOGUE_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/detail/isa.hpp>
+#include <bfloat16/detail/math.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace bf16 {
+
+	template<typename E>
+	concept gemm_epilogue = std::is_invocable_v<const E&, float*, std::size_t, std::size_t, std::size_t>;
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		// x / (1 + e), the sigmoid gate of SiLU and GELU with e = exp(-k x). At
+		// x = -inf that is -inf / inf; the limit is -0.
+		inline float gated(float x, float e) noexcept {
+			return x == -std::numeric_limits<float>::infinity() ? -0.0f : x / (1.0f + e);
+		}
+
+#if defined(BF16_HAVE_AVX512)
+		inline __m512 gated16(__m512 x, __m512 e) noexcept {
+			const __mmask16 ninf = _mm512_cmp_ps_mask(x, _mm512_set1_ps(-std::numeric_limits<float>::infinity()), _CMP_EQ_OQ);
+			return _mm512_mask_mov_ps(_mm512_div_ps(x, _mm512_add_ps(_mm512_set1_ps(1.0f), e)), ninf, _mm512_set1_ps(-0.0f));
+		}
+#elif defined(BF16_HAVE_AVX2)
+		inline __m256 gated8(__m256 x, __m256 e) noexcept {
+			const __m256 ninf = _mm256_cmp_ps(x, _mm256_set1_ps(-std::numeric_limits<float>::infinity()), _CMP_EQ_OQ);
+			return _mm256_blendv_ps(_mm256_div_ps(x, _mm256_add_ps(_mm256_set1_ps(1.0f), e)), _mm256_set1_ps(-0.0f), ninf);
+		}
+#endif
+
+		// v[j] = v[j] * sigmoid(k * v[j]); k = 1 is SiLU
+		inline void swish_row(float* v, std::size_t n, float k) noexcept {
+			std::size_t j = 0;
+#if defined(BF16_HAVE_AVX512)
+			const __m512 nk = _mm512_set1_ps(-k);
+			for (; j < n; j += 16) {
+				const __mmask16 m = tail_mask16(n - j);
+				const __m512 x = _mm512_maskz_loadu_ps(m, v + j);
+				_mm512_mask_storeu_ps(v + j, m, gated16(x, exp16(_mm512_mul_ps(nk, x))));
+			}
+#elif defined(BF16_HAVE_AVX2)
+			const __m256 nk = _mm256_set1_ps(-k);
+			for (; j + 8 <= n; j += 8) {
+				const __m256 x = _mm256_loadu_ps(v + j);
+				_mm256_storeu_ps(v + j, gated8(x, exp8(_mm256_mul_ps(nk, x))));
+			}
+#endif
+			for (; j < n; ++j) v[j] = gated(v[j], exp_approx(-k * v[j]));
+		}
+
+		// tanh-form GELU: x * sigmoid(2 * sqrt(2 / pi) * (x + 0.044715 x^3))
+		inline void gelu_row(float* v, std::size_t n) noexcept {
+			constexpr float c0 = 1.5957691216057308f, c1 = 0.044715f;
+			std::size_t j = 0;
+#if defined(BF16_HAVE_AVX512)
+			const __m512 nc0 = _mm512_set1_ps(-c0), vc1 = _mm512_set1_ps(c1);
+			for (; j < n; j += 16) {
+				const __mmask16 m = tail_mask16(n - j);
+				const __m512 x = _mm512_maskz_loadu_ps(m, v + j);
+				const __m512 u = _mm512_fmadd_ps(_mm512_mul_ps(vc1, x), _mm512_mul_ps(x, x), x);
+				_mm512_mask_storeu_ps(v + j, m, gated16(x, exp16(_mm512_mul_ps(nc0, u))));
+			}
+#elif defined(BF16_HAVE_AVX2)
+			const __m256 nc0 = _mm256_set1_ps(-c0), vc1 = _mm256_set1_ps(c1);
+			for (; j + 8 <= n; j += 8) {
+				const __m256 x = _mm256_loadu_ps(v + j);
+				const __m256 u = _mm256_fmadd_ps(_mm256_mul_ps(vc1, x), _mm256_mul_ps(x, x), x);
+				_mm256_storeu_ps(v + j, gated8(x, exp8(_mm256_mul_ps(nc0, u))));
+			}
+#endif
+			for (; j < n; ++j) {
+				const float x = v[j];
+				v[j] = gated(x, exp_approx(-c0 * (x + c1 * x * x * x)));
+			}
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	namespace epilogue {
+
+		// Plain store
+		struct none {
+			void operator()(float*, std::size_t, std::size_t, std::size_t) const noexcept {}
+		};
+
+		// v *= alpha
+		struct scale {
+			float alpha;
+
+			void operator()(float* v, std::size_t n, std::size_t, std::size_t) const noexcept {
+				for (std::size_t j = 0; j < n; ++j) v[j] *= alpha;
+			}
+		};
+
+		// v += b[col]: one bias per output column (per output feature of X * W)
+		struct bias {
+			const bfloat16_t* b;
+
+			void operator()(float* v, std::size_t n, std::size_t, std::size_t col) const noexcept {
+				for (std::size_t j = 0; j < n; ++j) v[j] += detail::widen(b[col + j]);
+			}
+		};
+
+		// v += b[row]: one bias per output row (per output channel of W * X)
+		struct row_bias {
+			const bfloat16_t* b;
+
+			void operator()(float* v, std::size_t n, std::size_t row, std::size_t) const noexcept {
+				const float x = detail::widen(b[row]);
+				for (std::size_t j = 0; j < n; ++j) v[j] += x;
+			}
+		};
+
+		// v += R(row, col); R may alias a bf16 C, since each element is read before it is stored
+		struct residual {
+			const bfloat16_t* r;
+			std::size_t ldr;
+
+			void operator()(float* v, std::size_t n, std::size_t row, std::size_t col) const noexcept {
+				const bfloat16_t* src = r + row * ldr + col;
+				for (std::size_t j = 0; j < n; ++j) v[j] += detail::widen(src[j]);
+			}
+		};
+
+		struct relu {
+			void operator()(float* v, std::size_t n, std::size_t, std::size_t) const noexcept {
+				// Negatives and -0 become +0 and NaN passes through, as in bf16::relu
+				for (std::size_t j = 0; j < n; ++j) v[j] = v[j] > 0.0f || std::isnan(v[j]) ? v[j] : 0.0f;
+			}
+		};
+
+		struct gelu {
+			void operator()(float* v, std::size_t n, std::size_t, std::size_t) const noexcept {
+				detail::gelu_row(v, n);
+			}
+		};
+
+		struct silu {
+			void operator()(float* v, std::size_t n, std::size_t, std::size_t) const noexcept {
+				detail::swish_row(v, n, 1.0f);
+			}
+		};
+
+		// Applies Ops left to right, e.g. chain<bias, gelu, residual>
+		template<gemm_epilogue... Ops>
+		struct chain {
+			std::tuple<Ops...> ops;
+
+			void operator()(float* v, std::size_t n, std::size_t row, std::size_t col) const
+					noexcept((std::is_nothrow_invocable_v<const Ops&, float*, std::size_t, std::size_t, std::size_t> && ...)) {
+				std::apply([&](const auto&... op) { (op(v, n, row, col), ...); }, ops);
+			}
+		};
+
+		template<gemm_epilogue... Ops>
+		constexpr chain<std::decay_t<Ops>...> fuse(Ops&&... ops) {
+			return {{std::forward<Ops>(ops)...}};
+		}
+
+	} // namespace epilogue
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
@@ -0,0 +1,300 @@
+/**
+ * @file gemm.hpp
+ * @brief Blocked matrix multiplication on bfloat16_t operands with fp32 accumulation
+ *
+ * All matrices are row-major with explicit leading dimensions (in elements).
+ * Operands stay bf16 in memory and are widened while being packed into
+ * cache-sized panels, so each input element is converted once per block.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_GEMM_HPP
+#define BFLOAT16_GEMM_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/epilogue.hpp>
+#include <bfloat16/reduce.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace bf16 {
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		// Register tile (mr x nr) and cache blocking (mc x kc, kc x nc)
+#if defined(BF16_HAVE_AVX512)
+		inline constexpr std::size_t gemm_mr = 6;
+		inline constexpr std::size_t gemm_nr = 32;
+#elif defined(BF16_HAVE_AVX2)
+		inline constexpr std::size_t gemm_mr = 6;
+		inline constexpr std::size_t gemm_nr = 16;
+#else
+		inline constexpr std::size_t gemm_mr = 4;
+		inline constexpr std::size_t gemm_nr = 16;
+#endif
+		inline constexpr std::size_t gemm_mc = 16 * gemm_mr;
+		inline constexpr std::size_t gemm_kc = 256;
+		inline constexpr std::size_t gemm_nc = 32 * gemm_nr;
+
+		// Pack an (mc x kc) block of A into mr-row panels laid out k-major: panel[p * mr + i].
+		// Rows past the edge of A are zero so the micro-kernel never needs a bounds check.
+		inline void pack_a(std::size_t mc, std::size_t kc, const bfloat16_t* a, std::size_t lda, float* dst) noexcept {
+			for (std::size_t i0 = 0; i0 < mc; i0 += gemm_mr) {
+				const std::size_t rows = std::min(gemm_mr, mc - i0);
+				for (std::size_t p = 0; p < kc; ++p) {
+					for (std::size_t i = 0; i < gemm_mr; ++i) {
+						dst[p * gemm_mr + i] = i < rows ? widen(a[(i0 + i) * lda + p]) : 0.0f;
+					}
+				}
+				dst += gemm_mr * kc;
+			}
+		}
+
+		// Pack a (kc x nc) block of B into nr-column panels: panel[p * nr + j]
+		inline void pack_b(std::size_t kc, std::size_t nc, const bfloat16_t* b, std::size_t ldb, float* dst) noexcept {
+			for (std::size_t j0 = 0; j0 < nc; j0 += gemm_nr) {
+				const std::size_t cols = std::min(gemm_nr, nc - j0);
+				for (std::size_t p = 0; p < kc; ++p) {
+					const bfloat16_t* row = b + p * ldb + j0;
+					float* out = dst + p * gemm_nr;
+					if (cols == gemm_nr) {
+						to_float({row, gemm_nr}, {out, gemm_nr});
+					} else {
+						to_float({row, cols}, {out, cols});
+						std::fill(out + cols, out + gemm_nr, 0.0f);
+					}
+				}
+				dst += gemm_nr * kc;
+			}
+		}
+
+		// tile[mr][nr] = sum_p a_panel[p][:] (outer) b_panel[p][:]
+		inline void gemm_micro_kernel(std::size_t kc, const float* a, const float* b, float* tile) noexcept {
+#if defined(BF16_HAVE_AVX512)
+			__m512 c[gemm_mr][2];
+			for (auto& row : c) {
+				row[0] = _mm512_setzero_ps();
+				row[1] = _mm512_setzero_ps();
+			}
+			for (std::size_t p = 0; p < kc; ++p) {
+				const __m512 b0 = _mm512_loadu_ps(b + p * gemm_nr);
+				const __m512 b1 = _mm512_loadu_ps(b + p * gemm_nr + 16);
+				for (std::size_t i = 0; i < gemm_mr; ++i) {
+					const __m512 ai = _mm512_set1_ps(a[p * gemm_mr + i]);
+					c[i][0] = _mm512_fmadd_ps(ai, b0, c[i][0]);
+					c[i][1] = _mm512_fmadd_ps(ai, b1, c[i][1]);
+				}
+			}
+			for (std::size_t i = 0; i < gemm_mr; ++i) {
+				_mm512_storeu_ps(tile + i * gemm_nr, c[i][0]);
+				_mm512_storeu_ps(tile + i * gemm_nr + 16, c[i][1]);
+			}
+#elif defined(BF16_HAVE_AVX2)
+			__m256 c[gemm_mr][2];
+			for (auto& row : c) {
+				row[0] = _mm256_setzero_ps();
+				row[1] = _mm256_setzero_ps();
+			}
+			for (std::size_t p = 0; p < kc; ++p) {
+				const __m256 b0 = _mm256_loadu_ps(b + p * gemm_nr);
+				const __m256 b1 = _mm256_loadu_ps(b + p * gemm_nr + 8);
+				for (std::size_t i = 0; i < gemm_mr; ++i) {
+					const __m256 ai = _mm256_set1_ps(a[p * gemm_mr + i]);
+					c[i][0] = _mm256_fmadd_ps(ai, b0, c[i][0]);
+					c[i][1] = _mm256_fmadd_ps(ai, b1, c[i][1]);
+				}
+			}
+			for (std::size_t i = 0; i < gemm_mr; ++i) {
+				_mm256_storeu_ps(tile + i * gemm_nr, c[i][0]);
+				_mm256_storeu_ps(tile + i * gemm_nr + 8, c[i][1]);
+			}
+#else
+			float c[gemm_mr][gemm_nr] = {};
+			for (std::size_t p = 0; p < kc; ++p) {
+				const float* bp = b + p * gemm_nr;
+				for (std::size_t i = 0; i < gemm_mr; ++i) {
+					const float ai = a[p * gemm_mr + i];
+					for (std::size_t j = 0; j < gemm_nr; ++j) {
+						c[i][j] += ai * bp[j];
+					}
+				}
+			}
+			for (std::size_t i = 0; i < gemm_mr; ++i) {
+				for (std::size_t j = 0; j < gemm_nr; ++j) {
+					tile[i * gemm_nr + j] = c[i][j];
+				}
+			}
+#endif
+		}
+
+		// Shared driver. Partial K sums live in C itself for a float C, or in an
+		// fp32 workspace for a bf16 C; the last K block adds them to the tile,
+		// runs the epilogue on each tile row and does the only store to C.
+		template<typename Out, typename Epilogue>
+		void gemm_blocked(std::size_t m, std::size_t n, std::size_t k,
+				const bfloat16_t* a, std::size_t lda,
+				const bfloat16_t* b, std::size_t ldb,
+				Out* c, std::size_t ldc, bool accumulate, const Epilogue& ep) {
+			constexpr bool float_out = std::is_same_v<Out, float>;
+			if (m == 0 || n == 0) return;
+
+			const auto store = [&](float* v, std::size_t len, std::size_t row, std::size_t col) {
+				ep(v, len, row, col);
+				if constexpr (float_out) {
+					std::copy(v, v + len, c + row * ldc + col);
+				} else {
+					from_float({v, len}, {c + row * ldc + col, len});
+				}
+			};
+
+			if (k == 0) {
+				std::vector<float> row(n);
+				for (std::size_t i = 0; i < m; ++i) {
+					std::fill(row.begin(), row.end(), 0.0f);
+					if constexpr (float_out) {
+						if (accumulate) std::copy(c + i * ldc, c + i * ldc + n, row.begin());
+					}
+					store(row.data(), n, i, 0);
+				}
+				return;
+			}
+
+			std::vector<float> a_pack(gemm_mc * gemm_kc);
+			std::vector<float> b_pack(gemm_kc * gemm_nc);
+			std::vector<float> workspace(float_out || k <= gemm_kc ? 0 : m * std::min(n, gemm_nc));
+			alignas(64) float tile[gemm_mr * gemm_nr];
+
+			for (std::size_t jc = 0; jc < n; jc += gemm_nc) {
+				const std::size_t nc = std::min(gemm_nc, n - jc);
+				float* acc = workspace.data();
+				std::size_t ldacc = nc;
+				if constexpr (float_out) {
+					acc = c + jc;
+					ldacc = ldc;
+				}
+
+				for (std::size_t pc = 0; pc < k; pc += gemm_kc) {
+					const std::size_t kc = std::min(gemm_kc, k - pc);
+					const bool first = pc == 0 && !accumulate;
+					const bool last = pc + kc == k;
+					pack_b(kc, nc, b + pc * ldb + jc, ldb, b_pack.data());
+
+					for (std::size_t ic = 0; ic < m; ic += gemm_mc) {
+						const std::size_t mc = std::min(gemm_mc, m - ic);
+						pack_a(mc, kc, a + ic * lda + pc, lda, a_pack.data());
+
+						for (std::size_t jr = 0; jr < nc; jr += gemm_nr) {
+							const std::size_t cols = std::min(gemm_nr, nc - jr);
+							const float* bp = b_pack.data() + (jr / gemm_nr) * gemm_nr * kc;
+							for (std::size_t ir = 0; ir < mc; ir += gemm_mr) {
+								const std::size_t rows = std::min(gemm_mr, mc - ir);
+								gemm_micro_kernel(kc, a_pack.data() + (ir / gemm_mr) * gemm_mr * kc, bp, tile);
+
+								for (std::size_t i = 0; i < rows; ++i) {
+									const std::size_t row = ic + ir + i;
+									float* trow = tile + i * gemm_nr;
+									// acc has no storage (may be null) for bf16 output with one k block
+									if (!last) {
+										float* arow = acc + row * ldacc + jr;
+										if (first) {
+											std::copy(trow, trow + cols, arow);
+										} else {
+											for (std::size_t j = 0; j < cols; ++j) arow[j] += trow[j];
+										}
+										continue;
+									}
+									if (!first) {
+										const float* arow = acc + row * ldacc + jr;
+										for (std::size_t j = 0; j < cols; ++j) trow[j] += arow[j];
+									}
+									store(trow, cols, row, jc + jr);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// C[m x n] = A[m x k] * B[k x n]; with accumulate, C += A * B
+	inline void gemm(std::size_t m, std::size_t n, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* b, std::size_t ldb,
+			float* c, std::size_t ldc, bool accumulate = false) {
+		detail::gemm_blocked(m, n, k, a, lda, b, ldb, c, ldc, accumulate, epilogue::none{});
+	}
+
+	// Same as above, narrowing the fp32 result into a bf16 C
+	inline void gemm(std::size_t m, std::size_t n, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* b, std::size_t ldb,
+			bfloat16_t* c, std::size_t ldc) {
+		detail::gemm_blocked(m, n, k, a, lda, b, ldb, c, ldc, false, epilogue::none{});
+	}
+
+	// C = ep(A * B), with the epilogue applied to each finished tile before it
+	// is stored (and narrowed, for a bf16 C), e.g.
+	//     gemm(m, n, k, x, k, w, n, y, n, epilogue::fuse(epilogue::bias{b}, epilogue::gelu{}));
+	template<typename Out, gemm_epilogue Epilogue>
+		requires std::is_same_v<Out, float> || std::is_same_v<Out, bfloat16_t>
+	void gemm(std::size_t m, std::size_t n, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* b, std::size_t ldb,
+			Out* c, std::size_t ldc, const Epilogue& ep) {
+		detail::gemm_blocked(m, n, k, a, lda, b, ldb, c, ldc, false, ep);
+	}
+
+	// y = ep(A[m x k] * x[k]); the epilogue sees y as row 0 with col = index into y
+	template<typename Out, gemm_epilogue Epilogue>
+		requires std::is_same_v<Out, float> || std::is_same_v<Out, bfloat16_t>
+	void gemv(std::size_t m, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* x, Out* y, const Epilogue& ep) {
+		constexpr std::size_t block = 64;
+		alignas(64) float buf[block];
+		for (std::size_t i0 = 0; i0 < m; i0 += block) {
+			const std::size_t len = std::min(block, m - i0);
+			for (std::size_t i = 0; i < len; ++i) {
+				buf[i] = detail::dot_kernel(a + (i0 + i) * lda, x, k);
+			}
+			ep(buf, len, 0, i0);
+			if constexpr (std::is_same_v<Out, float>) {
+				std::copy(buf, buf + len, y + i0);
+			} else {
+				from_float({buf, len}, {y + i0, len});
+			}
+		}
+	}
+
+	// y[m] = A[m x k] * x[k]
+	inline void gemv(std::size_t m, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* x, float* y) noexcept {
+		gemv(m, k, a, lda, x, y, epilogue::none{});
+	}
+
+	inline void gemv(std::size_t m, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* x, bfloat16_t* y) noexcept {
+		gemv(m, k, a, lda, x, y, epilogue::none{});
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * @file histogram.hpp
+ * @brief Exact histograms and quantiles over the 65536-value bfloat16_t key space
+ *
+ * A bf16 buffer holds at most 65536 distinct bit patterns, so one counting pass
+ * into a table indexed by the raw bits is an exact histogram, and walking that
+ * table in value order yields exact quantiles without sorting. Threads count
+ * into private tables that are merged at the end.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_HISTOGRAM_HPP
+#define BFLOAT16_HISTOGRAM_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/parallel.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace bf16 {
+
+	inline constexpr std::size_t histogram_bins = 65536;
+	inline constexpr std::size_t exponent_bins = 256;
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		// Elements per counting task. Keeps private uint32_t counters from
+		// overflowing and gives the merge enough work to amortise it.
+		inline constexpr std::size_t histogram_task = std::size_t{1} << 24;
+
+		// Two interleaved tables so runs of equal values do not serialise on
+		// one counter through store-to-load forwarding
+		template<std::size_t Bins, typename Index>
+		void count_into(const bfloat16_t* x, std::size_t n, uint32_t* a, uint32_t* b, Index index) noexcept {
+			std::size_t i = 0;
+			for (; i + 2 <= n; i += 2) {
+				++a[index(x[i].bits())];
+				++b[index(x[i + 1].bits())];
+			}
+			if (i < n) ++a[index(x[i].bits())];
+		}
+
+		template<std::size_t Bins, typename Index>
+		void parallel_histogram(std::span<const bfloat16_t> x, std::span<uint64_t, Bins> out, Index index) {
+			std::fill(out.begin(), out.end(), uint64_t{0});
+			const std::size_t tasks = std::max<std::size_t>(1, (x.size() + histogram_task - 1) / histogram_task);
+			std::mutex merge;
+			parallel_for(tasks, [&](std::size_t t) {
+				const std::size_t begin = t * histogram_task;
+				const std::size_t len = std::min(histogram_task, x.size() - std::min(begin, x.size()));
+				std::vector<uint32_t> local(2 * Bins, 0);
+				count_into<Bins>(x.data() + begin, len, local.data(), local.data() + Bins, index);
+
+				std::lock_guard<std::mutex> lock(merge);
+				for (std::size_t b = 0; b < Bins; ++b) out[b] += static_cast<uint64_t>(local[b]) + local[Bins + b];
+			});
+		}
+
+		inline std::size_t identity_bin(uint16_t bits) noexcept { return bits; }
+
+		inline std::size_t exponent_bin(uint16_t bits) noexcept { return (bits >> 7) & 0xFF; }
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// counts[b] = number of elements whose raw bits equal b
+	inline std::vector<uint64_t> histogram(std::span<const bfloat16_t> x) {
+		std::vector<uint64_t> counts(histogram_bins);
+		detail::parallel_histogram<histogram_bins>(x, std::span<uint64_t, histogram_bins>(counts.data(), histogram_bins), detail::identity_bin);
+		return counts;
+	}
+
+	// counts[e] = number of elements with biased exponent e, sign ignored
+	// (bin 0 holds zeros and subnormals, bin 255 infinities and NaNs)
+	inline std::array<uint64_t, exponent_bins> exponent_histogram(std::span<const bfloat16_t> x) {
+		std::array<uint64_t, exponent_bins> counts{};
+		detail::parallel_histogram<exponent_bins>(x, std::span<uint64_t, exponent_bins>(counts), detail::exponent_bin);
+		return counts;
+	}
+
+	// q-th quantile (0 <= q <= 1) of the values counted in a full histogram,
+	// linearly interpolated between neighbouring order statistics. NaNs are
+	// ignored; returns NaN when nothing else was counted.
+	inline float histogram_quantile(std::span<const uint64_t> counts, double q) noexcept {
+		assert(counts.size() == histogram_bins);
+		q = std::clamp(q, 0.0, 1.0);
+
+		uint64_t total = 0;
+		for (std::size_t b = 0; b < histogram_bins; ++b) {
+			if (!detail::is_nan_bits(static_cast<uint16_t>(b))) total += counts[b];
+		}
+		if (total == 0) return std::numeric_limits<float>::quiet_NaN();
+
+		const double rank = q * static_cast<double>(total - 1);
+		const uint64_t lo_rank = static_cast<uint64_t>(rank);
+		const uint64_t hi_rank = std::min(lo_rank + 1, total - 1);
+
+		// Walk bins in value order via the order key
+		float lo = 0.0f, hi = 0.0f;
+		bool have_lo = false;
+		uint64_t seen = 0;
+		for (int32_t key = std::numeric_limits<int16_t>::min(); key <= std::numeric_limits<int16_t>::max(); ++key) {
+			const uint16_t bits = detail::from_order_key(static_cast<int16_t>(key));
+			if (detail::is_nan_bits(bits) || counts[bits] == 0) continue;
+			seen += counts[bits];
+			if (!have_lo && seen > lo_rank) {
+				lo = detail::widen_bits(bits);
+				have_lo = true;
+			}
+			if (seen > hi_rank) {
+				hi = detail::widen_bits(bits);
+				break;
+			}
+		}
+		const double frac = rank - static_cast<double>(lo_rank);
+		// Interpolating towards or between infinities would give inf - inf or inf * 0
+		if (frac == 0.0 || lo == hi) return lo;
+		if (std::isinf(lo)) return lo;
+		if (std::isinf(hi)) return hi;
+		return static_cast<float>(lo + (static_cast<double>(hi) - lo) * frac);
+	}
+
+	inline float quantile(std::span<const bfloat16_t> x, double q) {
+		const auto counts = histogram(x);
+		return histogram_quantile(counts, q);
+	}
+
+	inline float median(std::span<const bfloat16_t> x) {
+		return quantile(x, 0.5);
+	}
+
+	// Smallest unbiased exponent e such that at least a fraction q of the
+	// magnitudes are below 2^(e + 1): a power-of-two calibration bound
+	inline int exponent_quantile(std::span<const uint64_t, exponent_bins> counts, double q) noexcept {
+		uint64_t total = 0;
+		for (std::size_t e = 0; e + 1 < exponent_bins; ++e) total += counts[e];
+		if (total == 0) return std::numeric_limits<int>::min();
+
+		const double target = std::clamp(q, 0.0, 1.0) * static_cast<double>(total);
+		uint64_t seen = 0;
+		for (std::size_t e = 0; e + 1 < exponent_bins; ++e) {
+			seen += counts[e];
+			if (static_cast<double>(seen) >= target && seen > 0) return static_cast<int>(e) - 127;
+		}
+		return static_cast<int>(exponent_bins - 2) - 127;
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
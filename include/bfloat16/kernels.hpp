@@ -0,0 +1,247 @@
+/**
+ * @file kernels.hpp
+ * @brief Runtime-dispatched kernels from the compiled bfloat16_kernels library
+ *
+ * The header-only kernels pick their code path from the flags of the including
+ * translation unit. These entry points instead live in bfloat16_kernels, which
+ * builds every kernel once per instruction-set tier and binds the best tier the
+ * host supports on first use, so a portable (-march=x86-64) binary still runs
+ * AVX-512 code where it is available. Link bfloat16::bfloat16_kernels (shared)
+ * or bfloat16::bfloat16_kernels_static.
+ *
+ * The environment variable BF16_KERNELS_ISA (generic, sse4.2, avx2, avx512,
+ * avx512bf16) caps the tier at startup; set_max_isa() changes it later.
+ *
+ * Binaries built for a known host (-march=native) can define
+ * BF16_KERNELS_NATIVE before including this header. The same API then resolves
+ * at compile time to the header kernels for the translation unit's own flags:
+ * every call inlines, nothing is dispatched and no library is needed.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_KERNELS_HPP
+#define BFLOAT16_KERNELS_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/cpu.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#if defined(BF16_KERNELS_NATIVE)
+#include <bfloat16/convert.hpp>
+#include <bfloat16/elementwise.hpp>
+#include <bfloat16/gemm.hpp>
+#include <bfloat16/reduce.hpp>
+#endif
+
+#if defined(__GNUC__)
+#define BF16_KERNELS_API __attribute__((visibility("default")))
+#else
+#define BF16_KERNELS_API
+#endif
+
+namespace bf16::kernels {
+
+	// Instruction-set tiers, each a superset of the previous one
+	enum class isa_level : uint8_t { generic, sse42, avx2, avx512, avx512bf16 };
+
+	enum class operation : uint8_t { to_float, from_float, dot, sum, norm, exp, gemm, gemv };
+
+	inline constexpr operation all_operations[] = {
+		operation::to_float, operation::from_float, operation::dot, operation::sum,
+		operation::norm, operation::exp, operation::gemm, operation::gemv,
+	};
+
+	constexpr const char* isa_name(isa_level isa) noexcept {
+		switch (isa) {
+			case isa_level::generic: return "generic";
+			case isa_level::sse42: return "sse4.2";
+			case isa_level::avx2: return "avx2";
+			case isa_level::avx512: return "avx512";
+			case isa_level::avx512bf16: return "avx512bf16";
+		}
+		return "unknown";
+	}
+
+	// Inverse of isa_name; also accepts "sse42"
+	constexpr std::optional<isa_level> parse_isa(std::string_view name) noexcept {
+		if (name == "sse42") return isa_level::sse42;
+		for (isa_level isa : {isa_level::generic, isa_level::sse42, isa_level::avx2, isa_level::avx512, isa_level::avx512bf16}) {
+			if (name == isa_name(isa)) return isa;
+		}
+		return std::nullopt;
+	}
+
+	constexpr const char* operation_name(operation op) noexcept {
+		switch (op) {
+			case operation::to_float: return "to_float";
+			case operation::from_float: return "from_float";
+			case operation::dot: return "dot";
+			case operation::sum: return "sum";
+			case operation::norm: return "norm";
+			case operation::exp: return "exp";
+			case operation::gemm: return "gemm";
+			case operation::gemv: return "gemv";
+		}
+		return "unknown";
+	}
+
+	namespace detail {
+
+		// Highest tier whose instructions the host supports. A tier needs every
+		// extension it is compiled with, not just the ones its kernels are named for.
+		constexpr isa_level isa_from_features(const cpu_feature_set& f) noexcept {
+			const bool avx2 = f.avx2 && f.fma && f.f16c && f.bmi1 && f.bmi2;
+			const bool avx512 = avx2 && f.avx512f && f.avx512bw && f.avx512vl && f.avx512dq;
+			if (avx512 && f.avx512bf16) return isa_level::avx512bf16;
+			if (avx512) return isa_level::avx512;
+			if (avx2) return isa_level::avx2;
+			if (f.sse42 && f.popcnt) return isa_level::sse42;
+			return isa_level::generic;
+		}
+
+		BF16_ISA_BEGIN
+
+		// Code path an operation compiles to with this translation unit's flags.
+		// Only the dot-product kernels have AVX-512 BF16 instructions, and no
+		// kernel has an SSE4.2-specific path.
+		constexpr isa_level compiled_isa([[maybe_unused]] operation op) noexcept {
+#if defined(BF16_HAVE_AVX512BF16)
+			return (op == operation::dot || op == operation::gemv) ? isa_level::avx512bf16 : isa_level::avx512;
+#elif defined(BF16_HAVE_AVX512)
+			return isa_level::avx512;
+#elif defined(BF16_HAVE_AVX2)
+			return isa_level::avx2;
+#else
+			return isa_level::generic;
+#endif
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+#if !defined(BF16_KERNELS_NATIVE)
+
+	// Best tier the host supports, from bf16::cpu_features()
+	BF16_KERNELS_API isa_level supported_isa() noexcept;
+
+	// Tier the kernels below are bound to
+	BF16_KERNELS_API isa_level active_isa() noexcept;
+
+	// Code path an operation actually runs in the active tier. This can be
+	// lower than active_isa(): the SSE4.2 tier runs the generic loops, and only
+	// dot and gemv have AVX-512 BF16 code.
+	BF16_KERNELS_API isa_level resolved_isa(operation op) noexcept;
+
+	// Rebind to min(level, supported_isa()) and return the new active tier.
+	// Safe to call concurrently with the kernels; calls already running finish
+	// on the old tier.
+	BF16_KERNELS_API isa_level set_max_isa(isa_level level) noexcept;
+
+	BF16_KERNELS_API void to_float(std::span<const bfloat16_t> src, std::span<float> dst) noexcept;
+
+	BF16_KERNELS_API void from_float(std::span<const float> src, std::span<bfloat16_t> dst) noexcept;
+
+	BF16_KERNELS_API float dot(std::span<const bfloat16_t> a, std::span<const bfloat16_t> b) noexcept;
+
+	BF16_KERNELS_API float sum(std::span<const bfloat16_t> x) noexcept;
+
+	BF16_KERNELS_API float norm(std::span<const bfloat16_t> x) noexcept;
+
+	BF16_KERNELS_API void exp(std::span<const bfloat16_t> x, std::span<bfloat16_t> out) noexcept;
+
+	// C[m x n] = A[m x k] * B[k x n] (or C += with accumulate), as bf16::gemm
+	BF16_KERNELS_API void gemm(std::size_t m, std::size_t n, std::size_t k,
+		const bfloat16_t* a, std::size_t lda,
+		const bfloat16_t* b, std::size_t ldb,
+		float* c, std::size_t ldc, bool accumulate = false);
+
+	BF16_KERNELS_API void gemm(std::size_t m, std::size_t n, std::size_t k,
+		const bfloat16_t* a, std::size_t lda,
+		const bfloat16_t* b, std::size_t ldb,
+		bfloat16_t* c, std::size_t ldc);
+
+	// y[m] = A[m x k] * x[k]
+	BF16_KERNELS_API void gemv(std::size_t m, std::size_t k,
+		const bfloat16_t* a, std::size_t lda,
+		const bfloat16_t* x, float* y) noexcept;
+
+#else
+
+	// Compile-time mode: the tier is fixed by this translation unit's flags
+	BF16_ISA_BEGIN
+
+	inline isa_level supported_isa() noexcept {
+		return detail::isa_from_features(cpu_features());
+	}
+
+	constexpr isa_level active_isa() noexcept {
+		return detail::compiled_isa(operation::dot);
+	}
+
+	constexpr isa_level resolved_isa(operation op) noexcept {
+		return detail::compiled_isa(op);
+	}
+
+	// The tier cannot be changed after compilation
+	constexpr isa_level set_max_isa(isa_level) noexcept {
+		return active_isa();
+	}
+
+	inline void to_float(std::span<const bfloat16_t> src, std::span<float> dst) noexcept {
+		bf16::to_float(src, dst);
+	}
+
+	inline void from_float(std::span<const float> src, std::span<bfloat16_t> dst) noexcept {
+		bf16::from_float(src, dst);
+	}
+
+	inline float dot(std::span<const bfloat16_t> a, std::span<const bfloat16_t> b) noexcept {
+		return bf16::dot(a, b);
+	}
+
+	inline float sum(std::span<const bfloat16_t> x) noexcept {
+		return bf16::sum(x);
+	}
+
+	inline float norm(std::span<const bfloat16_t> x) noexcept {
+		return bf16::norm(x);
+	}
+
+	inline void exp(std::span<const bfloat16_t> x, std::span<bfloat16_t> out) noexcept {
+		bf16::exp(x, out);
+	}
+
+	inline void gemm(std::size_t m, std::size_t n, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* b, std::size_t ldb,
+			float* c, std::size_t ldc, bool accumulate = false) {
+		bf16::gemm(m, n, k, a, lda, b, ldb, c, ldc, accumulate);
+	}
+
+	inline void gemm(std::size_t m, std::size_t n, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* b, std::size_t ldb,
+			bfloat16_t* c, std::size_t ldc) {
+		bf16::gemm(m, n, k, a, lda, b, ldb, c, ldc);
+	}
+
+	inline void gemv(std::size_t m, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* x, float* y) noexcept {
+		bf16::gemv(m, k, a, lda, x, y);
+	}
+
+	BF16_ISA_END
+
+#endif
+
+} // namespace bf16::kernels
+
+#endif
@@ -0,0 +1,448 @@
+/**
+ * @file krylov.hpp
+ * @brief Conjugate gradient and restarted GMRES on bf16 operators and Krylov vectors
+ *
+ * The operator is a csr_matrix or a dense row-major bf16 matrix. The search
+ * direction (CG) and the Krylov basis (GMRES) are stored as bfloat16_t as
+ * well, so iterations move about half the bytes of an fp32 solver. The
+ * solution, the residual and every dot product and norm stay in fp32.
+ *
+ * Each step is a few fused passes. The SpMV also accumulates the dot products
+ * that follow it: p.Ap for CG, and the classical Gram-Schmidt coefficients
+ * V^T w for GMRES. The vector updates run in 256-element chunks, so the
+ * norm of the result is taken while the chunk is still in L1. Rows are split
+ * into the same balanced ranges for every pass, and the per-range partial
+ * sums are added in range order.
+ *
+ * The recurrences work with the rounded bf16 vectors they store, so each
+ * restart (GMRES) or convergence check (CG) recomputes the true fp32
+ * residual b - A x. The solvers therefore reach fp32 tolerances, not just
+ * bf16 ones.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_KRYLOV_HPP
+#define BFLOAT16_KRYLOV_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/parallel.hpp>
+#include <bfloat16/reduce.hpp>
+#include <bfloat16/sparse.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace bf16 {
+
+	struct krylov_options {
+		float tolerance = 1e-6f;          // stop at ||b - A x|| <= tolerance * ||b||
+		std::size_t max_iterations = 1000;  // operator applications
+		std::size_t restart = 30;         // GMRES basis size before a restart
+	};
+
+	struct krylov_result {
+		std::size_t iterations = 0;
+		float residual = 0.0f;  // ||b - A x|| / ||b|| for the returned x
+		bool converged = false;
+	};
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		inline constexpr std::size_t krylov_chunk = 256;
+
+		// sum a[0:n] * b[0:n] in fp32
+		inline float float_dot(const float* a, const float* b, std::size_t n) noexcept {
+			std::size_t i = 0;
+			float sum = 0.0f;
+#if defined(BF16_HAVE_AVX512)
+			__m512 acc = _mm512_setzero_ps();
+			for (; i < n; i += 16) {
+				const __mmask16 m = tail_mask16(n - i);
+				acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(m, a + i), _mm512_maskz_loadu_ps(m, b + i), acc);
+			}
+			i = n;
+			sum = hsum16(acc);
+#elif defined(BF16_HAVE_AVX2)
+			__m256 acc = _mm256_setzero_ps();
+			for (; i + 8 <= n; i += 8) {
+				acc = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc);
+			}
+			sum = hsum8(acc);
+#endif
+			for (; i < n; ++i) sum += a[i] * b[i];
+			return sum;
+		}
+
+		// Operators give row i of A x, either for the bf16 vector last passed to
+		// prepare() or for an fp32 x, and the balanced row ranges of one pass
+		class csr_operator {
+			private:
+				const csr_matrix& a_;
+				std::vector<float> xf_;
+
+			public:
+				explicit csr_operator(const csr_matrix& a) : a_(a), xf_(a.cols) {
+					assert(a.rows == a.cols);
+				}
+
+				std::size_t size() const noexcept { return a_.rows; }
+
+				std::vector<std::size_t> ranges() const {
+					const std::size_t parts = std::max<std::size_t>(1, std::min(get_num_threads(), a_.nnz() / sparse_grain));
+					return partition_by_weight(std::span<const uint32_t>(a_.row_ptr), parts);
+				}
+
+				// The gathers read fp32, so the vector is widened once per product
+				void prepare(const bfloat16_t* x) {
+					to_float({x, a_.cols}, xf_);
+				}
+
+				float row(std::size_t i) const noexcept {
+					return row(i, xf_.data());
+				}
+
+				float row(std::size_t i, const float* x) const noexcept {
+					const uint32_t begin = a_.row_ptr[i];
+					return csr_row_dot(a_.col_idx.data() + begin, a_.values.data() + begin, a_.row_ptr[i + 1] - begin, x);
+				}
+		};
+
+		class dense_operator {
+			private:
+				std::size_t n_;
+				const bfloat16_t* a_;
+				std::size_t lda_;
+				const bfloat16_t* x_ = nullptr;
+
+			public:
+				dense_operator(std::size_t n, const bfloat16_t* a, std::size_t lda) noexcept : n_(n), a_(a), lda_(lda) {}
+
+				std::size_t size() const noexcept { return n_; }
+
+				std::vector<std::size_t> ranges() const {
+					const std::size_t parts = std::clamp<std::size_t>(std::min(get_num_threads(), n_ * n_ / sparse_grain), 1, std::max<std::size_t>(n_, 1));
+					std::vector<std::size_t> bounds(parts + 1);
+					for (std::size_t p = 0; p <= parts; ++p) bounds[p] = n_ * p / parts;
+					return bounds;
+				}
+
+				// Rows are bf16 x bf16 dot products (vdpbf16ps where available)
+				void prepare(const bfloat16_t* x) noexcept {
+					x_ = x;
+				}
+
+				float row(std::size_t i) const noexcept {
+					return dot_kernel(a_ + i * lda_, x_, n_);
+				}
+
+				float row(std::size_t i, const float* x) const noexcept {
+					return row_dot(a_ + i * lda_, x, n_);
+				}
+		};
+
+		// Row ranges of an operator with one fp32 partial-sum slot per range
+		class krylov_passes {
+			private:
+				std::vector<std::size_t> bounds_;
+				std::size_t slots_;
+				std::vector<float> partial_;
+
+			public:
+				krylov_passes(std::vector<std::size_t> bounds, std::size_t slots)
+					: bounds_(std::move(bounds)), slots_(slots), partial_((bounds_.size() - 1) * slots) {}
+
+				// fn(first, last, partial) over every range; partial[0:slots] starts at zero
+				template<typename Fn>
+				void run(Fn&& fn) {
+					std::fill(partial_.begin(), partial_.end(), 0.0f);
+					parallel_for(bounds_.size() - 1, [&](std::size_t t) {
+						fn(bounds_[t], bounds_[t + 1], partial_.data() + t * slots_);
+					});
+				}
+
+				// Sum of slot s over the ranges, in range order
+				float total(std::size_t s) const noexcept {
+					float sum = 0.0f;
+					for (std::size_t t = 0; t + 1 < bounds_.size(); ++t) sum += partial_[t * slots_ + s];
+					return sum;
+				}
+		};
+
+		// Calls fn(i, len) over [first, last) in krylov_chunk pieces
+		template<typename Fn>
+		void for_each_chunk(std::size_t first, std::size_t last, Fn&& fn) {
+			for (std::size_t i = first; i < last; i += krylov_chunk) fn(i, std::min(krylov_chunk, last - i));
+		}
+
+		// r = b - A x with fp32 x; returns ||r||^2
+		template<typename Op>
+		float true_residual(const Op& op, krylov_passes& passes, const float* b, const float* x, float* r) {
+			passes.run([&](std::size_t first, std::size_t last, float* partial) {
+				for_each_chunk(first, last, [&](std::size_t i, std::size_t len) {
+					for (std::size_t j = i; j < i + len; ++j) r[j] = b[j] - op.row(j, x);
+					partial[0] += float_dot(r + i, r + i, len);
+				});
+			});
+			return passes.total(0);
+		}
+
+		// dst = bf16(alpha * src + beta * widen(dst)); beta = 0 does not read dst
+		inline void scale_into(float alpha, const float* src, float beta, bfloat16_t* dst, std::size_t len) noexcept {
+			float tmp[krylov_chunk];
+			if (beta == 0.0f) {
+				for (std::size_t j = 0; j < len; ++j) tmp[j] = alpha * src[j];
+			} else {
+				to_float({dst, len}, {tmp, len});
+				for (std::size_t j = 0; j < len; ++j) tmp[j] = alpha * src[j] + beta * tmp[j];
+			}
+			from_float({tmp, len}, {dst, len});
+		}
+
+		template<typename Op>
+		krylov_result cg_solve(Op& op, std::span<const float> b, std::span<float> x, const krylov_options& opt) {
+			const std::size_t n = op.size();
+			assert(b.size() >= n && x.size() >= n);
+			krylov_result result;
+			const float b_norm = std::sqrt(float_dot(b.data(), b.data(), n));
+			if (b_norm == 0.0f) {
+				std::fill(x.begin(), x.begin() + n, 0.0f);
+				result.converged = true;
+				return result;
+			}
+
+			krylov_passes passes(op.ranges(), 1);
+			std::vector<float> r(n), q(n);
+			std::vector<bfloat16_t> p(n);
+
+			// (Re)start the recurrence from the true residual, with p = r
+			const auto restart = [&] {
+				const float rr = true_residual(op, passes, b.data(), x.data(), r.data());
+				from_float(r, p);
+				return rr;
+			};
+
+			float rr = restart();
+			bool replaced = true;
+			for (;;) {
+				result.residual = std::sqrt(rr) / b_norm;
+				if (result.residual <= opt.tolerance) {
+					// The recursive r drifts from b - A x; confirm before stopping
+					if (replaced) {
+						result.converged = true;
+						break;
+					}
+					rr = restart();
+					replaced = true;
+					continue;
+				}
+				if (result.iterations == opt.max_iterations) break;
+
+				// q = A p fused with p.q
+				op.prepare(p.data());
+				passes.run([&](std::size_t first, std::size_t last, float* partial) {
+					for_each_chunk(first, last, [&](std::size_t i, std::size_t len) {
+						float pf[krylov_chunk];
+						for (std::size_t j = 0; j < len; ++j) q[i + j] = op.row(i + j);
+						to_float({p.data() + i, len}, {pf, len});
+						partial[0] += float_dot(pf, q.data() + i, len);
+					});
+				});
+				const float pq = passes.total(0);
+				// Not positive definite, or nothing left to gain
+				if (!(pq > 0.0f)) break;
+				const float alpha = rr / pq;
+
+				// x += alpha p, r -= alpha q fused with r.r
+				passes.run([&](std::size_t first, std::size_t last, float* partial) {
+					for_each_chunk(first, last, [&](std::size_t i, std::size_t len) {
+						axpy_row(alpha, p.data() + i, len, x.data() + i);
+						for (std::size_t j = i; j < i + len; ++j) r[j] -= alpha * q[j];
+						partial[0] += float_dot(r.data() + i, r.data() + i, len);
+					});
+				});
+				const float rr_next = passes.total(0);
+				const float beta = rr_next / rr;
+				rr = rr_next;
+
+				// p = r + beta p
+				passes.run([&](std::size_t first, std::size_t last, float*) {
+					for_each_chunk(first, last, [&](std::size_t i, std::size_t len) {
+						scale_into(1.0f, r.data() + i, beta, p.data() + i, len);
+					});
+				});
+				++result.iterations;
+				replaced = false;
+			}
+
+			if (!result.converged) result.residual = std::sqrt(true_residual(op, passes, b.data(), x.data(), r.data())) / b_norm;
+			return result;
+		}
+
+		template<typename Op>
+		krylov_result gmres_solve(Op& op, std::span<const float> b, std::span<float> x, const krylov_options& opt) {
+			const std::size_t n = op.size();
+			assert(b.size() >= n && x.size() >= n);
+			krylov_result result;
+			const float b_norm = std::sqrt(float_dot(b.data(), b.data(), n));
+			if (b_norm == 0.0f) {
+				std::fill(x.begin(), x.begin() + n, 0.0f);
+				result.converged = true;
+				return result;
+			}
+
+			const std::size_t m = std::max<std::size_t>(1, opt.restart);
+			// Slots 0..m hold projections, m + 1 a squared norm
+			krylov_passes passes(op.ranges(), m + 2);
+			std::vector<bfloat16_t> basis((m + 1) * n);
+			std::vector<float> w(n), r(n), h(m + 1), h2(m + 1), hess((m + 1) * m), cs(m), sn(m), g(m + 1), y(m);
+			const auto v = [&](std::size_t k) { return basis.data() + k * n; };
+
+			// coeff[0:j+1] = V^T w, optionally computing w = A v_j first; returns ||w||^2
+			const auto project = [&](std::size_t j, bool apply, float* coeff) {
+				passes.run([&](std::size_t first, std::size_t last, float* partial) {
+					for_each_chunk(first, last, [&](std::size_t i, std::size_t len) {
+						if (apply) {
+							for (std::size_t l = i; l < i + len; ++l) w[l] = op.row(l);
+						}
+						for (std::size_t k = 0; k <= j; ++k) partial[k] += row_dot(v(k) + i, w.data() + i, len);
+						partial[m + 1] += float_dot(w.data() + i, w.data() + i, len);
+					});
+				});
+				for (std::size_t k = 0; k <= j; ++k) coeff[k] = passes.total(k);
+				return passes.total(m + 1);
+			};
+
+			// w -= V coeff; returns ||w||^2
+			const auto orthogonalize = [&](std::size_t j, const float* coeff) {
+				passes.run([&](std::size_t first, std::size_t last, float* partial) {
+					for_each_chunk(first, last, [&](std::size_t i, std::size_t len) {
+						for (std::size_t k = 0; k <= j; ++k) axpy_row(-coeff[k], v(k) + i, len, w.data() + i);
+						partial[0] += float_dot(w.data() + i, w.data() + i, len);
+					});
+				});
+				return passes.total(0);
+			};
+
+			// v_k = bf16(src / norm)
+			const auto store = [&](std::size_t k, const float* src, float norm) {
+				passes.run([&](std::size_t first, std::size_t last, float*) {
+					for_each_chunk(first, last, [&](std::size_t i, std::size_t len) {
+						scale_into(1.0f / norm, src + i, 0.0f, v(k) + i, len);
+					});
+				});
+			};
+
+			float previous = std::numeric_limits<float>::infinity();
+			for (;;) {
+				const float beta = std::sqrt(true_residual(op, passes, b.data(), x.data(), r.data()));
+				result.residual = beta / b_norm;
+				if (result.residual <= opt.tolerance) {
+					result.converged = true;
+					break;
+				}
+				// A cycle that did not reduce the true residual has hit the bf16 basis limit
+				if (result.iterations == opt.max_iterations || !(beta < previous)) break;
+				previous = beta;
+
+				store(0, r.data(), beta);
+				std::fill(g.begin(), g.end(), 0.0f);
+				g[0] = beta;
+				std::size_t steps = 0;
+				while (steps < m && result.iterations < opt.max_iterations) {
+					const std::size_t j = steps;
+					op.prepare(v(j));
+					const float applied = project(j, true, h.data());
+					float s = orthogonalize(j, h.data());
+					// Classical Gram-Schmidt twice when cancellation was heavy
+					if (s < 0.5f * applied) {
+						project(j, false, h2.data());
+						s = orthogonalize(j, h2.data());
+						for (std::size_t k = 0; k <= j; ++k) h[k] += h2[k];
+					}
+					const float h_next = std::sqrt(s);
+
+					// Column j of the Hessenberg matrix, reduced by the Givens rotations so far
+					float* col = hess.data() + j * (m + 1);
+					std::copy(h.begin(), h.begin() + j + 1, col);
+					col[j + 1] = h_next;
+					for (std::size_t k = 0; k < j; ++k) {
+						const float t = cs[k] * col[k] + sn[k] * col[k + 1];
+						col[k + 1] = -sn[k] * col[k] + cs[k] * col[k + 1];
+						col[k] = t;
+					}
+					const float d = std::hypot(col[j], col[j + 1]);
+					cs[j] = d > 0.0f ? col[j] / d : 1.0f;
+					sn[j] = d > 0.0f ? col[j + 1] / d : 0.0f;
+					col[j] = d;
+					col[j + 1] = 0.0f;
+					g[j + 1] = -sn[j] * g[j];
+					g[j] = cs[j] * g[j];
+
+					++steps;
+					++result.iterations;
+					if (!(std::abs(g[j + 1]) > opt.tolerance * b_norm) || !(h_next > 0.0f)) break;
+					if (steps < m) store(j + 1, w.data(), h_next);
+				}
+
+				// y = R^-1 g, then x += V y
+				for (std::size_t i = steps; i-- > 0;) {
+					float t = g[i];
+					for (std::size_t l = i + 1; l < steps; ++l) t -= hess[l * (m + 1) + i] * y[l];
+					const float diag = hess[i * (m + 1) + i];
+					y[i] = diag != 0.0f ? t / diag : 0.0f;
+				}
+				passes.run([&](std::size_t first, std::size_t last, float*) {
+					for_each_chunk(first, last, [&](std::size_t i, std::size_t len) {
+						for (std::size_t k = 0; k < steps; ++k) axpy_row(y[k], v(k) + i, len, x.data() + i);
+					});
+				});
+			}
+			return result;
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// Conjugate gradient for symmetric positive definite A; x holds the initial guess
+	inline krylov_result cg(const csr_matrix& a, std::span<const float> b, std::span<float> x, const krylov_options& opt = {}) {
+		detail::csr_operator op(a);
+		return detail::cg_solve(op, b, x, opt);
+	}
+
+	inline krylov_result cg(std::size_t n, const bfloat16_t* a, std::size_t lda,
+			std::span<const float> b, std::span<float> x, const krylov_options& opt = {}) {
+		detail::dense_operator op(n, a, lda);
+		return detail::cg_solve(op, b, x, opt);
+	}
+
+	// Restarted GMRES(opt.restart) for general nonsingular A; x holds the initial guess
+	inline krylov_result gmres(const csr_matrix& a, std::span<const float> b, std::span<float> x, const krylov_options& opt = {}) {
+		detail::csr_operator op(a);
+		return detail::gmres_solve(op, b, x, opt);
+	}
+
+	inline krylov_result gmres(std::size_t n, const bfloat16_t* a, std::size_t lda,
+			std::span<const float> b, std::span<float> x, const krylov_options& opt = {}) {
+		detail::dense_operator op(n, a, lda);
+		return detail::gmres_solve(op, b, x, opt);
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
@@ -0,0 +1,284 @@
+/**
+ * @file layout.hpp
+ * @brief Layout transformations for bfloat16_t matrices
+ *
+ * Transpose, pair-interleaved ("VNNI") packing as consumed by vdpbf16ps / AMX
+ * tiles, and cache-blocked tile packing. bf16 values are moved as raw 16-bit
+ * words, so none of these kernels round or widen.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_LAYOUT_HPP
+#define BFLOAT16_LAYOUT_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace bf16 {
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+#if defined(__SSE2__)
+		// In-register 8x8 transpose of 16-bit words: three rounds of unpacks
+		inline void transpose8x8(const bfloat16_t* src, std::size_t lds, bfloat16_t* dst, std::size_t ldd) noexcept {
+			__m128i r[8];
+			for (std::size_t i = 0; i < 8; ++i) {
+				r[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * lds));
+			}
+			__m128i t[8], u[8];
+			for (std::size_t i = 0; i < 4; ++i) {
+				t[2 * i] = _mm_unpacklo_epi16(r[2 * i], r[2 * i + 1]);
+				t[2 * i + 1] = _mm_unpackhi_epi16(r[2 * i], r[2 * i + 1]);
+			}
+			for (std::size_t i = 0; i < 2; ++i) {
+				u[4 * i + 0] = _mm_unpacklo_epi32(t[4 * i + 0], t[4 * i + 2]);
+				u[4 * i + 1] = _mm_unpackhi_epi32(t[4 * i + 0], t[4 * i + 2]);
+				u[4 * i + 2] = _mm_unpacklo_epi32(t[4 * i + 1], t[4 * i + 3]);
+				u[4 * i + 3] = _mm_unpackhi_epi32(t[4 * i + 1], t[4 * i + 3]);
+			}
+			for (std::size_t i = 0; i < 4; ++i) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (2 * i) * ldd), _mm_unpacklo_epi64(u[i], u[i + 4]));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (2 * i + 1) * ldd), _mm_unpackhi_epi64(u[i], u[i + 4]));
+			}
+		}
+#endif
+
+#if defined(BF16_HAVE_AVX2)
+		// The unpacks of the 8x8 kernel work per 128-bit lane, so running them on
+		// rows 0-7 and 8-15 yields four 8x8 transposes; one lane shuffle stitches them.
+		inline void transpose8_lanes(__m256i* r) noexcept {
+			__m256i t[8], u[8];
+			for (std::size_t i = 0; i < 4; ++i) {
+				t[2 * i] = _mm256_unpacklo_epi16(r[2 * i], r[2 * i + 1]);
+				t[2 * i + 1] = _mm256_unpackhi_epi16(r[2 * i], r[2 * i + 1]);
+			}
+			for (std::size_t i = 0; i < 2; ++i) {
+				u[4 * i + 0] = _mm256_unpacklo_epi32(t[4 * i + 0], t[4 * i + 2]);
+				u[4 * i + 1] = _mm256_unpackhi_epi32(t[4 * i + 0], t[4 * i + 2]);
+				u[4 * i + 2] = _mm256_unpacklo_epi32(t[4 * i + 1], t[4 * i + 3]);
+				u[4 * i + 3] = _mm256_unpackhi_epi32(t[4 * i + 1], t[4 * i + 3]);
+			}
+			for (std::size_t i = 0; i < 4; ++i) {
+				r[2 * i] = _mm256_unpacklo_epi64(u[i], u[i + 4]);
+				r[2 * i + 1] = _mm256_unpackhi_epi64(u[i], u[i + 4]);
+			}
+		}
+
+		inline void transpose16x16(const bfloat16_t* src, std::size_t lds, bfloat16_t* dst, std::size_t ldd) noexcept {
+			__m256i lo[8], hi[8];
+			for (std::size_t i = 0; i < 8; ++i) {
+				lo[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * lds));
+				hi[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + (i + 8) * lds));
+			}
+			transpose8_lanes(lo);
+			transpose8_lanes(hi);
+			for (std::size_t i = 0; i < 8; ++i) {
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * ldd), _mm256_permute2x128_si256(lo[i], hi[i], 0x20));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + (i + 8) * ldd), _mm256_permute2x128_si256(lo[i], hi[i], 0x31));
+			}
+		}
+#endif
+
+		inline constexpr std::size_t transpose_block =
+#if defined(BF16_HAVE_AVX2)
+			16;
+#elif defined(__SSE2__)
+			8;
+#else
+			16;
+#endif
+
+		// Transpose one block of at most transpose_block x transpose_block elements
+		inline void transpose_block_kernel(std::size_t rows, std::size_t cols,
+				const bfloat16_t* src, std::size_t lds, bfloat16_t* dst, std::size_t ldd) noexcept {
+#if defined(BF16_HAVE_AVX2)
+			if (rows == 16 && cols == 16) {
+				transpose16x16(src, lds, dst, ldd);
+				return;
+			}
+#elif defined(__SSE2__)
+			if (rows == 8 && cols == 8) {
+				transpose8x8(src, lds, dst, ldd);
+				return;
+			}
+#endif
+			for (std::size_t i = 0; i < rows; ++i) {
+				for (std::size_t j = 0; j < cols; ++j) {
+					dst[j * ldd + i] = src[i * lds + j];
+				}
+			}
+		}
+
+		// Interleave two rows: dst[2j] = p[j], dst[2j + 1] = q[j]
+		inline void interleave_rows(const bfloat16_t* p, const bfloat16_t* q, std::size_t n, bfloat16_t* dst) noexcept {
+			std::size_t j = 0;
+#if defined(BF16_HAVE_AVX2)
+			for (; j + 16 <= n; j += 16) {
+				__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + j));
+				__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q + j));
+				__m256i lo = _mm256_unpacklo_epi16(a, b);
+				__m256i hi = _mm256_unpackhi_epi16(a, b);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * j), _mm256_permute2x128_si256(lo, hi, 0x20));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 2 * j + 16), _mm256_permute2x128_si256(lo, hi, 0x31));
+			}
+#elif defined(__SSE2__)
+			for (; j + 8 <= n; j += 8) {
+				__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + j));
+				__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q + j));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * j), _mm_unpacklo_epi16(a, b));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * j + 8), _mm_unpackhi_epi16(a, b));
+			}
+#endif
+			for (; j < n; ++j) {
+				dst[2 * j] = p[j];
+				dst[2 * j + 1] = q[j];
+			}
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// dst[cols x rows] = transpose(src[rows x cols])
+	inline void transpose(std::size_t rows, std::size_t cols,
+			const bfloat16_t* src, std::size_t lds,
+			bfloat16_t* dst, std::size_t ldd) noexcept {
+		constexpr std::size_t bs = detail::transpose_block;
+		for (std::size_t i = 0; i < rows; i += bs) {
+			const std::size_t bi = std::min(bs, rows - i);
+			for (std::size_t j = 0; j < cols; j += bs) {
+				const std::size_t bj = std::min(bs, cols - j);
+				detail::transpose_block_kernel(bi, bj, src + i * lds + j, lds, dst + j * ldd + i, ldd);
+			}
+		}
+	}
+
+	// In-place transpose of an n x n matrix: diagonal blocks go through a scratch
+	// block, off-diagonal pairs are transposed into each other's place.
+	inline void transpose_inplace(std::size_t n, bfloat16_t* data, std::size_t ld) noexcept {
+		constexpr std::size_t bs = detail::transpose_block;
+		bfloat16_t upper[bs * bs];
+		bfloat16_t lower[bs * bs];
+		for (std::size_t i = 0; i < n; i += bs) {
+			const std::size_t bi = std::min(bs, n - i);
+			for (std::size_t j = i; j < n; j += bs) {
+				const std::size_t bj = std::min(bs, n - j);
+				bfloat16_t* a = data + i * ld + j;
+				bfloat16_t* b = data + j * ld + i;
+				detail::transpose_block_kernel(bi, bj, a, ld, upper, bs);
+				if (i != j) {
+					detail::transpose_block_kernel(bj, bi, b, ld, lower, bs);
+					for (std::size_t r = 0; r < bi; ++r) std::copy(lower + r * bs, lower + r * bs + bj, a + r * ld);
+				}
+				for (std::size_t r = 0; r < bj; ++r) std::copy(upper + r * bs, upper + r * bs + bi, b + r * ld);
+			}
+		}
+	}
+
+	// Number of elements of the pair-interleaved form of a k x n matrix
+	constexpr std::size_t vnni_size(std::size_t k, std::size_t n) noexcept {
+		return ((k + 1) / 2) * n * 2;
+	}
+
+	// Repack B[k x n] into the [ceil(k/2)][n][2] layout read by vdpbf16ps, where
+	// dst[(p / 2) * 2n + 2j + (p % 2)] = B[p][j]. An odd final row pairs with zeros.
+	inline void pack_vnni(std::size_t k, std::size_t n,
+			const bfloat16_t* src, std::size_t lds, bfloat16_t* dst) {
+		std::vector<bfloat16_t> zeros(k % 2 ? n : 0);
+		for (std::size_t p = 0; p < k; p += 2) {
+			const bfloat16_t* q = p + 1 < k ? src + (p + 1) * lds : zeros.data();
+			detail::interleave_rows(src + p * lds, q, n, dst + p * n);
+		}
+	}
+
+	inline void unpack_vnni(std::size_t k, std::size_t n,
+			const bfloat16_t* src, bfloat16_t* dst, std::size_t ldd) noexcept {
+		for (std::size_t p = 0; p < k; ++p) {
+			const bfloat16_t* pair = src + (p / 2) * 2 * n + (p % 2);
+			bfloat16_t* row = dst + p * ldd;
+			for (std::size_t j = 0; j < n; ++j) row[j] = pair[2 * j];
+		}
+	}
+
+	// In-place VNNI packing of a dense k x n matrix. k must be even: an odd k needs
+	// the zero row pack_vnni adds, which does not fit in k x n elements. Each pair
+	// of rows only moves within its own 2n-element span: the second row is copied
+	// aside and the pair is interleaved back to front so no unread element is
+	// overwritten.
+	inline void pack_vnni_inplace(std::size_t k, std::size_t n, bfloat16_t* data) {
+		assert(k % 2 == 0);
+		std::vector<bfloat16_t> second(n);
+		for (std::size_t p = 0; p + 1 < k; p += 2) {
+			bfloat16_t* pair = data + p * n;
+			std::copy(pair + n, pair + 2 * n, second.begin());
+			constexpr std::size_t chunk = 16;
+			std::size_t j = n;
+			while (j > 0) {
+				const std::size_t len = std::min(chunk, j);
+				j -= len;
+				bfloat16_t first[chunk];
+				std::copy(pair + j, pair + j + len, first);
+				detail::interleave_rows(first, second.data() + j, len, pair + 2 * j);
+			}
+		}
+	}
+
+	// Number of elements of the tiled form of a rows x cols matrix
+	constexpr std::size_t tiled_size(std::size_t rows, std::size_t cols, std::size_t tile_rows, std::size_t tile_cols) noexcept {
+		return ((rows + tile_rows - 1) / tile_rows) * ((cols + tile_cols - 1) / tile_cols) * tile_rows * tile_cols;
+	}
+
+	// Repack src into contiguous tile_rows x tile_cols tiles, tiles ordered
+	// row-major and each tile row-major; edge tiles are zero padded.
+	inline void pack_tiles(std::size_t rows, std::size_t cols,
+			const bfloat16_t* src, std::size_t lds,
+			std::size_t tile_rows, std::size_t tile_cols, bfloat16_t* dst) noexcept {
+		for (std::size_t i = 0; i < rows; i += tile_rows) {
+			const std::size_t ti = std::min(tile_rows, rows - i);
+			for (std::size_t j = 0; j < cols; j += tile_cols) {
+				const std::size_t tj = std::min(tile_cols, cols - j);
+				for (std::size_t r = 0; r < tile_rows; ++r, dst += tile_cols) {
+					if (r < ti) {
+						std::copy(src + (i + r) * lds + j, src + (i + r) * lds + j + tj, dst);
+						std::fill(dst + tj, dst + tile_cols, bfloat16_t::zero());
+					} else {
+						std::fill(dst, dst + tile_cols, bfloat16_t::zero());
+					}
+				}
+			}
+		}
+	}
+
+	inline void unpack_tiles(std::size_t rows, std::size_t cols,
+			const bfloat16_t* src, std::size_t tile_rows, std::size_t tile_cols,
+			bfloat16_t* dst, std::size_t ldd) noexcept {
+		for (std::size_t i = 0; i < rows; i += tile_rows) {
+			const std::size_t ti = std::min(tile_rows, rows - i);
+			for (std::size_t j = 0; j < cols; j += tile_cols) {
+				const std::size_t tj = std::min(tile_cols, cols - j);
+				for (std::size_t r = 0; r < ti; ++r) {
+					std::copy(src + r * tile_cols, src + r * tile_cols + tj, dst + (i + r) * ldd + j);
+				}
+				src += tile_rows * tile_cols;
+			}
+		}
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
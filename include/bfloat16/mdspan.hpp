@@ -0,0 +1,239 @@
+/**
+ * @file mdspan.hpp
+ * @brief mdspan accessor policies over bfloat16_t storage, and mdspan overloads of the bulk kernels
+ *
+ * widening_accessor<const bfloat16_t> makes element access yield float;
+ * widening_accessor<bfloat16_t> yields a narrowing_reference proxy that reads
+ * as float and rounds on assignment. The accessors only follow the standard
+ * accessor-policy requirements, so they work with any mdspan implementation.
+ * The kernel overloads likewise only use the mdspan interface (mapping(),
+ * data_handle(), extents_type and the mapping queries), so they accept
+ * std::mdspan or any implementation that follows it; only the widening_mdspan
+ * and narrowing_mdspan aliases need C++23 <mdspan>. They hand dense,
+ * identically laid out operands to the span kernels in one call, contiguous
+ * innermost rows one row at a time, and anything else element by element.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_MDSPAN_HPP
+#define BFLOAT16_MDSPAN_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/detail/isa.hpp>
+#include <bfloat16/reduce.hpp>
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <type_traits>
+
+#if __has_include(<mdspan>)
+#include <mdspan>
+#endif
+
+namespace bf16 {
+
+	// What widening_accessor<bfloat16_t> returns: reads widen, writes narrow
+	class narrowing_reference {
+		private:
+			bfloat16_t* p;
+
+		public:
+			constexpr explicit narrowing_reference(bfloat16_t* ptr) noexcept : p(ptr) {}
+
+			constexpr operator float() const noexcept {
+				return static_cast<float>(*p);
+			}
+
+			// Assignment writes through, like a real reference; bf16 to bf16 copies are exact
+			constexpr const narrowing_reference& operator=(const narrowing_reference& other) const noexcept {
+				*p = *other.p;
+				return *this;
+			}
+
+			constexpr const narrowing_reference& operator=(bfloat16_t v) const noexcept {
+				*p = v;
+				return *this;
+			}
+
+			constexpr const narrowing_reference& operator=(float v) const noexcept {
+				*p = bfloat16_t(v);
+				return *this;
+			}
+
+			constexpr const narrowing_reference& operator+=(float v) const noexcept { return *this = static_cast<float>(*p) + v; }
+			constexpr const narrowing_reference& operator-=(float v) const noexcept { return *this = static_cast<float>(*p) - v; }
+			constexpr const narrowing_reference& operator*=(float v) const noexcept { return *this = static_cast<float>(*p) * v; }
+			constexpr const narrowing_reference& operator/=(float v) const noexcept { return *this = static_cast<float>(*p) / v; }
+	};
+
+	template<typename ElementType>
+	struct widening_accessor;
+
+	template<>
+	struct widening_accessor<bfloat16_t> {
+		using offset_policy = widening_accessor;
+		using element_type = bfloat16_t;
+		using reference = narrowing_reference;
+		using data_handle_type = bfloat16_t*;
+
+		constexpr reference access(data_handle_type p, std::size_t i) const noexcept {
+			return narrowing_reference(p + i);
+		}
+
+		constexpr data_handle_type offset(data_handle_type p, std::size_t i) const noexcept {
+			return p + i;
+		}
+	};
+
+	template<>
+	struct widening_accessor<const bfloat16_t> {
+		using offset_policy = widening_accessor;
+		using element_type = const bfloat16_t;
+		using reference = float;
+		using data_handle_type = const bfloat16_t*;
+
+		constexpr widening_accessor() noexcept = default;
+
+		// Writable views convert to read-only ones
+		constexpr widening_accessor(widening_accessor<bfloat16_t>) noexcept {}
+
+		constexpr reference access(data_handle_type p, std::size_t i) const noexcept {
+			return static_cast<float>(p[i]);
+		}
+
+		constexpr data_handle_type offset(data_handle_type p, std::size_t i) const noexcept {
+			return p + i;
+		}
+	};
+
+#if defined(__cpp_lib_mdspan)
+
+	// Read-only and writable float views of bf16 storage
+	template<typename Extents, typename Layout = std::layout_right>
+	using widening_mdspan = std::mdspan<const bfloat16_t, Extents, Layout, widening_accessor<const bfloat16_t>>;
+
+	template<typename Extents, typename Layout = std::layout_right>
+	using narrowing_mdspan = std::mdspan<bfloat16_t, Extents, Layout, widening_accessor<bfloat16_t>>;
+
+#endif
+
+	namespace detail {
+
+		// An mdspan over T or const T whose data handle is a plain pointer
+		// (std::default_accessor or widening_accessor)
+		template<typename M, typename T>
+		concept mdspan_of = requires(const M& m) {
+			typename M::extents_type;
+			m.mapping();
+			m.data_handle();
+		} && std::is_same_v<std::remove_const_t<typename M::element_type>, T>
+			&& std::is_same_v<typename M::data_handle_type, typename M::element_type*>;
+
+		template<typename M, typename T>
+		concept mutable_mdspan_of = mdspan_of<M, T> && !std::is_const_v<typename M::element_type>;
+
+		template<typename MA, typename MB>
+		constexpr bool same_order(const MA& a, const MB& b) noexcept {
+			if (!a.is_strided() || !b.is_strided()) return false;
+			for (std::size_t r = 0; r < MA::extents_type::rank(); ++r) {
+				if (a.stride(r) != b.stride(r)) return false;
+			}
+			return true;
+		}
+
+		// Call fn(offset_a, offset_b, len) over runs of elements that are
+		// contiguous in both mappings, covering every index exactly once
+		template<typename MA, typename MB, typename Fn>
+		void for_each_run(const MA& a, const MB& b, Fn&& fn) {
+			using extents_type = typename MA::extents_type;
+			using index_type = typename extents_type::index_type;
+			constexpr std::size_t rank = extents_type::rank();
+			const extents_type& ext = a.extents();
+
+			if constexpr (rank == 0) {
+				fn(static_cast<std::size_t>(a()), static_cast<std::size_t>(b()), std::size_t{1});
+			} else {
+				std::size_t total = 1;
+				for (std::size_t r = 0; r < rank; ++r) total *= static_cast<std::size_t>(ext.extent(r));
+				if (total == 0) return;
+
+				if (a.is_exhaustive() && b.is_exhaustive() && same_order(a, b)) {
+					fn(std::size_t{0}, std::size_t{0}, total);
+					return;
+				}
+
+				const bool rows = a.is_strided() && b.is_strided() && a.stride(rank - 1) == 1 && b.stride(rank - 1) == 1;
+				const index_type run = rows ? ext.extent(rank - 1) : index_type{1};
+				std::array<index_type, rank> idx{};
+				for (;;) {
+					fn(static_cast<std::size_t>(std::apply(a, idx)), static_cast<std::size_t>(std::apply(b, idx)), static_cast<std::size_t>(run));
+					std::size_t r = rank - 1;
+					idx[r] += run;
+					while (idx[r] >= ext.extent(r)) {
+						if (r == 0) return;
+						idx[r] = 0;
+						++idx[--r];
+					}
+				}
+			}
+		}
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// dst = src elementwise, widened; both views must have the same extents
+	template<detail::mdspan_of<bfloat16_t> Src, detail::mutable_mdspan_of<float> Dst>
+	void to_float(Src src, Dst dst) noexcept {
+		assert(src.extents() == dst.extents());
+		const bfloat16_t* s = src.data_handle();
+		float* d = dst.data_handle();
+		detail::for_each_run(src.mapping(), dst.mapping(), [&](std::size_t os, std::size_t od, std::size_t len) {
+			to_float(std::span<const bfloat16_t>(s + os, len), std::span<float>(d + od, len));
+		});
+	}
+
+	// dst = src elementwise, narrowed with bfloat16_t rounding
+	template<detail::mdspan_of<float> Src, detail::mutable_mdspan_of<bfloat16_t> Dst>
+	void from_float(Src src, Dst dst) noexcept {
+		assert(src.extents() == dst.extents());
+		const float* s = src.data_handle();
+		bfloat16_t* d = dst.data_handle();
+		detail::for_each_run(src.mapping(), dst.mapping(), [&](std::size_t os, std::size_t od, std::size_t len) {
+			from_float(std::span<const float>(s + os, len), std::span<bfloat16_t>(d + od, len));
+		});
+	}
+
+	// Sum of all elements, fp32 accumulation
+	template<detail::mdspan_of<bfloat16_t> X>
+	float sum(X x) noexcept {
+		const bfloat16_t* p = x.data_handle();
+		float total = 0.0f;
+		detail::for_each_run(x.mapping(), x.mapping(), [&](std::size_t o, std::size_t, std::size_t len) {
+			total += sum(std::span<const bfloat16_t>(p + o, len));
+		});
+		return total;
+	}
+
+	// Sum of a * b over all elements; both views must have the same extents
+	template<detail::mdspan_of<bfloat16_t> A, detail::mdspan_of<bfloat16_t> B>
+	float dot(A a, B b) noexcept {
+		assert(a.extents() == b.extents());
+		const bfloat16_t* pa = a.data_handle();
+		const bfloat16_t* pb = b.data_handle();
+		float total = 0.0f;
+		detail::for_each_run(a.mapping(), b.mapping(), [&](std::size_t oa, std::size_t ob, std::size_t len) {
+			total += dot(std::span<const bfloat16_t>(pa + oa, len), std::span<const bfloat16_t>(pb + ob, len));
+		});
+		return total;
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
@@ -0,0 +1,258 @@
+/**
+ * @file packed.hpp
+ * @brief Bit-packed bf16 storage keeping the full exponent and k mantissa bits
+ *
+ * Each value keeps its sign, all 8 exponent bits and the top k (0-7) mantissa
+ * bits: 9 + k bits per value instead of 16, e.g. 12 bits (-25%) for k = 3.
+ * Values are rounded to the shorter mantissa with the same add-half-minus-one
+ * rule as bfloat16_t(float); infinities are kept, and NaN stays NaN for k >= 1
+ * (k = 0 has no mantissa bit to mark it and stores infinity). k = 7 is lossless.
+ *
+ * Value i occupies bits [i * b, (i + 1) * b) of a little-endian bit stream,
+ * b = 9 + k. Eight values take exactly b bytes, so every group of eight
+ * starts on a byte boundary and any range can be decoded without touching
+ * the values before it. Values move between the stream and bf16 lanes with
+ * shifts; with BF16_USE_PDEP (see detail/isa.hpp) one PDEP (PEXT when
+ * packing) moves four at a time instead. Otherwise AVX2 builds unpack a group
+ * per byte shuffle and AVX-512 builds two.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_PACKED_HPP
+#define BFLOAT16_PACKED_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace bf16 {
+
+	struct packed_bf16_array {
+		std::size_t size = 0;
+		unsigned mantissa_bits = 7;   // k, 0-7
+		std::vector<uint8_t> bytes;   // groups of 8 values, plus padding for 8-byte loads
+
+		constexpr unsigned bits_per_value() const noexcept { return 9 + mantissa_bits; }
+		constexpr std::size_t groups() const noexcept { return (size + 7) / 8; }
+		constexpr std::size_t storage_bytes() const noexcept { return groups() * bits_per_value(); }
+	};
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		inline constexpr std::size_t packed_padding = 8;
+
+		// bf16 bits rounded to k mantissa bits (low 7 - k bits left for the caller to drop).
+		// A NaN whose payload sits only in the dropped bits gets the quiet bit.
+		constexpr uint16_t packed_round(uint16_t v, unsigned shift) noexcept {
+			const uint16_t kept = static_cast<uint16_t>((0x7Fu >> shift) << shift);
+			if ((v & 0x7F80) == 0x7F80) return (v & 0x007F) && !(v & kept) ? static_cast<uint16_t>(v | 0x0040) : v;
+			return shift == 0 ? v : static_cast<uint16_t>(v + ((1u << (shift - 1)) - 1));
+		}
+
+		inline void packed_round_block(const bfloat16_t* x, std::size_t n, unsigned shift, uint16_t* out) noexcept {
+			std::size_t i = 0;
+#if defined(BF16_HAVE_AVX2)
+			const __m256i exponent = _mm256_set1_epi16(0x7F80);
+			const __m256i mantissa = _mm256_set1_epi16(0x007F);
+			const __m256i kept = _mm256_set1_epi16(static_cast<int16_t>((0x7Fu >> shift) << shift));
+			const __m256i quiet = _mm256_set1_epi16(0x0040);
+			const __m256i half = _mm256_set1_epi16(static_cast<int16_t>(shift == 0 ? 0 : (1u << (shift - 1)) - 1));
+			for (; i + 16 <= n; i += 16) {
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+				const __m256i special = _mm256_cmpeq_epi16(_mm256_and_si256(v, exponent), exponent);
+				const __m256i zero = _mm256_setzero_si256();
+				const __m256i payload = _mm256_andnot_si256(_mm256_cmpeq_epi16(_mm256_and_si256(v, mantissa), zero), _mm256_cmpeq_epi16(_mm256_and_si256(v, kept), zero));
+				const __m256i nan_bit = _mm256_and_si256(payload, quiet);
+				const __m256i r = _mm256_blendv_epi8(_mm256_add_epi16(v, half), _mm256_or_si256(v, nan_bit), special);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+			}
+#endif
+			for (; i < n; ++i) out[i] = packed_round(x[i].bits(), shift);
+		}
+
+		// PDEP/PEXT mask of four values in bf16 lanes: the top b bits of each 16-bit lane
+		constexpr uint64_t packed_lane_mask(unsigned shift) noexcept {
+			const uint64_t lane = (0xFFFFu >> shift) << shift;
+			return lane | (lane << 16) | (lane << 32) | (lane << 48);
+		}
+
+		// Eight rounded bf16 values -> b bytes at dst
+		inline void pack_group(const uint16_t* v, unsigned b, unsigned shift, uint8_t* dst) noexcept {
+			uint64_t half[2];
+#if defined(BF16_HAVE_PDEP)
+			for (unsigned h = 0; h < 2; ++h) {
+				uint64_t lanes;
+				std::memcpy(&lanes, v + 4 * h, 8);
+				half[h] = _pext_u64(lanes, packed_lane_mask(shift));
+			}
+#else
+			for (unsigned h = 0; h < 2; ++h) {
+				half[h] = 0;
+				for (unsigned j = 0; j < 4; ++j) half[h] |= static_cast<uint64_t>(v[4 * h + j] >> shift) << (j * b);
+			}
+#endif
+			// The second half starts at bit 4b of the group; b = 16 fills the first word exactly
+			const unsigned split = 4 * b;
+			const uint64_t words[2] = {split == 64 ? half[0] : half[0] | (half[1] << split), split == 64 ? half[1] : half[1] >> (64 - split)};
+			std::memcpy(dst, words, b);
+		}
+
+		// b bytes at src -> eight bf16 values
+		inline void unpack_group(const uint8_t* src, unsigned b, unsigned shift, bfloat16_t* out) noexcept {
+			uint64_t half[2];
+			std::memcpy(&half[0], src, 8);
+			std::memcpy(&half[1], src + (4 * b) / 8, 8);
+			half[1] >>= (4 * b) % 8;
+#if defined(BF16_HAVE_PDEP)
+			for (unsigned h = 0; h < 2; ++h) {
+				const uint64_t lanes = _pdep_u64(half[h], packed_lane_mask(shift));
+				std::memcpy(static_cast<void*>(out + 4 * h), &lanes, 8);
+			}
+#else
+			const uint64_t mask = (uint64_t{1} << b) - 1;
+			for (unsigned h = 0; h < 2; ++h) {
+				for (unsigned j = 0; j < 4; ++j) {
+					out[4 * h + j] = bfloat16_t::from_bits(static_cast<uint16_t>(((half[h] >> (j * b)) & mask) << shift));
+				}
+			}
+#endif
+		}
+
+#if defined(BF16_HAVE_AVX2) && !defined(BF16_HAVE_PDEP)
+		// Moves value j of a group into 32-bit lane j: a shuffle control picking
+		// the bytes its b bits touch, and the bit offset to shift them down by
+		struct unpack_controls {
+			alignas(32) uint8_t bytes[32];
+			alignas(32) uint32_t offsets[8];
+		};
+
+		inline unpack_controls make_unpack_controls(unsigned b) noexcept {
+			unpack_controls c;
+			for (unsigned j = 0; j < 8; ++j) {
+				const unsigned first = j * b / 8, last = (j * b + b - 1) / 8;
+				for (unsigned t = 0; t < 4; ++t) c.bytes[4 * j + t] = first + t <= last ? static_cast<uint8_t>(first + t) : 0x80;
+				c.offsets[j] = j * b % 8;
+			}
+			return c;
+		}
+#endif
+
+		// groups whole groups of b bytes at src -> 8 * groups bf16 values. The
+		// vector paths read 16 bytes per group, which packed_padding covers.
+		inline void unpack_groups(const uint8_t* src, std::size_t groups, unsigned b, unsigned shift, bfloat16_t* out) noexcept {
+			std::size_t g = 0;
+#if defined(BF16_HAVE_AVX2) && !defined(BF16_HAVE_PDEP)
+			const unpack_controls c = make_unpack_controls(b);
+			const __m256i control = _mm256_load_si256(reinterpret_cast<const __m256i*>(c.bytes));
+			const __m256i offsets = _mm256_load_si256(reinterpret_cast<const __m256i*>(c.offsets));
+			const __m128i count = _mm_cvtsi32_si128(static_cast<int>(shift));
+			const int mask = static_cast<int>((1u << b) - 1);
+#if defined(BF16_HAVE_AVX512)
+			// Group g in the low 256 bits, group g + 1 in the high 256 bits
+			const __m512i control2 = _mm512_maskz_broadcast_i64x4(0xFF, control);
+			const __m512i offsets2 = _mm512_maskz_broadcast_i64x4(0xFF, offsets);
+			const __m512i mask2 = _mm512_set1_epi32(mask);
+			for (; g + 2 <= groups; g += 2) {
+				const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + g * b));
+				const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + (g + 1) * b));
+				const __m512i bytes = _mm512_or_si512(_mm512_maskz_broadcast_i32x4(0x00FF, lo), _mm512_maskz_broadcast_i32x4(0xFF00, hi));
+				const __m512i v = _mm512_maskz_srlv_epi32(full16, _mm512_shuffle_epi8(bytes, control2), offsets2);
+				const __m512i codes = _mm512_maskz_sll_epi32(full16, _mm512_and_si512(v, mask2), count);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 8 * g), _mm512_maskz_cvtepi32_epi16(full16, codes));
+			}
+#endif
+			const __m256i mask1 = _mm256_set1_epi32(mask);
+			for (; g < groups; ++g) {
+				const __m256i bytes = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + g * b)));
+				const __m256i v = _mm256_srlv_epi32(_mm256_shuffle_epi8(bytes, control), offsets);
+				const __m256i codes = _mm256_sll_epi32(_mm256_and_si256(v, mask1), count);
+				// packus interleaves the 128-bit lanes; gather values 0-3 and 4-7 into the low half
+				const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(codes, codes), 0x08);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8 * g), _mm256_castsi256_si128(packed));
+			}
+#endif
+			for (; g < groups; ++g) unpack_group(src + g * b, b, shift, out + 8 * g);
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// Pack x keeping mantissa_bits (0-7) mantissa bits per value
+	inline packed_bf16_array pack_bf16(std::span<const bfloat16_t> x, unsigned mantissa_bits) {
+		assert(mantissa_bits <= 7);
+		packed_bf16_array p;
+		p.size = x.size();
+		p.mantissa_bits = mantissa_bits;
+		p.bytes.assign(p.storage_bytes() + detail::packed_padding, 0);
+
+		const unsigned b = p.bits_per_value(), shift = 7 - mantissa_bits;
+		constexpr std::size_t chunk = 256;
+		uint16_t rounded[chunk];
+		for (std::size_t i = 0; i < x.size(); i += chunk) {
+			const std::size_t len = std::min(chunk, x.size() - i);
+			detail::packed_round_block(x.data() + i, len, shift, rounded);
+			std::fill(rounded + len, rounded + (len + 7) / 8 * 8, uint16_t{0});
+			for (std::size_t g = 0; g < len; g += 8) {
+				detail::pack_group(rounded + g, b, shift, p.bytes.data() + (i + g) / 8 * b);
+			}
+		}
+		return p;
+	}
+
+	// Value i
+	inline bfloat16_t packed_get(const packed_bf16_array& p, std::size_t i) noexcept {
+		assert(i < p.size);
+		const unsigned b = p.bits_per_value();
+		const std::size_t bit = i * b;
+		uint32_t w;
+		std::memcpy(&w, p.bytes.data() + bit / 8, 4);
+		const uint32_t code = (w >> (bit % 8)) & ((1u << b) - 1);
+		return bfloat16_t::from_bits(static_cast<uint16_t>(code << (16 - b)));
+	}
+
+	// out = values [first, first + out.size())
+	inline void unpack_bf16(const packed_bf16_array& p, std::size_t first, std::span<bfloat16_t> out) noexcept {
+		assert(first + out.size() <= p.size);
+		const unsigned b = p.bits_per_value(), shift = 7 - p.mantissa_bits;
+		const std::size_t last = first + out.size();
+		std::size_t i = first;
+		for (; i < last && i % 8 != 0; ++i) out[i - first] = packed_get(p, i);
+		const std::size_t groups = (last - i) / 8;
+		detail::unpack_groups(p.bytes.data() + i / 8 * b, groups, b, shift, out.data() + (i - first));
+		i += 8 * groups;
+		for (; i < last; ++i) out[i - first] = packed_get(p, i);
+	}
+
+	inline void unpack_bf16(const packed_bf16_array& p, std::span<bfloat16_t> out) noexcept {
+		unpack_bf16(p, 0, out.first(p.size));
+	}
+
+	// Decode straight to fp32, e.g. one embedding row at a time
+	inline void unpack_bf16(const packed_bf16_array& p, std::size_t first, std::span<float> out) noexcept {
+		constexpr std::size_t chunk = 256;
+		bfloat16_t tmp[chunk];
+		for (std::size_t i = 0; i < out.size(); i += chunk) {
+			const std::size_t len = std::min(chunk, out.size() - i);
+			unpack_bf16(p, first + i, std::span<bfloat16_t>(tmp, len));
+			to_float(std::span<const bfloat16_t>(tmp, len), out.subspan(i, len));
+		}
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file parallel.hpp
+ * @brief Minimal fork-join helpers used by the multithreaded kernels
+ *
+ * Work is split into tasks that are handed out from a shared counter; the
+ * calling thread takes part, so a thread count of 1 runs everything inline.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_PARALLEL_HPP
+#define BFLOAT16_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace bf16 {
+
+	namespace detail {
+		// 0 means "use std::thread::hardware_concurrency()"
+		inline std::atomic<std::size_t> thread_limit{0};
+	}
+
+	// Upper bound on threads used by the parallel kernels; 0 restores the default
+	inline void set_num_threads(std::size_t n) noexcept {
+		detail::thread_limit.store(n, std::memory_order_relaxed);
+	}
+
+	inline std::size_t get_num_threads() noexcept {
+		const std::size_t n = detail::thread_limit.load(std::memory_order_relaxed);
+		if (n != 0) return n;
+		return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	// Call fn(task) for every task in [0, tasks), spreading tasks over at most
+	// get_num_threads() threads. Returns once all tasks are done.
+	template<typename Fn>
+	void parallel_for(std::size_t tasks, Fn&& fn) {
+		const std::size_t threads = std::min(tasks, get_num_threads());
+		if (threads <= 1) {
+			for (std::size_t t = 0; t < tasks; ++t) fn(t);
+			return;
+		}
+
+		std::atomic<std::size_t> next{0};
+		auto worker = [&] {
+			for (std::size_t t = next.fetch_add(1, std::memory_order_relaxed); t < tasks;
+					t = next.fetch_add(1, std::memory_order_relaxed)) {
+				fn(t);
+			}
+		};
+
+		std::vector<std::jthread> pool;
+		pool.reserve(threads - 1);
+		for (std::size_t i = 1; i < threads; ++i) pool.emplace_back(worker);
+		worker();
+	}
+
+	// Split the items described by an exclusive prefix sum of their weights
+	// (prefix.size() == items + 1) into at most `parts` contiguous ranges of
+	// roughly equal weight. Returns the range boundaries, first 0, last items.
+	template<typename Index>
+	std::vector<std::size_t> partition_by_weight(std::span<const Index> prefix, std::size_t parts) {
+		const std::size_t items = prefix.empty() ? 0 : prefix.size() - 1;
+		std::vector<std::size_t> bounds{0};
+		if (items == 0) {
+			bounds.push_back(0);
+			return bounds;
+		}
+		parts = std::clamp<std::size_t>(parts, 1, items);
+		const double total = static_cast<double>(prefix[items] - prefix[0]);
+		for (std::size_t p = 1; p < parts; ++p) {
+			const double target = static_cast<double>(prefix[0]) + total * static_cast<double>(p) / static_cast<double>(parts);
+			auto it = std::lower_bound(prefix.begin() + static_cast<std::ptrdiff_t>(bounds.back()), prefix.end(), target,
+				[](Index v, double t) { return static_cast<double>(v) < t; });
+			std::size_t split = static_cast<std::size_t>(it - prefix.begin());
+			// Cut at whichever boundary lands closer to the target weight
+			if (split > bounds.back() && (split > items
+					|| target - static_cast<double>(prefix[split - 1]) < static_cast<double>(prefix[split]) - target)) {
+				--split;
+			}
+			if (split > bounds.back() && split < items) bounds.push_back(split);
+		}
+		bounds.push_back(items);
+		return bounds;
+	}
+
+} // namespace bf16
+
+#endif
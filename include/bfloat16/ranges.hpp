@@ -0,0 +1,168 @@
+/**
+ * @file ranges.hpp
+ * @brief Lazy views that widen bf16 ranges to float (and back) in SIMD-sized chunks
+ *
+ * data | bf16::views::as_float is a range of float. Elements are not
+ * converted one at a time through operator float(): each iterator converts a
+ * block of 64 elements with the bulk converters into a small buffer it owns,
+ * and converts the next block when it moves past it. views::as_bf16 is the
+ * reverse, narrowing a float range. The underlying range must be contiguous
+ * and sized.
+ *
+ * Iterators are forward iterators that point into the underlying storage,
+ * not into the view: they stay valid when the view is moved or destroyed, and
+ * iterators far apart never reconvert each other's blocks. The price is a
+ * 256-byte buffer copied along with each iterator.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_RANGES_HPP
+#define BFLOAT16_RANGES_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace bf16 {
+
+	namespace detail {
+
+		// The element type each view converts from
+		template<typename To>
+		struct convert_source;
+
+		template<>
+		struct convert_source<float> {
+			using type = bfloat16_t;
+		};
+
+		template<>
+		struct convert_source<bfloat16_t> {
+			using type = float;
+		};
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	template<std::ranges::view V, typename To>
+		requires std::ranges::contiguous_range<V> && std::ranges::sized_range<V>
+			&& std::same_as<std::ranges::range_value_t<V>, typename detail::convert_source<To>::type>
+	class convert_view : public std::ranges::view_interface<convert_view<V, To>> {
+		private:
+			using From = typename detail::convert_source<To>::type;
+
+			// Large enough to amortise the call into the converters, small enough
+			// that copying an iterator stays cheap
+			static constexpr std::size_t chunk = 64;
+
+			V source = V();
+
+		public:
+			class iterator {
+				private:
+					const From* data = nullptr;
+					std::size_t count = 0;
+					std::size_t index = 0;
+					mutable std::size_t buffer_begin = 0;
+					mutable std::size_t buffer_size = 0;
+					mutable To buffer[chunk] = {};
+
+				public:
+					using iterator_concept = std::forward_iterator_tag;
+					using iterator_category = std::input_iterator_tag;
+					using value_type = To;
+					using difference_type = std::ptrdiff_t;
+
+					iterator() = default;
+					iterator(const From* first, std::size_t n, std::size_t i) noexcept : data(first), count(n), index(i) {}
+
+					To operator*() const {
+						if (index - buffer_begin >= buffer_size) {
+							buffer_begin = index;
+							buffer_size = std::min(chunk, count - index);
+							if constexpr (std::same_as<To, float>) {
+								to_float(std::span<const bfloat16_t>(data + index, buffer_size), std::span<float>(buffer, buffer_size));
+							} else {
+								from_float(std::span<const float>(data + index, buffer_size), std::span<bfloat16_t>(buffer, buffer_size));
+							}
+						}
+						return buffer[index - buffer_begin];
+					}
+
+					iterator& operator++() noexcept {
+						++index;
+						return *this;
+					}
+
+					iterator operator++(int) noexcept {
+						iterator old = *this;
+						++index;
+						return old;
+					}
+
+					friend bool operator==(const iterator& a, const iterator& b) noexcept {
+						return a.index == b.index;
+					}
+			};
+
+			convert_view() requires std::default_initializable<V> = default;
+
+			explicit convert_view(V base) : source(std::move(base)) {}
+
+			V base() const& requires std::copy_constructible<V> { return source; }
+			V base() && { return std::move(source); }
+
+			iterator begin() { return iterator(std::ranges::data(source), size(), 0); }
+			iterator end() { return iterator(std::ranges::data(source), size(), size()); }
+
+			iterator begin() const requires std::ranges::contiguous_range<const V> {
+				return iterator(std::ranges::data(source), size(), 0);
+			}
+
+			iterator end() const requires std::ranges::contiguous_range<const V> {
+				return iterator(std::ranges::data(source), size(), size());
+			}
+
+			std::size_t size() const { return static_cast<std::size_t>(std::ranges::size(source)); }
+	};
+
+	namespace views {
+
+		template<typename To>
+		struct convert_fn {
+			template<std::ranges::viewable_range R>
+				requires std::same_as<std::ranges::range_value_t<R>, typename detail::convert_source<To>::type>
+			auto operator()(R&& r) const {
+				return convert_view<std::views::all_t<R>, To>(std::views::all(std::forward<R>(r)));
+			}
+
+			template<std::ranges::viewable_range R>
+				requires std::same_as<std::ranges::range_value_t<R>, typename detail::convert_source<To>::type>
+			friend auto operator|(R&& r, const convert_fn& f) {
+				return f(std::forward<R>(r));
+			}
+		};
+
+		// bf16 range -> float range
+		inline constexpr convert_fn<float> as_float{};
+
+		// float range -> bf16 range, with bfloat16_t rounding
+		inline constexpr convert_fn<bfloat16_t> as_bf16{};
+
+	} // namespace views
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
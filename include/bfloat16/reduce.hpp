@@ -0,0 +1,292 @@
+/**
+ * @file reduce.hpp
+ * @brief Dot products, sums and norms of bfloat16_t spans with fp32 accumulation
+ *
+ * Several independent accumulators hide the add latency. With AVX-512 BF16 the
+ * dot product multiplies bf16 pairs directly (vdpbf16ps), which treats
+ * subnormal inputs as zero; every other path widens first.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_REDUCE_HPP
+#define BFLOAT16_REDUCE_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <utility>
+
+namespace bf16 {
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		inline float dot_kernel(const bfloat16_t* a, const bfloat16_t* b, std::size_t n) noexcept {
+			std::size_t i = 0;
+			float sum = 0.0f;
+#if defined(BF16_HAVE_AVX512BF16)
+			__m512 acc0 = _mm512_setzero_ps();
+			__m512 acc1 = _mm512_setzero_ps();
+			for (; i + 64 <= n; i += 64) {
+				acc0 = _mm512_dpbf16_ps(acc0, (__m512bh)_mm512_loadu_si512(a + i), (__m512bh)_mm512_loadu_si512(b + i));
+				acc1 = _mm512_dpbf16_ps(acc1, (__m512bh)_mm512_loadu_si512(a + i + 32), (__m512bh)_mm512_loadu_si512(b + i + 32));
+			}
+			for (; i < n; i += 32) {
+				const __mmask32 m = tail_mask32(n - i);
+				acc0 = _mm512_dpbf16_ps(acc0, (__m512bh)_mm512_maskz_loadu_epi16(m, a + i), (__m512bh)_mm512_maskz_loadu_epi16(m, b + i));
+			}
+			i = n;
+			sum = hsum16(_mm512_add_ps(acc0, acc1));
+#elif defined(BF16_HAVE_AVX512)
+			__m512 acc0 = _mm512_setzero_ps();
+			__m512 acc1 = _mm512_setzero_ps();
+			for (; i + 32 <= n; i += 32) {
+				acc0 = _mm512_fmadd_ps(load16(a + i), load16(b + i), acc0);
+				acc1 = _mm512_fmadd_ps(load16(a + i + 16), load16(b + i + 16), acc1);
+			}
+			if (i < n) {
+				__mmask16 m = tail_mask16(n - i);
+				acc0 = _mm512_fmadd_ps(maskz_load16(a + i, m), maskz_load16(b + i, m), acc0);
+				i += std::min<std::size_t>(16, n - i);
+			}
+			if (i < n) {
+				__mmask16 m = tail_mask16(n - i);
+				acc1 = _mm512_fmadd_ps(maskz_load16(a + i, m), maskz_load16(b + i, m), acc1);
+				i = n;
+			}
+			sum = hsum16(_mm512_add_ps(acc0, acc1));
+#elif defined(BF16_HAVE_AVX2)
+			__m256 acc0 = _mm256_setzero_ps();
+			__m256 acc1 = _mm256_setzero_ps();
+			for (; i + 16 <= n; i += 16) {
+				acc0 = _mm256_fmadd_ps(load8(a + i), load8(b + i), acc0);
+				acc1 = _mm256_fmadd_ps(load8(a + i + 8), load8(b + i + 8), acc1);
+			}
+			sum = hsum8(_mm256_add_ps(acc0, acc1));
+#endif
+			for (; i < n; ++i) {
+				sum += widen(a[i]) * widen(b[i]);
+			}
+			return sum;
+		}
+
+		// sum a[0:n] * x[0:n], a bf16 and x fp32
+		inline float row_dot(const bfloat16_t* a, const float* x, std::size_t n) noexcept {
+			std::size_t i = 0;
+			float sum = 0.0f;
+#if defined(BF16_HAVE_AVX512)
+			__m512 acc = _mm512_setzero_ps();
+			for (; i + 16 <= n; i += 16) {
+				acc = _mm512_fmadd_ps(load16(a + i), _mm512_loadu_ps(x + i), acc);
+			}
+			if (i < n) {
+				const __mmask16 m = tail_mask16(n - i);
+				acc = _mm512_fmadd_ps(maskz_load16(a + i, m), _mm512_maskz_loadu_ps(m, x + i), acc);
+				i = n;
+			}
+			sum = hsum16(acc);
+#elif defined(BF16_HAVE_AVX2)
+			__m256 acc = _mm256_setzero_ps();
+			for (; i + 8 <= n; i += 8) {
+				acc = _mm256_fmadd_ps(load8(a + i), _mm256_loadu_ps(x + i), acc);
+			}
+			sum = hsum8(acc);
+#endif
+			for (; i < n; ++i) sum += widen(a[i]) * x[i];
+			return sum;
+		}
+
+		inline float sum_kernel(const bfloat16_t* x, std::size_t n) noexcept {
+			std::size_t i = 0;
+			float sum = 0.0f;
+#if defined(BF16_HAVE_AVX512)
+			__m512 acc0 = _mm512_setzero_ps();
+			__m512 acc1 = _mm512_setzero_ps();
+			for (; i + 32 <= n; i += 32) {
+				acc0 = _mm512_add_ps(acc0, load16(x + i));
+				acc1 = _mm512_add_ps(acc1, load16(x + i + 16));
+			}
+			for (; i < n; i += 16) {
+				acc0 = _mm512_add_ps(acc0, maskz_load16(x + i, tail_mask16(n - i)));
+			}
+			i = n;
+			sum = hsum16(_mm512_add_ps(acc0, acc1));
+#elif defined(BF16_HAVE_AVX2)
+			__m256 acc0 = _mm256_setzero_ps();
+			__m256 acc1 = _mm256_setzero_ps();
+			for (; i + 16 <= n; i += 16) {
+				acc0 = _mm256_add_ps(acc0, load8(x + i));
+				acc1 = _mm256_add_ps(acc1, load8(x + i + 8));
+			}
+			sum = hsum8(_mm256_add_ps(acc0, acc1));
+#endif
+			for (; i < n; ++i) sum += widen(x[i]);
+			return sum;
+		}
+
+		// Sum of (x * scale)^2
+		inline float sumsq_kernel(const bfloat16_t* x, std::size_t n, float scale) noexcept {
+			std::size_t i = 0;
+			float sum = 0.0f;
+#if defined(BF16_HAVE_AVX512)
+			const __m512 s = _mm512_set1_ps(scale);
+			__m512 acc0 = _mm512_setzero_ps();
+			__m512 acc1 = _mm512_setzero_ps();
+			for (; i + 32 <= n; i += 32) {
+				const __m512 v0 = _mm512_mul_ps(load16(x + i), s);
+				const __m512 v1 = _mm512_mul_ps(load16(x + i + 16), s);
+				acc0 = _mm512_fmadd_ps(v0, v0, acc0);
+				acc1 = _mm512_fmadd_ps(v1, v1, acc1);
+			}
+			for (; i < n; i += 16) {
+				const __m512 v = _mm512_mul_ps(maskz_load16(x + i, tail_mask16(n - i)), s);
+				acc0 = _mm512_fmadd_ps(v, v, acc0);
+			}
+			i = n;
+			sum = hsum16(_mm512_add_ps(acc0, acc1));
+#elif defined(BF16_HAVE_AVX2)
+			const __m256 s = _mm256_set1_ps(scale);
+			__m256 acc0 = _mm256_setzero_ps();
+			__m256 acc1 = _mm256_setzero_ps();
+			for (; i + 16 <= n; i += 16) {
+				const __m256 v0 = _mm256_mul_ps(load8(x + i), s);
+				const __m256 v1 = _mm256_mul_ps(load8(x + i + 8), s);
+				acc0 = _mm256_fmadd_ps(v0, v0, acc0);
+				acc1 = _mm256_fmadd_ps(v1, v1, acc1);
+			}
+			sum = hsum8(_mm256_add_ps(acc0, acc1));
+#endif
+			for (; i < n; ++i) {
+				const float v = widen(x[i]) * scale;
+				sum += v * v;
+			}
+			return sum;
+		}
+
+		// Sizes up to this are unrolled completely by the fixed-extent dot
+		inline constexpr std::size_t unroll_limit = 256;
+
+		// dot_kernel for a compile-time length: straight-line code, two
+		// accumulators, and the tail handled with a constant mask
+		template<std::size_t N>
+		inline float dot_fixed(const bfloat16_t* a, const bfloat16_t* b) noexcept {
+#if defined(BF16_HAVE_AVX512BF16)
+			constexpr std::size_t W = 32, tail = N % W;
+			__m512 acc[2] = {_mm512_setzero_ps(), _mm512_setzero_ps()};
+			[&]<std::size_t... I>(std::index_sequence<I...>) {
+				((acc[I % 2] = _mm512_dpbf16_ps(acc[I % 2],
+					(__m512bh)_mm512_loadu_si512(a + I * W), (__m512bh)_mm512_loadu_si512(b + I * W))), ...);
+			}(std::make_index_sequence<N / W>{});
+			if constexpr (tail != 0) {
+				constexpr __mmask32 m = (__mmask32{1} << tail) - 1;
+				acc[1] = _mm512_dpbf16_ps(acc[1],
+					(__m512bh)_mm512_maskz_loadu_epi16(m, a + N - tail), (__m512bh)_mm512_maskz_loadu_epi16(m, b + N - tail));
+			}
+			return hsum16(_mm512_add_ps(acc[0], acc[1]));
+#elif defined(BF16_HAVE_AVX512)
+			constexpr std::size_t W = 16, tail = N % W;
+			__m512 acc[2] = {_mm512_setzero_ps(), _mm512_setzero_ps()};
+			[&]<std::size_t... I>(std::index_sequence<I...>) {
+				((acc[I % 2] = _mm512_fmadd_ps(load16(a + I * W), load16(b + I * W), acc[I % 2])), ...);
+			}(std::make_index_sequence<N / W>{});
+			if constexpr (tail != 0) {
+				constexpr __mmask16 m = static_cast<__mmask16>((1u << tail) - 1);
+				acc[1] = _mm512_fmadd_ps(maskz_load16(a + N - tail, m), maskz_load16(b + N - tail, m), acc[1]);
+			}
+			return hsum16(_mm512_add_ps(acc[0], acc[1]));
+#elif defined(BF16_HAVE_AVX2)
+			constexpr std::size_t W = 8, tail = N % W;
+			__m256 acc[2] = {_mm256_setzero_ps(), _mm256_setzero_ps()};
+			[&]<std::size_t... I>(std::index_sequence<I...>) {
+				((acc[I % 2] = _mm256_fmadd_ps(load8(a + I * W), load8(b + I * W), acc[I % 2])), ...);
+			}(std::make_index_sequence<N / W>{});
+			float sum = hsum8(_mm256_add_ps(acc[0], acc[1]));
+			[&]<std::size_t... I>(std::index_sequence<I...>) {
+				((sum += widen(a[N - tail + I]) * widen(b[N - tail + I])), ...);
+			}(std::make_index_sequence<tail>{});
+			return sum;
+#else
+			float acc[4] = {};
+			[&]<std::size_t... I>(std::index_sequence<I...>) {
+				((acc[I % 4] += widen(a[I]) * widen(b[I])), ...);
+			}(std::make_index_sequence<N>{});
+			return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+		}
+
+		// Largest |x| as raw bits (NaN payloads compare above infinity)
+		inline uint16_t max_abs_bits(const bfloat16_t* x, std::size_t n) noexcept {
+			uint16_t m = 0;
+			for (std::size_t i = 0; i < n; ++i) m = std::max<uint16_t>(m, x[i].bits() & 0x7FFF);
+			return m;
+		}
+
+		// A sum of squares that overflowed or fell below the normal range must
+		// be redone relative to the largest magnitude
+		inline bool norm_out_of_range(float ss) noexcept {
+			return !(ss >= std::numeric_limits<float>::min() && ss <= std::numeric_limits<float>::max());
+		}
+
+		// Power of two at amax's exponent, held to [2^-126, 2^126] so it and its
+		// reciprocal are both normal: DAZ reads a subnormal scale as zero
+		inline float norm_scale(uint16_t amax) noexcept {
+			return widen_bits(std::clamp<uint16_t>(amax & 0x7F80, 0x0080, 0x7E80));
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	inline float dot(std::span<const bfloat16_t> a, std::span<const bfloat16_t> b) noexcept {
+		assert(a.size() == b.size());
+		return detail::dot_kernel(a.data(), b.data(), a.size());
+	}
+
+	// Fixed-length dot product, e.g. dot<64>(a, b) with std::array or
+	// fixed-extent spans. Lengths up to detail::unroll_limit compile to
+	// straight-line code with no loop or length checks.
+	template<std::size_t N>
+		requires (N != std::dynamic_extent)
+	inline float dot(std::span<const bfloat16_t, N> a, std::span<const bfloat16_t, N> b) noexcept {
+		if constexpr (N == 0) {
+			return 0.0f;
+		} else if constexpr (N <= detail::unroll_limit) {
+			return detail::dot_fixed<N>(a.data(), b.data());
+		} else {
+			return detail::dot_kernel(a.data(), b.data(), N);
+		}
+	}
+
+	inline float sum(std::span<const bfloat16_t> x) noexcept {
+		return detail::sum_kernel(x.data(), x.size());
+	}
+
+	// Euclidean norm. Squares of large bf16 values overflow fp32 and squares
+	// of small ones underflow, so a sum of squares outside the normal range is
+	// recomputed relative to the largest magnitude.
+	inline float norm(std::span<const bfloat16_t> x) noexcept {
+		const float ss = detail::sumsq_kernel(x.data(), x.size(), 1.0f);
+		if (!detail::norm_out_of_range(ss)) return std::sqrt(ss);
+
+		const uint16_t amax = detail::max_abs_bits(x.data(), x.size());
+		if (amax == 0) return 0.0f;
+		if (amax >= 0x7F80) return detail::widen_bits(amax);  // inf, or NaN
+		const float scale = detail::norm_scale(amax);
+		return scale * std::sqrt(detail::sumsq_kernel(x.data(), x.size(), 1.0f / scale));
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
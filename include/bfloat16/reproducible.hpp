@@ -0,0 +1,235 @@
+/**
+ * @file reproducible.hpp
+ * @brief Bit-reproducible sum, dot, norm and GEMM over bfloat16_t data
+ *
+ * The functions in bf16::reproducible fix the reduction order from the data
+ * size alone, so their results are bit-identical for any thread count and on
+ * any instruction set:
+ *  - element i goes to lane i % 16 of its 4096-element block, and each lane
+ *    accumulates in index order (products with a fused multiply-add, scalar
+ *    code included, so no path depends on contraction);
+ *  - the 16 lanes are folded pairwise, always in the same order;
+ *  - block results are combined by a pairwise tree over the block index.
+ * AVX-512 keeps the 16 lanes in one register and AVX2 in two; threads only
+ * decide which blocks they compute. The cost over the plain kernels is the
+ * loss of independent accumulators within a block.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_REPRODUCIBLE_HPP
+#define BFLOAT16_REPRODUCIBLE_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/parallel.hpp>
+#include <bfloat16/reduce.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace bf16 {
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		inline constexpr std::size_t repro_lanes = 16;
+		inline constexpr std::size_t repro_block = 4096;
+
+		enum class repro_op { sum, dot, sumsq };
+
+		// Pairwise sum of values fed in order: the same tree as repeatedly adding
+		// neighbours (v[0] + v[1], v[2] + v[3], ...) level by level, built as a
+		// stack of completed power-of-two subtrees
+		class pairwise_sum {
+			private:
+				float stack[64];
+				std::size_t depth = 0;
+				std::size_t count = 0;
+
+			public:
+				void add(float v) noexcept {
+					for (std::size_t c = count; c & 1; c >>= 1) v = stack[--depth] + v;
+					stack[depth++] = v;
+					++count;
+				}
+
+				float result() const noexcept {
+					if (depth == 0) return 0.0f;
+					float t = stack[depth - 1];
+					for (std::size_t i = depth - 1; i-- > 0;) t = stack[i] + t;
+					return t;
+				}
+		};
+
+		// One block (n <= repro_block) in the canonical lane order; b is only read for dot
+		template<repro_op Op>
+		inline float repro_block_kernel(const bfloat16_t* a, const bfloat16_t* b, std::size_t n, float scale) noexcept {
+			float lanes[repro_lanes] = {};
+			std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+			const __m512 s = _mm512_set1_ps(scale);
+			__m512 acc = _mm512_setzero_ps();
+			for (; i + 16 <= n; i += 16) {
+				const __m512 x = load16(a + i);
+				if constexpr (Op == repro_op::sum) {
+					acc = _mm512_add_ps(acc, x);
+				} else if constexpr (Op == repro_op::dot) {
+					acc = _mm512_fmadd_ps(x, load16(b + i), acc);
+				} else {
+					const __m512 v = _mm512_mul_ps(x, s);
+					acc = _mm512_fmadd_ps(v, v, acc);
+				}
+			}
+			_mm512_storeu_ps(lanes, acc);
+#elif defined(BF16_HAVE_AVX2)
+			const __m256 s = _mm256_set1_ps(scale);
+			__m256 lo = _mm256_setzero_ps(), hi = _mm256_setzero_ps();
+			for (; i + 16 <= n; i += 16) {
+				const __m256 x0 = load8(a + i), x1 = load8(a + i + 8);
+				if constexpr (Op == repro_op::sum) {
+					lo = _mm256_add_ps(lo, x0);
+					hi = _mm256_add_ps(hi, x1);
+				} else if constexpr (Op == repro_op::dot) {
+					lo = _mm256_fmadd_ps(x0, load8(b + i), lo);
+					hi = _mm256_fmadd_ps(x1, load8(b + i + 8), hi);
+				} else {
+					const __m256 v0 = _mm256_mul_ps(x0, s), v1 = _mm256_mul_ps(x1, s);
+					lo = _mm256_fmadd_ps(v0, v0, lo);
+					hi = _mm256_fmadd_ps(v1, v1, hi);
+				}
+			}
+			_mm256_storeu_ps(lanes, lo);
+			_mm256_storeu_ps(lanes + 8, hi);
+#endif
+			for (; i < n; ++i) {
+				float& lane = lanes[i % repro_lanes];
+				const float x = widen(a[i]);
+				if constexpr (Op == repro_op::sum) {
+					lane += x;
+				} else if constexpr (Op == repro_op::dot) {
+					lane = std::fma(x, widen(b[i]), lane);
+				} else {
+					const float v = x * scale;
+					lane = std::fma(v, v, lane);
+				}
+			}
+			for (std::size_t w = repro_lanes / 2; w > 0; w /= 2) {
+				for (std::size_t j = 0; j < w; ++j) lanes[j] += lanes[j + w];
+			}
+			return lanes[0];
+		}
+
+		// Whole span on the calling thread
+		template<repro_op Op>
+		inline float repro_reduce_serial(const bfloat16_t* a, const bfloat16_t* b, std::size_t n, float scale) noexcept {
+			pairwise_sum total;
+			for (std::size_t off = 0; off < n; off += repro_block) {
+				const bfloat16_t* bb = Op == repro_op::dot ? b + off : nullptr;
+				total.add(repro_block_kernel<Op>(a + off, bb, std::min(repro_block, n - off), scale));
+			}
+			return total.result();
+		}
+
+		// Blocks are spread over threads; the combination order stays fixed
+		template<repro_op Op>
+		inline float repro_reduce(const bfloat16_t* a, const bfloat16_t* b, std::size_t n, float scale) {
+			const std::size_t blocks = (n + repro_block - 1) / repro_block;
+			constexpr std::size_t blocks_per_task = 16;
+			if (blocks <= blocks_per_task) return repro_reduce_serial<Op>(a, b, n, scale);
+
+			std::vector<float> partial(blocks);
+			parallel_for((blocks + blocks_per_task - 1) / blocks_per_task, [&](std::size_t t) {
+				const std::size_t end = std::min(blocks, (t + 1) * blocks_per_task);
+				for (std::size_t blk = t * blocks_per_task; blk < end; ++blk) {
+					const std::size_t off = blk * repro_block;
+					const bfloat16_t* bb = Op == repro_op::dot ? b + off : nullptr;
+					partial[blk] = repro_block_kernel<Op>(a + off, bb, std::min(repro_block, n - off), scale);
+				}
+			});
+			pairwise_sum total;
+			for (float p : partial) total.add(p);
+			return total.result();
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	namespace reproducible {
+
+		BF16_ISA_BEGIN
+
+		inline float sum(std::span<const bfloat16_t> x) {
+			return detail::repro_reduce<detail::repro_op::sum>(x.data(), nullptr, x.size(), 1.0f);
+		}
+
+		inline float dot(std::span<const bfloat16_t> a, std::span<const bfloat16_t> b) {
+			assert(a.size() == b.size());
+			return detail::repro_reduce<detail::repro_op::dot>(a.data(), b.data(), a.size(), 1.0f);
+		}
+
+		// As bf16::norm: a sum of squares outside the normal range is redone
+		// relative to the largest magnitude, in the same fixed order
+		inline float norm(std::span<const bfloat16_t> x) {
+			const float ss = detail::repro_reduce<detail::repro_op::sumsq>(x.data(), nullptr, x.size(), 1.0f);
+			if (!detail::norm_out_of_range(ss)) return std::sqrt(ss);
+
+			const uint16_t amax = detail::max_abs_bits(x.data(), x.size());
+			if (amax == 0) return 0.0f;
+			if (amax >= 0x7F80) return detail::widen_bits(amax);
+			const float scale = detail::norm_scale(amax);
+			return scale * std::sqrt(detail::repro_reduce<detail::repro_op::sumsq>(x.data(), nullptr, x.size(), 1.0f / scale));
+		}
+
+		// C[m x n] = A[m x k] * B[k x n] (or C += with accumulate). Every C
+		// element is a reproducible dot product of a row of A with a column of
+		// B, so the result does not depend on threads, ISA or blocking.
+		template<typename Out>
+			requires std::is_same_v<Out, float> || std::is_same_v<Out, bfloat16_t>
+		void gemm(std::size_t m, std::size_t n, std::size_t k,
+				const bfloat16_t* a, std::size_t lda,
+				const bfloat16_t* b, std::size_t ldb,
+				Out* c, std::size_t ldc, bool accumulate = false) {
+			if (m == 0 || n == 0) return;
+
+			// Columns of B made contiguous: bt[j * k + p] = B[p][j]
+			std::vector<bfloat16_t> bt(n * k);
+			constexpr std::size_t cols_per_task = 64;
+			parallel_for((n + cols_per_task - 1) / cols_per_task, [&](std::size_t t) {
+				const std::size_t j1 = std::min(n, (t + 1) * cols_per_task);
+				for (std::size_t p = 0; p < k; ++p) {
+					for (std::size_t j = t * cols_per_task; j < j1; ++j) bt[j * k + p] = b[p * ldb + j];
+				}
+			});
+
+			// A few rows per task, so each column of B^T is reused from L1 across them
+			constexpr std::size_t rows_per_task = 8;
+			parallel_for((m + rows_per_task - 1) / rows_per_task, [&](std::size_t t) {
+				const std::size_t i1 = std::min(m, (t + 1) * rows_per_task);
+				for (std::size_t j = 0; j < n; ++j) {
+					const bfloat16_t* col = bt.data() + j * k;
+					for (std::size_t i = t * rows_per_task; i < i1; ++i) {
+						float v = detail::repro_reduce_serial<detail::repro_op::dot>(a + i * lda, col, k, 1.0f);
+						Out& dst = c[i * ldc + j];
+						if (accumulate) v += static_cast<float>(dst);
+						if constexpr (std::is_same_v<Out, float>) dst = v;
+						else dst = detail::narrow(v);
+					}
+				}
+			});
+		}
+
+		BF16_ISA_END
+
+	} // namespace reproducible
+
+} // namespace bf16
+
+#endif
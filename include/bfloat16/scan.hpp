@@ -0,0 +1,137 @@
+/**
+ * @file scan.hpp
+ * @brief Inclusive and exclusive prefix sums over bfloat16_t with fp32 carries
+ *
+ * The running sum is kept in fp32 and only each output is narrowed, so long
+ * prefixes keep growing instead of stalling once the total dwarfs the bf16
+ * spacing. Large inputs use a two-level decomposition: every thread reduces
+ * its chunk, the chunk totals are scanned, then every thread scans its chunk
+ * again starting from its offset.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_SCAN_HPP
+#define BFLOAT16_SCAN_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/parallel.hpp>
+#include <bfloat16/reduce.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace bf16 {
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		// Inputs shorter than this per thread are scanned serially
+		inline constexpr std::size_t scan_grain = 1 << 16;
+
+		// Scan x into out (either bf16 or float) starting from carry; returns the
+		// final carry. With exclusive, out[i] excludes x[i].
+		template<typename Out>
+		float scan_block(const bfloat16_t* x, std::size_t n, Out* out, float carry, bool exclusive) noexcept {
+			std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+			// In-register scan of 16 lanes: log2(16) shift-and-add steps
+			const __m512i zero = _mm512_setzero_si512();
+			const __m512i idx_last = _mm512_set1_epi32(15);
+			__m512 vcarry = _mm512_set1_ps(carry);
+			for (; i + 16 <= n; i += 16) {
+				__m512 v = load16(x + i);
+				v = _mm512_add_ps(v, _mm512_castsi512_ps(_mm512_maskz_alignr_epi32(full16, _mm512_castps_si512(v), zero, 15)));
+				v = _mm512_add_ps(v, _mm512_castsi512_ps(_mm512_maskz_alignr_epi32(full16, _mm512_castps_si512(v), zero, 14)));
+				v = _mm512_add_ps(v, _mm512_castsi512_ps(_mm512_maskz_alignr_epi32(full16, _mm512_castps_si512(v), zero, 12)));
+				v = _mm512_add_ps(v, _mm512_castsi512_ps(_mm512_maskz_alignr_epi32(full16, _mm512_castps_si512(v), zero, 8)));
+				v = _mm512_add_ps(v, vcarry);
+				// Exclusive: shift the inclusive sums up one lane and put the old carry in lane 0
+				const __m512 result = exclusive
+					? _mm512_castsi512_ps(_mm512_maskz_alignr_epi32(full16, _mm512_castps_si512(v), _mm512_castps_si512(vcarry), 15))
+					: v;
+				if constexpr (std::is_same_v<Out, float>) {
+					_mm512_storeu_ps(out + i, result);
+				} else {
+					store16(out + i, result);
+				}
+				vcarry = _mm512_maskz_permutexvar_ps(full16, idx_last, v);
+			}
+			carry = _mm512_cvtss_f32(vcarry);
+#endif
+			for (; i < n; ++i) {
+				const float v = widen(x[i]);
+				const float before = carry;
+				carry += v;
+				const float result = exclusive ? before : carry;
+				if constexpr (std::is_same_v<Out, float>) {
+					out[i] = result;
+				} else {
+					out[i] = narrow(result);
+				}
+			}
+			return carry;
+		}
+
+		template<typename Out>
+		void scan(std::span<const bfloat16_t> x, Out* out, bool exclusive, float init) {
+			const std::size_t n = x.size();
+			const std::size_t chunks = std::min(get_num_threads(), n / scan_grain);
+			if (chunks <= 1) {
+				scan_block(x.data(), n, out, init, exclusive);
+				return;
+			}
+
+			const std::size_t len = (n + chunks - 1) / chunks;
+			std::vector<float> offsets(chunks, 0.0f);
+			parallel_for(chunks - 1, [&](std::size_t c) {
+				const std::size_t begin = c * len;
+				offsets[c + 1] = sum_kernel(x.data() + begin, std::min(len, n - begin));
+			});
+			offsets[0] = init;
+			for (std::size_t c = 1; c < chunks; ++c) offsets[c] += offsets[c - 1];
+
+			parallel_for(chunks, [&](std::size_t c) {
+				const std::size_t begin = c * len;
+				scan_block(x.data() + begin, std::min(len, n - begin), out + begin, offsets[c], exclusive);
+			});
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// out[i] = init + x[0] + ... + x[i]
+	inline void inclusive_scan(std::span<const bfloat16_t> x, std::span<bfloat16_t> out, float init = 0.0f) {
+		assert(out.size() >= x.size());
+		detail::scan(x, out.data(), false, init);
+	}
+
+	inline void inclusive_scan(std::span<const bfloat16_t> x, std::span<float> out, float init = 0.0f) {
+		assert(out.size() >= x.size());
+		detail::scan(x, out.data(), false, init);
+	}
+
+	// out[i] = init + x[0] + ... + x[i - 1]
+	inline void exclusive_scan(std::span<const bfloat16_t> x, std::span<bfloat16_t> out, float init = 0.0f) {
+		assert(out.size() >= x.size());
+		detail::scan(x, out.data(), true, init);
+	}
+
+	inline void exclusive_scan(std::span<const bfloat16_t> x, std::span<float> out, float init = 0.0f) {
+		assert(out.size() >= x.size());
+		detail::scan(x, out.data(), true, init);
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
@@ -0,0 +1,251 @@
+/**
+ * @file simd.hpp
+ * @brief Data-parallel bfloat16_t vectors on top of std::experimental::simd
+ *
+ * simd<N> stores N bf16 lanes and does its arithmetic in
+ * std::experimental::fixed_size_simd<float, N>, narrowing results with the
+ * same rounding as bfloat16_t. Kernels written against it read like the
+ * scalar code but run N lanes at a time, and the float side interoperates
+ * directly with the rest of the Parallelism TS (where, reduce, masks).
+ * Needs a standard library that ships <experimental/simd> (libstdc++ 11+).
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_SIMD_HPP
+#define BFLOAT16_SIMD_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#if !__has_include(<experimental/simd>)
+#error "bfloat16/simd.hpp requires <experimental/simd>"
+#endif
+#include <experimental/simd>
+
+namespace bf16 {
+
+	BF16_ISA_BEGIN
+
+	// Lanes in one native fp32 register for this translation unit's flags
+	inline constexpr std::size_t simd_native_size = std::experimental::native_simd<float>::size();
+
+	template<std::size_t N>
+	class simd_where_expression;
+
+	template<std::size_t N = simd_native_size>
+	class simd {
+		private:
+			bfloat16_t lanes[N];
+
+		public:
+			using value_type = bfloat16_t;
+			using float_type = std::experimental::fixed_size_simd<float, N>;
+			using mask_type = typename float_type::mask_type;
+
+			static constexpr std::size_t size() noexcept { return N; }
+
+			simd() noexcept = default;
+
+			// Broadcast
+			simd(bfloat16_t v) noexcept {
+				for (std::size_t i = 0; i < N; ++i) lanes[i] = v;
+			}
+
+			// Narrow every lane of v
+			explicit simd(const float_type& v) noexcept {
+				float tmp[N];
+				v.copy_to(tmp, std::experimental::element_aligned);
+				from_float(std::span<const float>(tmp, N), std::span<bfloat16_t>(lanes, N));
+			}
+
+			// Load N contiguous elements
+			explicit simd(const bfloat16_t* p) noexcept {
+				copy_from(p);
+			}
+
+			void copy_from(const bfloat16_t* p) noexcept {
+				for (std::size_t i = 0; i < N; ++i) lanes[i] = p[i];
+			}
+
+			void copy_to(bfloat16_t* p) const noexcept {
+				for (std::size_t i = 0; i < N; ++i) p[i] = lanes[i];
+			}
+
+			// Widen every lane (exact)
+			float_type to_float() const noexcept {
+				float tmp[N];
+				bf16::to_float(std::span<const bfloat16_t>(lanes, N), std::span<float>(tmp, N));
+				return float_type(tmp, std::experimental::element_aligned);
+			}
+
+			explicit operator float_type() const noexcept {
+				return to_float();
+			}
+
+			bfloat16_t operator[](std::size_t i) const noexcept {
+				return lanes[i];
+			}
+
+			bfloat16_t& operator[](std::size_t i) noexcept {
+				return lanes[i];
+			}
+
+			// Sign flips are exact, so no round trip through fp32
+			simd operator-() const noexcept {
+				simd r;
+				for (std::size_t i = 0; i < N; ++i) r.lanes[i] = bfloat16_t::from_bits(lanes[i].bits() ^ 0x8000);
+				return r;
+			}
+
+			simd operator+() const noexcept {
+				return *this;
+			}
+
+			// bf16 op bf16 rounds back to bf16, like the scalar type
+			friend simd operator+(const simd& a, const simd& b) noexcept { return simd(a.to_float() + b.to_float()); }
+			friend simd operator-(const simd& a, const simd& b) noexcept { return simd(a.to_float() - b.to_float()); }
+			friend simd operator*(const simd& a, const simd& b) noexcept { return simd(a.to_float() * b.to_float()); }
+			friend simd operator/(const simd& a, const simd& b) noexcept { return simd(a.to_float() / b.to_float()); }
+
+			// Mixed with fp32 vectors the result stays fp32
+			friend float_type operator+(const simd& a, const float_type& b) noexcept { return a.to_float() + b; }
+			friend float_type operator-(const simd& a, const float_type& b) noexcept { return a.to_float() - b; }
+			friend float_type operator*(const simd& a, const float_type& b) noexcept { return a.to_float() * b; }
+			friend float_type operator/(const simd& a, const float_type& b) noexcept { return a.to_float() / b; }
+			friend float_type operator+(const float_type& a, const simd& b) noexcept { return a + b.to_float(); }
+			friend float_type operator-(const float_type& a, const simd& b) noexcept { return a - b.to_float(); }
+			friend float_type operator*(const float_type& a, const simd& b) noexcept { return a * b.to_float(); }
+			friend float_type operator/(const float_type& a, const simd& b) noexcept { return a / b.to_float(); }
+
+			simd& operator+=(const simd& b) noexcept { return *this = *this + b; }
+			simd& operator-=(const simd& b) noexcept { return *this = *this - b; }
+			simd& operator*=(const simd& b) noexcept { return *this = *this * b; }
+			simd& operator/=(const simd& b) noexcept { return *this = *this / b; }
+
+			// IEEE comparisons: NaN lanes compare false except !=
+			friend mask_type operator==(const simd& a, const simd& b) noexcept { return a.to_float() == b.to_float(); }
+			friend mask_type operator!=(const simd& a, const simd& b) noexcept { return a.to_float() != b.to_float(); }
+			friend mask_type operator<(const simd& a, const simd& b) noexcept { return a.to_float() < b.to_float(); }
+			friend mask_type operator<=(const simd& a, const simd& b) noexcept { return a.to_float() <= b.to_float(); }
+			friend mask_type operator>(const simd& a, const simd& b) noexcept { return a.to_float() > b.to_float(); }
+			friend mask_type operator>=(const simd& a, const simd& b) noexcept { return a.to_float() >= b.to_float(); }
+	};
+
+	// Masked assignment, loads and stores: where(m, v) = x only touches the
+	// lanes selected by m. Lanes are widened and narrowed again, which is
+	// exact for every bf16 value including NaN payloads.
+	template<std::size_t N>
+	class simd_where_expression {
+		private:
+			using float_type = typename simd<N>::float_type;
+			using mask_type = typename simd<N>::mask_type;
+
+			const mask_type& mask;
+			simd<N>& target;
+
+			template<typename Op>
+			void apply(Op op) noexcept {
+				float_type v = target.to_float();
+				op(v);
+				target = simd<N>(v);
+			}
+
+		public:
+			simd_where_expression(const mask_type& m, simd<N>& v) noexcept : mask(m), target(v) {}
+
+			void operator=(const simd<N>& x) noexcept {
+				for (std::size_t i = 0; i < N; ++i) {
+					if (mask[i]) target[i] = x[i];
+				}
+			}
+
+			void operator=(const float_type& x) noexcept { apply([&](float_type& v) { std::experimental::where(mask, v) = x; }); }
+			void operator+=(const float_type& x) noexcept { apply([&](float_type& v) { std::experimental::where(mask, v) += x; }); }
+			void operator-=(const float_type& x) noexcept { apply([&](float_type& v) { std::experimental::where(mask, v) -= x; }); }
+			void operator*=(const float_type& x) noexcept { apply([&](float_type& v) { std::experimental::where(mask, v) *= x; }); }
+			void operator/=(const float_type& x) noexcept { apply([&](float_type& v) { std::experimental::where(mask, v) /= x; }); }
+			void operator+=(const simd<N>& x) noexcept { *this += x.to_float(); }
+			void operator-=(const simd<N>& x) noexcept { *this -= x.to_float(); }
+			void operator*=(const simd<N>& x) noexcept { *this *= x.to_float(); }
+			void operator/=(const simd<N>& x) noexcept { *this /= x.to_float(); }
+
+			// Unselected lanes of p are neither read nor written, so these are
+			// safe on the ragged end of a buffer
+			void copy_from(const bfloat16_t* p) noexcept {
+				for (std::size_t i = 0; i < N; ++i) {
+					if (mask[i]) target[i] = p[i];
+				}
+			}
+
+			void copy_to(bfloat16_t* p) const noexcept {
+				for (std::size_t i = 0; i < N; ++i) {
+					if (mask[i]) p[i] = target[i];
+				}
+			}
+	};
+
+	template<std::size_t N>
+	simd_where_expression<N> where(const typename simd<N>::mask_type& m, simd<N>& v) noexcept {
+		return simd_where_expression<N>(m, v);
+	}
+
+	// Mask of the first n lanes, for loop tails
+	template<std::size_t N = simd_native_size>
+	typename simd<N>::mask_type simd_tail_mask(std::size_t n) noexcept {
+		typename simd<N>::mask_type m(false);
+		for (std::size_t i = 0; i < N && i < n; ++i) m[i] = true;
+		return m;
+	}
+
+	// Sum of all lanes in fp32
+	template<std::size_t N>
+	float reduce(const simd<N>& v) noexcept {
+		return std::experimental::reduce(v.to_float());
+	}
+
+	// Sum of the lanes selected by m
+	template<std::size_t N>
+	float reduce(const simd<N>& v, const typename simd<N>::mask_type& m) noexcept {
+		typename simd<N>::float_type f = v.to_float();
+		std::experimental::where(!m, f) = 0.0f;
+		return std::experimental::reduce(f);
+	}
+
+	template<std::size_t N>
+	bfloat16_t hmin(const simd<N>& v) noexcept {
+		return bfloat16_t(std::experimental::hmin(v.to_float()));
+	}
+
+	template<std::size_t N>
+	bfloat16_t hmax(const simd<N>& v) noexcept {
+		return bfloat16_t(std::experimental::hmax(v.to_float()));
+	}
+
+	template<std::size_t N>
+	simd<N> min(const simd<N>& a, const simd<N>& b) noexcept {
+		return simd<N>(std::experimental::min(a.to_float(), b.to_float()));
+	}
+
+	template<std::size_t N>
+	simd<N> max(const simd<N>& a, const simd<N>& b) noexcept {
+		return simd<N>(std::experimental::max(a.to_float(), b.to_float()));
+	}
+
+	// a * b + c in fp32, then rounded to bf16. The product is exact unless it
+	// underflows, but the sum rounds to fp32 before the bf16 rounding, so this
+	// rounds twice and can differ from a fused result by one bf16 ulp on ties.
+	template<std::size_t N>
+	simd<N> fma(const simd<N>& a, const simd<N>& b, const simd<N>& c) noexcept {
+		return simd<N>(a.to_float() * b.to_float() + c.to_float());
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
@@ -0,0 +1,396 @@
+/**
+ * @file solve.hpp
+ * @brief Dense linear solves from bf16 LU / Cholesky factors with iterative refinement
+ *
+ * The factors are stored in bfloat16_t, half the bytes of fp32, and computed
+ * with a right-looking blocked algorithm. Each nb-wide panel is factored in
+ * fp32. The trailing matrix is then updated in place by the blocked gemm,
+ * with the old values added back through epilogue::residual, so every
+ * element is rounded to bf16 once per panel. Trailing updates run on row
+ * blocks in parallel. The row blocks do not depend on the thread count, so
+ * the factors are bit-identical for any thread count.
+ *
+ * On their own the factors solve to bf16 accuracy. The solve_lu /
+ * solve_cholesky drivers refine that: each step computes the residual
+ * b - A x in fp64 against the original matrix, solves for a correction with
+ * the bf16 factors and adds it to an fp64 copy of x. This converges to
+ * fp32 or fp64 accuracy when cond(A) is well below 1 / 2^-8 = 256, as for
+ * well-conditioned covariance matrices. Otherwise it stops once the residual
+ * stops shrinking and reports converged = false.
+ *
+ * Matrices are row-major with an explicit leading dimension.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_SOLVE_HPP
+#define BFLOAT16_SOLVE_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/epilogue.hpp>
+#include <bfloat16/gemm.hpp>
+#include <bfloat16/parallel.hpp>
+#include <bfloat16/sparse.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bf16 {
+
+	// P A = L U with unit lower L below the diagonal and U on and above it, in
+	// one n x n bf16 matrix. Row j was swapped with row pivots[j] (>= j) before
+	// step j, as in LAPACK getrf.
+	struct lu_factorization {
+		std::size_t n = 0;
+		std::vector<bfloat16_t> lu;
+		std::vector<std::size_t> pivots;
+	};
+
+	// A = L L^T, L lower triangular n x n bf16 (upper triangle zero)
+	struct cholesky_factorization {
+		std::size_t n = 0;
+		std::vector<bfloat16_t> l;
+	};
+
+	struct refinement_result {
+		std::size_t iterations = 0;   // corrections applied after the first solve
+		double backward_error = 0.0;  // ||b - A x||_inf / (||A||_inf ||x||_inf + ||b||_inf)
+		bool converged = false;
+	};
+
+	template<typename Real>
+	concept solve_real = std::is_same_v<Real, float> || std::is_same_v<Real, double>;
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		// Panel width, and column block of the fp32 triangular solves on a block row
+		inline constexpr std::size_t solve_nb = 64;
+		inline constexpr std::size_t solve_cols = 256;
+		// Row block of a trailing update task: one gemm cache block of A
+		inline constexpr std::size_t solve_rows = gemm_mc;
+
+		// dst[i * n + j] = bf16(a[i * lda + j])
+		template<solve_real Real>
+		void narrow_matrix(std::size_t n, const Real* a, std::size_t lda, bfloat16_t* dst) {
+			for (std::size_t i = 0; i < n; ++i) {
+				if constexpr (std::is_same_v<Real, float>) {
+					from_float({a + i * lda, n}, {dst + i * n, n});
+				} else {
+					for (std::size_t j = 0; j < n; ++j) dst[i * n + j] = bfloat16_t(static_cast<float>(a[i * lda + j]));
+				}
+			}
+		}
+
+		// C[rows x cols] += A[rows x k] * B[k x cols] on bf16 C, A and C sharing ldc.
+		// neg_b holds -B, so the sum is A * (-B) + C through the residual epilogue.
+		inline void trailing_update(std::size_t rows, std::size_t cols, std::size_t k,
+				const bfloat16_t* a, const bfloat16_t* neg_b, std::size_t ldb, bfloat16_t* c, std::size_t ldc) {
+			gemm(rows, cols, k, a, ldc, neg_b, ldb, c, ldc, epilogue::residual{c, ldc});
+		}
+
+		// Unblocked LU with partial pivoting of an m x kb fp32 panel; pivots relative to the panel
+		inline bool lu_panel(std::size_t m, std::size_t kb, float* p, std::size_t* pivots) noexcept {
+			for (std::size_t j = 0; j < kb; ++j) {
+				std::size_t best = j;
+				for (std::size_t i = j + 1; i < m; ++i) {
+					if (std::abs(p[i * kb + j]) > std::abs(p[best * kb + j])) best = i;
+				}
+				// Also rejects NaN
+				if (!(std::abs(p[best * kb + j]) > 0.0f)) return false;
+				pivots[j] = best;
+				if (best != j) std::swap_ranges(p + j * kb, p + (j + 1) * kb, p + best * kb);
+
+				const float inv = 1.0f / p[j * kb + j];
+				for (std::size_t i = j + 1; i < m; ++i) {
+					float* row = p + i * kb;
+					const float l = row[j] *= inv;
+					for (std::size_t c = j + 1; c < kb; ++c) row[c] -= l * p[j * kb + c];
+				}
+			}
+			return true;
+		}
+
+		// Unblocked Cholesky of a kb x kb fp32 block (lower triangle)
+		inline bool cholesky_block(std::size_t kb, float* d) noexcept {
+			for (std::size_t j = 0; j < kb; ++j) {
+				float s = d[j * kb + j];
+				for (std::size_t p = 0; p < j; ++p) s -= d[j * kb + p] * d[j * kb + p];
+				if (!(s > 0.0f) || !std::isfinite(s)) return false;
+				const float ljj = std::sqrt(s);
+				d[j * kb + j] = ljj;
+				for (std::size_t i = j + 1; i < kb; ++i) {
+					float v = d[i * kb + j];
+					for (std::size_t p = 0; p < j; ++p) v -= d[i * kb + p] * d[j * kb + p];
+					d[i * kb + j] = v / ljj;
+				}
+			}
+			return true;
+		}
+
+		// r = b - A x in fp64; returns ||r||_inf and sets a_norm = ||A||_inf
+		template<solve_real Real>
+		double residual(std::size_t n, const Real* a, std::size_t lda, const Real* b,
+				const double* x, double* r, double& a_norm) {
+			const std::size_t tasks = (n + solve_rows - 1) / solve_rows;
+			std::vector<double> r_norm(tasks, 0.0), row_norm(tasks, 0.0);
+			parallel_for(tasks, [&](std::size_t t) {
+				const std::size_t i1 = std::min(n, (t + 1) * solve_rows);
+				for (std::size_t i = t * solve_rows; i < i1; ++i) {
+					const Real* row = a + i * lda;
+					double s = static_cast<double>(b[i]), abs_sum = 0.0;
+					for (std::size_t j = 0; j < n; ++j) {
+						s -= static_cast<double>(row[j]) * x[j];
+						abs_sum += std::abs(static_cast<double>(row[j]));
+					}
+					r[i] = s;
+					r_norm[t] = std::max(r_norm[t], std::abs(s));
+					row_norm[t] = std::max(row_norm[t], abs_sum);
+				}
+			});
+			a_norm = *std::max_element(row_norm.begin(), row_norm.end());
+			return *std::max_element(r_norm.begin(), r_norm.end());
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// bf16 LU of the n x n matrix a; nullopt if a pivot is zero or not finite
+	template<solve_real Real>
+	std::optional<lu_factorization> lu_factor(std::size_t n, const Real* a, std::size_t lda) {
+		using namespace detail;
+		lu_factorization f;
+		f.n = n;
+		f.lu.resize(n * n);
+		f.pivots.resize(n);
+		narrow_matrix(n, a, lda, f.lu.data());
+		bfloat16_t* lu = f.lu.data();
+
+		std::vector<float> panel;
+		std::vector<bfloat16_t> neg_u;
+		for (std::size_t k = 0; k < n; k += solve_nb) {
+			const std::size_t kb = std::min(solve_nb, n - k), m = n - k;
+
+			panel.resize(m * kb);
+			for (std::size_t i = 0; i < m; ++i) to_float({lu + (k + i) * n + k, kb}, {panel.data() + i * kb, kb});
+			if (!lu_panel(m, kb, panel.data(), f.pivots.data() + k)) return std::nullopt;
+			for (std::size_t i = 0; i < m; ++i) from_float({panel.data() + i * kb, kb}, {lu + (k + i) * n + k, kb});
+
+			// Replay the panel's row swaps on the columns left and right of it
+			for (std::size_t j = 0; j < kb; ++j) {
+				const std::size_t p = f.pivots[k + j] += k;
+				if (p == k + j) continue;
+				std::swap_ranges(lu + (k + j) * n, lu + (k + j) * n + k, lu + p * n);
+				std::swap_ranges(lu + (k + j) * n + k + kb, lu + (k + j + 1) * n, lu + p * n + k + kb);
+			}
+
+			const std::size_t nt = n - k - kb;
+			if (nt == 0) break;
+
+			// U12 = L11^-1 A12 in fp32, one column block per task
+			neg_u.resize(kb * nt);
+			parallel_for((nt + solve_cols - 1) / solve_cols, [&](std::size_t t) {
+				const std::size_t c0 = t * solve_cols, w = std::min(solve_cols, nt - c0);
+				std::vector<float> ws(kb * w);
+				for (std::size_t i = 0; i < kb; ++i) {
+					float* row = ws.data() + i * w;
+					to_float({lu + (k + i) * n + k + kb + c0, w}, {row, w});
+					for (std::size_t p = 0; p < i; ++p) {
+						const float l = panel[i * kb + p];
+						const float* up = ws.data() + p * w;
+						for (std::size_t j = 0; j < w; ++j) row[j] -= l * up[j];
+					}
+					bfloat16_t* dst = lu + (k + i) * n + k + kb + c0;
+					from_float({row, w}, {dst, w});
+					for (std::size_t j = 0; j < w; ++j) neg_u[i * nt + c0 + j] = -dst[j];
+				}
+			});
+
+			// A22 -= L21 U12
+			parallel_for((nt + solve_rows - 1) / solve_rows, [&](std::size_t t) {
+				const std::size_t r0 = k + kb + t * solve_rows, rows = std::min(solve_rows, n - r0);
+				trailing_update(rows, nt, kb, lu + r0 * n + k, neg_u.data(), nt, lu + r0 * n + k + kb, n);
+			});
+		}
+		return f;
+	}
+
+	// bf16 Cholesky of the symmetric positive definite n x n matrix a (lower
+	// triangle read); nullopt if a pivot is not positive
+	template<solve_real Real>
+	std::optional<cholesky_factorization> cholesky_factor(std::size_t n, const Real* a, std::size_t lda) {
+		using namespace detail;
+		cholesky_factorization f;
+		f.n = n;
+		f.l.resize(n * n);
+		narrow_matrix(n, a, lda, f.l.data());
+		bfloat16_t* l = f.l.data();
+
+		std::vector<float> d;
+		std::vector<bfloat16_t> neg_lt;
+		for (std::size_t k = 0; k < n; k += solve_nb) {
+			const std::size_t kb = std::min(solve_nb, n - k);
+
+			d.assign(kb * kb, 0.0f);
+			for (std::size_t i = 0; i < kb; ++i) to_float({l + (k + i) * n + k, i + 1}, {d.data() + i * kb, i + 1});
+			if (!cholesky_block(kb, d.data())) return std::nullopt;
+			for (std::size_t i = 0; i < kb; ++i) from_float({d.data() + i * kb, i + 1}, {l + (k + i) * n + k, i + 1});
+
+			const std::size_t m2 = n - k - kb;
+			if (m2 == 0) break;
+
+			// L21 = A21 L11^-T row by row; neg_lt = -L21^T feeds the trailing gemm
+			neg_lt.resize(kb * m2);
+			parallel_for((m2 + solve_rows - 1) / solve_rows, [&](std::size_t t) {
+				const std::size_t i1 = std::min(m2, (t + 1) * solve_rows);
+				float x[solve_nb];
+				for (std::size_t i = t * solve_rows; i < i1; ++i) {
+					bfloat16_t* row = l + (k + kb + i) * n + k;
+					to_float({row, kb}, {x, kb});
+					for (std::size_t j = 0; j < kb; ++j) {
+						float v = x[j];
+						for (std::size_t p = 0; p < j; ++p) v -= x[p] * d[j * kb + p];
+						x[j] = v / d[j * kb + j];
+					}
+					from_float({x, kb}, {row, kb});
+					for (std::size_t j = 0; j < kb; ++j) neg_lt[j * m2 + i] = -row[j];
+				}
+			});
+
+			// Lower part of A22 -= L21 L21^T; the widest (last) row blocks go first
+			const std::size_t tasks = (m2 + solve_rows - 1) / solve_rows;
+			parallel_for(tasks, [&](std::size_t t) {
+				const std::size_t i0 = (tasks - 1 - t) * solve_rows, i1 = std::min(m2, i0 + solve_rows);
+				bfloat16_t* c = l + (k + kb + i0) * n + k + kb;
+				trailing_update(i1 - i0, i1, kb, l + (k + kb + i0) * n + k, neg_lt.data(), m2, c, n);
+			});
+		}
+
+		for (std::size_t i = 0; i < n; ++i) std::fill(l + i * n + i + 1, l + (i + 1) * n, bfloat16_t{});
+		return f;
+	}
+
+	// b = A^-1 b in fp32 using the bf16 factors
+	inline void lu_solve(const lu_factorization& f, std::span<float> b) noexcept {
+		const std::size_t n = f.n;
+		assert(b.size() >= n);
+		const bfloat16_t* lu = f.lu.data();
+		for (std::size_t j = 0; j < n; ++j) std::swap(b[j], b[f.pivots[j]]);
+		for (std::size_t i = 1; i < n; ++i) b[i] -= detail::row_dot(lu + i * n, b.data(), i);
+		for (std::size_t i = n; i-- > 0;) {
+			const bfloat16_t* row = lu + i * n;
+			b[i] = (b[i] - detail::row_dot(row + i + 1, b.data() + i + 1, n - i - 1)) / detail::widen(row[i]);
+		}
+	}
+
+	inline void cholesky_solve(const cholesky_factorization& f, std::span<float> b) noexcept {
+		const std::size_t n = f.n;
+		assert(b.size() >= n);
+		const bfloat16_t* l = f.l.data();
+		for (std::size_t i = 0; i < n; ++i) {
+			b[i] = (b[i] - detail::row_dot(l + i * n, b.data(), i)) / detail::widen(l[i * n + i]);
+		}
+		// L^T x = y: row i of L is column i of L^T
+		for (std::size_t i = n; i-- > 0;) {
+			b[i] /= detail::widen(l[i * n + i]);
+			detail::axpy_row(-b[i], l + i * n, i, b.data());
+		}
+	}
+
+	// Refine x = A^-1 b starting from the bf16-factor solve, until the backward
+	// error reaches sqrt(n) * epsilon<Real>, stops improving, or max_iterations
+	// corrections have been applied
+	template<solve_real Real, typename Factorization>
+		requires std::is_same_v<Factorization, lu_factorization> || std::is_same_v<Factorization, cholesky_factorization>
+	refinement_result refine(const Factorization& f, const Real* a, std::size_t lda,
+			std::span<const Real> b, std::span<Real> x, std::size_t max_iterations = 10) {
+		const std::size_t n = f.n;
+		assert(b.size() >= n && x.size() >= n);
+		if (n == 0) return {0, 0.0, true};
+		const auto solve = [&](std::span<float> v) {
+			if constexpr (std::is_same_v<Factorization, lu_factorization>) lu_solve(f, v);
+			else cholesky_solve(f, v);
+		};
+
+		std::vector<float> d(n);
+		std::vector<double> xd(n), r(n);
+		for (std::size_t i = 0; i < n; ++i) d[i] = static_cast<float>(b[i]);
+		solve(d);
+		std::copy(d.begin(), d.end(), xd.begin());
+
+		double b_norm = 0.0;
+		for (std::size_t i = 0; i < n; ++i) b_norm = std::max(b_norm, std::abs(static_cast<double>(b[i])));
+		const double tolerance = std::sqrt(static_cast<double>(std::max<std::size_t>(n, 1))) * std::numeric_limits<Real>::epsilon();
+
+		refinement_result result;
+		std::vector<double> best = xd;
+		double best_error = std::numeric_limits<double>::infinity();
+		for (;;) {
+			double a_norm = 0.0;
+			const double r_norm = detail::residual(n, a, lda, b.data(), xd.data(), r.data(), a_norm);
+			double x_norm = 0.0;
+			for (double v : xd) x_norm = std::max(x_norm, std::abs(v));
+			const double denom = a_norm * x_norm + b_norm;
+			const double error = denom > 0.0 ? r_norm / denom : 0.0;
+
+			// Keep the best iterate; a correction that does not halve the error means stagnation
+			const bool improving = error < 0.5 * best_error;
+			if (error < best_error) {
+				best_error = error;
+				best = xd;
+			}
+			if (error <= tolerance) {
+				result.converged = true;
+				break;
+			}
+			if (!improving || result.iterations == max_iterations) break;
+
+			for (std::size_t i = 0; i < n; ++i) d[i] = static_cast<float>(r[i]);
+			solve(d);
+			for (std::size_t i = 0; i < n; ++i) xd[i] += d[i];
+			++result.iterations;
+		}
+
+		result.backward_error = best_error;
+		for (std::size_t i = 0; i < n; ++i) x[i] = static_cast<Real>(best[i]);
+		return result;
+	}
+
+	// x = A^-1 b from a bf16 LU of A plus iterative refinement; a failed
+	// factorization returns converged = false with an infinite backward error
+	template<solve_real Real>
+	refinement_result solve_lu(std::size_t n, const Real* a, std::size_t lda,
+			std::span<const Real> b, std::span<Real> x, std::size_t max_iterations = 10) {
+		const auto f = lu_factor(n, a, lda);
+		if (!f) return {0, std::numeric_limits<double>::infinity(), false};
+		return refine(*f, a, lda, b, x, max_iterations);
+	}
+
+	// Same for symmetric positive definite A with a bf16 Cholesky factor. The
+	// factorization reads the lower triangle; the residuals use all of a.
+	template<solve_real Real>
+	refinement_result solve_cholesky(std::size_t n, const Real* a, std::size_t lda,
+			std::span<const Real> b, std::span<Real> x, std::size_t max_iterations = 10) {
+		const auto f = cholesky_factor(n, a, lda);
+		if (!f) return {0, std::numeric_limits<double>::infinity(), false};
+		return refine(*f, a, lda, b, x, max_iterations);
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
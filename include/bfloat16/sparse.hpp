@@ -0,0 +1,281 @@
+/**
+ * @file sparse.hpp
+ * @brief CSR and block-sparse (BSR) matrices of bfloat16_t with SpMV / SpMM
+ *
+ * Values are stored as bfloat16_t and indices as uint32_t. Products accumulate
+ * in fp32 and are spread over threads in contiguous row ranges that carry a
+ * roughly equal number of stored values, not an equal number of rows.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_SPARSE_HPP
+#define BFLOAT16_SPARSE_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/parallel.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace bf16 {
+
+	struct csr_matrix {
+		std::size_t rows = 0;
+		std::size_t cols = 0;
+		std::vector<uint32_t> row_ptr;   // rows + 1 entries
+		std::vector<uint32_t> col_idx;   // nnz entries, increasing within a row
+		std::vector<bfloat16_t> values;  // nnz entries
+
+		std::size_t nnz() const noexcept { return values.size(); }
+
+		// Keep every non-zero of a dense row-major matrix
+		static csr_matrix from_dense(std::size_t rows, std::size_t cols, const bfloat16_t* a, std::size_t lda) {
+			csr_matrix m;
+			m.rows = rows;
+			m.cols = cols;
+			m.row_ptr.reserve(rows + 1);
+			m.row_ptr.push_back(0);
+			for (std::size_t i = 0; i < rows; ++i) {
+				for (std::size_t j = 0; j < cols; ++j) {
+					const bfloat16_t v = a[i * lda + j];
+					if (!v.is_zero()) {
+						m.col_idx.push_back(static_cast<uint32_t>(j));
+						m.values.push_back(v);
+					}
+				}
+				m.row_ptr.push_back(static_cast<uint32_t>(m.values.size()));
+			}
+			return m;
+		}
+	};
+
+	// Block-sparse matrix of R x C dense blocks. Block rows/columns past the
+	// matrix edge are zero padded; each block is stored row-major.
+	template<std::size_t R, std::size_t C>
+	struct bsr_matrix {
+		static constexpr std::size_t block_rows = R;
+		static constexpr std::size_t block_cols = C;
+
+		std::size_t rows = 0;
+		std::size_t cols = 0;
+		std::vector<uint32_t> block_row_ptr;  // ceil(rows / R) + 1 entries
+		std::vector<uint32_t> block_col_idx;  // one per stored block
+		std::vector<bfloat16_t> values;       // R * C per stored block
+
+		std::size_t blocks() const noexcept { return block_col_idx.size(); }
+
+		// Keep every block that holds at least one non-zero
+		static bsr_matrix from_dense(std::size_t rows, std::size_t cols, const bfloat16_t* a, std::size_t lda) {
+			bsr_matrix m;
+			m.rows = rows;
+			m.cols = cols;
+			const std::size_t brows = (rows + R - 1) / R, bcols = (cols + C - 1) / C;
+			m.block_row_ptr.reserve(brows + 1);
+			m.block_row_ptr.push_back(0);
+			for (std::size_t bi = 0; bi < brows; ++bi) {
+				for (std::size_t bj = 0; bj < bcols; ++bj) {
+					bfloat16_t block[R * C] = {};
+					bool any = false;
+					for (std::size_t r = 0; r < R && bi * R + r < rows; ++r) {
+						for (std::size_t c = 0; c < C && bj * C + c < cols; ++c) {
+							block[r * C + c] = a[(bi * R + r) * lda + bj * C + c];
+							any = any || !block[r * C + c].is_zero();
+						}
+					}
+					if (any) {
+						m.block_col_idx.push_back(static_cast<uint32_t>(bj));
+						m.values.insert(m.values.end(), block, block + R * C);
+					}
+				}
+				m.block_row_ptr.push_back(static_cast<uint32_t>(m.block_col_idx.size()));
+			}
+			return m;
+		}
+	};
+
+	using bsr1x8_matrix = bsr_matrix<1, 8>;
+	using bsr4x4_matrix = bsr_matrix<4, 4>;
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		// Rows below this many stored values per thread are not worth a thread
+		inline constexpr std::size_t sparse_grain = 16384;
+
+		// Run fn(first_row, last_row) over ranges balanced by the prefix sum
+		template<typename Fn>
+		void for_each_row_range(std::span<const uint32_t> row_ptr, Fn&& fn) {
+			const std::size_t work = row_ptr.empty() ? 0 : row_ptr.back();
+			const std::size_t parts = std::max<std::size_t>(1, std::min(get_num_threads(), work / sparse_grain));
+			const auto bounds = partition_by_weight(row_ptr, parts);
+			parallel_for(bounds.size() - 1, [&](std::size_t t) { fn(bounds[t], bounds[t + 1]); });
+		}
+
+		inline float csr_row_dot(const uint32_t* idx, const bfloat16_t* val, std::size_t len, const float* x) noexcept {
+			std::size_t k = 0;
+			float sum = 0.0f;
+#if defined(BF16_HAVE_AVX512)
+			__m512 acc = _mm512_setzero_ps();
+			for (; k < len; k += 16) {
+				const __mmask16 m = tail_mask16(len - k);
+				const __m512i ci = _mm512_maskz_loadu_epi32(m, idx + k);
+				const __m512 xv = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), m, ci, x, 4);
+				acc = _mm512_fmadd_ps(maskz_load16(val + k, m), xv, acc);
+			}
+			sum = hsum16(acc);
+#elif defined(BF16_HAVE_AVX2)
+			__m256 acc = _mm256_setzero_ps();
+			for (; k + 8 <= len; k += 8) {
+				const __m256i ci = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + k));
+				acc = _mm256_fmadd_ps(load8(val + k), _mm256_i32gather_ps(x, ci, 4), acc);
+			}
+			sum = hsum8(acc);
+#endif
+			for (; k < len; ++k) {
+				sum += widen(val[k]) * x[idx[k]];
+			}
+			return sum;
+		}
+
+		// c[0:n] += v * b[0:n]
+		inline void axpy_row(float v, const bfloat16_t* b, std::size_t n, float* c) noexcept {
+			std::size_t j = 0;
+#if defined(BF16_HAVE_AVX512)
+			const __m512 vv = _mm512_set1_ps(v);
+			for (; j + 16 <= n; j += 16) {
+				_mm512_storeu_ps(c + j, _mm512_fmadd_ps(vv, load16(b + j), _mm512_loadu_ps(c + j)));
+			}
+			if (j < n) {
+				const __mmask16 m = tail_mask16(n - j);
+				_mm512_mask_storeu_ps(c + j, m, _mm512_fmadd_ps(vv, maskz_load16(b + j, m), _mm512_maskz_loadu_ps(m, c + j)));
+				j = n;
+			}
+#elif defined(BF16_HAVE_AVX2)
+			const __m256 vv = _mm256_set1_ps(v);
+			for (; j + 8 <= n; j += 8) {
+				_mm256_storeu_ps(c + j, _mm256_fmadd_ps(vv, load8(b + j), _mm256_loadu_ps(c + j)));
+			}
+#endif
+			for (; j < n; ++j) {
+				c[j] += v * widen(b[j]);
+			}
+		}
+
+		// acc[0:R] += block[R x C] * x[0:C]
+		template<std::size_t R, std::size_t C>
+		inline void bsr_block_gemv(const bfloat16_t* block, const float* x, float* acc) noexcept {
+#if defined(BF16_HAVE_AVX2)
+			if constexpr (R == 1 && C == 8) {
+				const __m256 p = _mm256_mul_ps(load8(block), _mm256_loadu_ps(x));
+				acc[0] += hsum8(p);
+				return;
+			}
+#endif
+#if defined(BF16_HAVE_AVX512)
+			if constexpr (R == 4 && C == 4) {
+				// One register holds the whole block; x repeats in every 128-bit lane
+				const __m512 p = _mm512_mul_ps(load16(block), _mm512_maskz_broadcast_f32x4(full16, _mm_loadu_ps(x)));
+				alignas(64) float lanes[16];
+				_mm512_store_ps(lanes, p);
+				for (std::size_t r = 0; r < 4; ++r) {
+					acc[r] += (lanes[4 * r] + lanes[4 * r + 1]) + (lanes[4 * r + 2] + lanes[4 * r + 3]);
+				}
+				return;
+			}
+#endif
+			for (std::size_t r = 0; r < R; ++r) {
+				float s = 0.0f;
+				for (std::size_t c = 0; c < C; ++c) {
+					s += widen(block[r * C + c]) * x[c];
+				}
+				acc[r] += s;
+			}
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// y = A * x
+	inline void spmv(const csr_matrix& a, std::span<const bfloat16_t> x, std::span<float> y) {
+		assert(x.size() >= a.cols && y.size() >= a.rows);
+		std::vector<float> xf(a.cols);
+		to_float(x.first(a.cols), xf);
+
+		detail::for_each_row_range(a.row_ptr, [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i) {
+				const uint32_t begin = a.row_ptr[i], end = a.row_ptr[i + 1];
+				y[i] = detail::csr_row_dot(a.col_idx.data() + begin, a.values.data() + begin, end - begin, xf.data());
+			}
+		});
+	}
+
+	template<std::size_t R, std::size_t C>
+	void spmv(const bsr_matrix<R, C>& a, std::span<const bfloat16_t> x, std::span<float> y) {
+		assert(x.size() >= a.cols && y.size() >= a.rows);
+		const std::size_t bcols = (a.cols + C - 1) / C;
+		std::vector<float> xf(bcols * C, 0.0f);
+		to_float(x.first(a.cols), xf);
+
+		detail::for_each_row_range(a.block_row_ptr, [&](std::size_t first, std::size_t last) {
+			for (std::size_t bi = first; bi < last; ++bi) {
+				float acc[R] = {};
+				for (uint32_t b = a.block_row_ptr[bi]; b < a.block_row_ptr[bi + 1]; ++b) {
+					detail::bsr_block_gemv<R, C>(a.values.data() + b * R * C, xf.data() + a.block_col_idx[b] * C, acc);
+				}
+				for (std::size_t r = 0; r < R && bi * R + r < a.rows; ++r) {
+					y[bi * R + r] = acc[r];
+				}
+			}
+		});
+	}
+
+	// C[rows x n] = A * B[cols x n]; B and C row-major
+	inline void spmm(const csr_matrix& a, std::size_t n, const bfloat16_t* b, std::size_t ldb, float* c, std::size_t ldc) {
+		detail::for_each_row_range(a.row_ptr, [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i) {
+				float* crow = c + i * ldc;
+				std::fill(crow, crow + n, 0.0f);
+				for (uint32_t k = a.row_ptr[i]; k < a.row_ptr[i + 1]; ++k) {
+					detail::axpy_row(detail::widen(a.values[k]), b + a.col_idx[k] * ldb, n, crow);
+				}
+			}
+		});
+	}
+
+	template<std::size_t R, std::size_t C>
+	void spmm(const bsr_matrix<R, C>& a, std::size_t n, const bfloat16_t* b, std::size_t ldb, float* c, std::size_t ldc) {
+		detail::for_each_row_range(a.block_row_ptr, [&](std::size_t first, std::size_t last) {
+			for (std::size_t bi = first; bi < last; ++bi) {
+				const std::size_t rn = std::min(R, a.rows - bi * R);
+				for (std::size_t r = 0; r < rn; ++r) std::fill(c + (bi * R + r) * ldc, c + (bi * R + r) * ldc + n, 0.0f);
+
+				for (uint32_t blk = a.block_row_ptr[bi]; blk < a.block_row_ptr[bi + 1]; ++blk) {
+					const bfloat16_t* v = a.values.data() + blk * R * C;
+					const std::size_t col0 = a.block_col_idx[blk] * C;
+					const std::size_t cn = std::min(C, a.cols - col0);
+					for (std::size_t r = 0; r < rn; ++r) {
+						for (std::size_t cc = 0; cc < cn; ++cc) {
+							const float w = detail::widen(v[r * C + cc]);
+							if (w != 0.0f) detail::axpy_row(w, b + (col0 + cc) * ldb, n, c + (bi * R + r) * ldc);
+						}
+					}
+				}
+			}
+		});
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
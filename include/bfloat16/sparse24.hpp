@@ -0,0 +1,209 @@
+/**
+ * @file sparse24.hpp
+ * @brief 2:4 structured-sparse bfloat16_t matrices and products on the compressed form
+ *
+ * Every group of four consecutive columns keeps two values. A row of `cols`
+ * columns is stored as cols / 2 values plus cols / 8 metadata bytes; each
+ * nibble describes one group as two 2-bit column offsets (first | second << 2,
+ * first < second). Column counts are padded to a multiple of 8 with zeros.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_SPARSE24_HPP
+#define BFLOAT16_SPARSE24_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/parallel.hpp>
+#include <bfloat16/sparse.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace bf16 {
+
+	struct sparse24_matrix {
+		std::size_t rows = 0;
+		std::size_t cols = 0;
+		std::vector<bfloat16_t> values;  // rows * padded_cols() / 2
+		std::vector<uint8_t> meta;       // rows * padded_cols() / 8
+
+		constexpr std::size_t padded_cols() const noexcept { return (cols + 7) / 8 * 8; }
+		constexpr std::size_t values_per_row() const noexcept { return padded_cols() / 2; }
+		constexpr std::size_t meta_per_row() const noexcept { return padded_cols() / 8; }
+	};
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		// Column offset (0-3) of kept value v of group g in a metadata row
+		inline unsigned sparse24_offset(const uint8_t* meta, std::size_t g, unsigned v) noexcept {
+			return (meta[g / 2] >> ((g % 2) * 4 + v * 2)) & 3u;
+		}
+
+		// Nibble (two 2-bit offsets) -> 4-bit mask of kept columns
+		inline constexpr std::array<uint8_t, 16> sparse24_nibble_mask = [] {
+			std::array<uint8_t, 16> t{};
+			for (unsigned n = 0; n < 16; ++n) t[n] = static_cast<uint8_t>((1u << (n & 3)) | (1u << (n >> 2)));
+			return t;
+		}();
+
+		inline float sparse24_row_dot(const bfloat16_t* vals, const uint8_t* meta, std::size_t padded_cols, const float* x) noexcept {
+			std::size_t c = 0;
+			float sum = 0.0f;
+#if defined(BF16_HAVE_AVX512)
+			// 32 columns / 16 kept values per step. The 2-bit offsets become lane
+			// indices into the two x registers and one permute gathers the operands.
+			const __m512i shifts = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+			const __m512i base = _mm512_setr_epi32(0, 0, 4, 4, 8, 8, 12, 12, 16, 16, 20, 20, 24, 24, 28, 28);
+			__m512 acc = _mm512_setzero_ps();
+			for (; c < padded_cols; c += 32) {
+				const std::size_t remaining = padded_cols - c;
+				uint32_t word = 0;
+				std::memcpy(&word, meta + c / 8, std::min<std::size_t>(4, remaining / 8));
+				const __m512i fields = _mm512_and_si512(_mm512_maskz_srlv_epi32(full16, _mm512_set1_epi32(static_cast<int>(word)), shifts), _mm512_set1_epi32(3));
+				const __m512i lanes = _mm512_add_epi32(fields, base);
+				const __mmask16 m = tail_mask16(remaining / 2);
+				const __mmask16 lo = tail_mask16(remaining);
+				const __mmask16 hi = remaining > 16 ? tail_mask16(remaining - 16) : 0;
+				const __m512 xv = _mm512_permutex2var_ps(_mm512_maskz_loadu_ps(lo, x + c), lanes, _mm512_maskz_loadu_ps(hi, x + c + 16));
+				acc = _mm512_fmadd_ps(maskz_load16(vals + c / 2, m), xv, acc);
+			}
+			sum = hsum16(acc);
+#endif
+			for (; c < padded_cols; c += 4) {
+				const std::size_t g = c / 4;
+				sum += widen(vals[2 * g]) * x[c + sparse24_offset(meta, g, 0)]
+					+ widen(vals[2 * g + 1]) * x[c + sparse24_offset(meta, g, 1)];
+			}
+			return sum;
+		}
+
+		// Run fn(first_row, last_row) over equal row ranges, one per sparse_grain
+		// of work up to the thread count; every row costs the same
+		template<typename Fn>
+		void for_each_sparse24_rows(std::size_t rows, std::size_t work, Fn&& fn) {
+			const std::size_t parts = std::clamp<std::size_t>(std::min(get_num_threads(), work / sparse_grain), 1, std::max<std::size_t>(rows, 1));
+			parallel_for(parts, [&](std::size_t t) { fn(rows * t / parts, rows * (t + 1) / parts); });
+		}
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	// Compress a dense row-major matrix. Each group keeps its two largest-magnitude
+	// entries, so input that already satisfies 2:4 sparsity round-trips exactly.
+	inline sparse24_matrix pack_sparse24(std::size_t rows, std::size_t cols, const bfloat16_t* a, std::size_t lda) {
+		sparse24_matrix m;
+		m.rows = rows;
+		m.cols = cols;
+		const std::size_t pc = m.padded_cols();
+		m.values.resize(rows * m.values_per_row());
+		m.meta.assign(rows * m.meta_per_row(), 0);
+
+		for (std::size_t i = 0; i < rows; ++i) {
+			bfloat16_t* vals = m.values.data() + i * m.values_per_row();
+			uint8_t* meta = m.meta.data() + i * m.meta_per_row();
+			for (std::size_t g = 0; g < pc / 4; ++g) {
+				bfloat16_t group[4] = {};
+				for (std::size_t j = 0; j < 4 && 4 * g + j < cols; ++j) group[j] = a[i * lda + 4 * g + j];
+
+				unsigned first = 0, second = 1;
+				auto magnitude = [&](unsigned j) { return static_cast<float>(abs(group[j])); };
+				for (unsigned j = 1; j < 4; ++j) {
+					if (magnitude(j) > magnitude(first)) first = j;
+				}
+				second = first == 0 ? 1 : 0;
+				for (unsigned j = 0; j < 4; ++j) {
+					if (j != first && magnitude(j) > magnitude(second)) second = j;
+				}
+				if (first > second) std::swap(first, second);
+
+				vals[2 * g] = group[first];
+				vals[2 * g + 1] = group[second];
+				meta[g / 2] |= static_cast<uint8_t>((first | (second << 2)) << ((g % 2) * 4));
+			}
+		}
+		return m;
+	}
+
+	// Expand back into a dense row-major matrix (dropped entries become zero)
+	inline void unpack_sparse24(const sparse24_matrix& m, bfloat16_t* dst, std::size_t ldd) noexcept {
+		const std::size_t pc = m.padded_cols();
+		for (std::size_t i = 0; i < m.rows; ++i) {
+			const bfloat16_t* vals = m.values.data() + i * m.values_per_row();
+			const uint8_t* meta = m.meta.data() + i * m.meta_per_row();
+			bfloat16_t* row = dst + i * ldd;
+			std::size_t c = 0;
+#if defined(BF16_HAVE_AVX512VBMI2)
+			// vpexpandw scatters the 16 packed values of 32 columns to their kept
+			// lanes; the last block reads only its own groups and stores to cols
+			for (; c < m.cols; c += 32) {
+				const std::size_t groups = std::min<std::size_t>(8, (pc - c) / 4);
+				uint32_t keep = 0;
+				for (std::size_t g = 0; g < groups; ++g) {
+					const unsigned nibble = (meta[(c / 4 + g) / 2] >> (((c / 4 + g) % 2) * 4)) & 0xF;
+					keep |= static_cast<uint32_t>(detail::sparse24_nibble_mask[nibble]) << (4 * g);
+				}
+				_mm512_mask_storeu_epi16(row + c, detail::tail_mask32(m.cols - c), _mm512_maskz_expandloadu_epi16(keep, vals + c / 2));
+			}
+			c = pc;
+#endif
+			for (; c < pc; c += 4) {
+				const std::size_t g = c / 4;
+				bfloat16_t group[4] = {};
+				group[detail::sparse24_offset(meta, g, 0)] = vals[2 * g];
+				group[detail::sparse24_offset(meta, g, 1)] = vals[2 * g + 1];
+				for (std::size_t j = 0; j < 4 && c + j < m.cols; ++j) row[c + j] = group[j];
+			}
+		}
+	}
+
+	// y[rows] = W * x[cols], reading only the compressed values
+	inline void gemv(const sparse24_matrix& w, std::span<const bfloat16_t> x, std::span<float> y) {
+		assert(x.size() >= w.cols && y.size() >= w.rows);
+		std::vector<float> xf(w.padded_cols(), 0.0f);
+		to_float(x.first(w.cols), xf);
+
+		detail::for_each_sparse24_rows(w.rows, w.rows * w.values_per_row(), [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i) {
+				y[i] = detail::sparse24_row_dot(w.values.data() + i * w.values_per_row(),
+					w.meta.data() + i * w.meta_per_row(), w.padded_cols(), xf.data());
+			}
+		});
+	}
+
+	// C[rows x n] = W * B[cols x n]; B and C row-major
+	inline void gemm(const sparse24_matrix& w, std::size_t n, const bfloat16_t* b, std::size_t ldb, float* c, std::size_t ldc) {
+		detail::for_each_sparse24_rows(w.rows, w.rows * w.values_per_row() * n, [&](std::size_t first, std::size_t last) {
+			for (std::size_t i = first; i < last; ++i) {
+				const bfloat16_t* vals = w.values.data() + i * w.values_per_row();
+				const uint8_t* meta = w.meta.data() + i * w.meta_per_row();
+				float* crow = c + i * ldc;
+				std::fill(crow, crow + n, 0.0f);
+				for (std::size_t g = 0; g < w.padded_cols() / 4; ++g) {
+					for (unsigned v = 0; v < 2; ++v) {
+						const float wv = detail::widen(vals[2 * g + v]);
+						const std::size_t col = 4 * g + detail::sparse24_offset(meta, g, v);
+						if (wv != 0.0f && col < w.cols) detail::axpy_row(wv, b + col * ldb, n, crow);
+					}
+				}
+			}
+		});
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
@@ -0,0 +1,322 @@
+/**
+ * @file split.hpp
+ * @brief Exact three-term bf16 splits of float, and fp32-accurate GEMM built from bf16 products
+ *
+ * split(x) returns hi + mid + lo == x exactly: hi is bfloat16_t(x), mid the
+ * rounded remainder and lo what is left, which always fits in 8 bits. (Splits
+ * of values below about 2^-110 lose bits to bf16 subnormals; non-finite x
+ * give hi = bfloat16_t(x) and zero mid and lo.)
+ *
+ * The float GEMM multiplies the splits of A and B: bf16x3 sums
+ * hi*hi + hi*mid + mid*hi, bf16x6 adds mid*mid + hi*lo + lo*hi. Every product
+ * of two bf16 terms is exact in fp32, so only the dropped terms and the fp32
+ * accumulation cost accuracy: bf16x3 is within a few units of 2^-16 of the
+ * exact result and bf16x6 is on par with an fp32 GEMM. The passes are
+ * accumulated smallest first. With AVX-512 BF16 they run on vdpbf16ps, two
+ * products per lane per instruction. Elsewhere they run on the widening bf16
+ * GEMM, which is exact but slower than a plain fp32 GEMM.
+ *
+ * vdpbf16ps treats subnormal inputs as zero and flushes subnormal products
+ * to zero, whatever MXCSR says, so products of split terms must stay above
+ * 2^-126. The GEMM therefore scales each row of A and each column of B by a
+ * power of two that brings its largest magnitude into [0.5, 1) before
+ * splitting, and scales C back: the scaling is exact, and every tier gives
+ * the bf16x3/bf16x6 accuracy for tiny operands too.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_SPLIT_HPP
+#define BFLOAT16_SPLIT_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/gemm.hpp>
+#include <bfloat16/layout.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace bf16 {
+
+	struct split_terms {
+		bfloat16_t hi;
+		bfloat16_t mid;
+		bfloat16_t lo;
+	};
+
+	// Number of bf16 products per element of the float GEMM
+	enum class split_passes : uint8_t { three = 3, six = 6 };
+
+	namespace detail {
+
+		BF16_ISA_BEGIN
+
+		inline void split_kernel(const float* x, std::size_t n, bfloat16_t* hi, bfloat16_t* mid, bfloat16_t* lo) noexcept {
+			std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+			const __m512i exponent = _mm512_set1_epi32(0x7F800000);
+			const __m512i upper = _mm512_set1_epi32(static_cast<int>(0xFFFF0000u));
+			const __m512i half = _mm512_set1_epi32(0x7FFF);
+			for (; i < n; i += 16) {
+				const __mmask16 m = tail_mask16(n - i);
+				const __m512 v = _mm512_maskz_loadu_ps(m, x + i);
+				const __m512i xb = _mm512_castps_si512(v);
+				const __mmask16 finite = _mm512_cmpneq_epi32_mask(_mm512_and_si512(xb, exponent), exponent);
+				__m512i hb = _mm512_and_si512(_mm512_add_epi32(xb, half), upper);
+				const __mmask16 overflow = _mm512_mask_cmpeq_epi32_mask(finite, _mm512_and_si512(hb, exponent), exponent);
+				hb = _mm512_mask_and_epi32(hb, overflow, xb, upper);
+				const __m512 h = _mm512_castsi512_ps(hb);
+				const __m512 r1 = _mm512_maskz_sub_ps(finite, v, h);
+				const __m512 md = _mm512_castsi512_ps(_mm512_and_si512(_mm512_add_epi32(_mm512_castps_si512(r1), half), upper));
+				const __m512 r2 = _mm512_sub_ps(r1, md);
+				mask_store16(hi + i, m, h);
+				mask_store16(mid + i, m, md);
+				mask_store16(lo + i, m, r2);
+			}
+			i = n;
+#elif defined(BF16_HAVE_AVX2)
+			const __m256i exponent = _mm256_set1_epi32(0x7F800000);
+			const __m256i upper = _mm256_set1_epi32(static_cast<int>(0xFFFF0000u));
+			const __m256i half = _mm256_set1_epi32(0x7FFF);
+			for (; i + 8 <= n; i += 8) {
+				const __m256 v = _mm256_loadu_ps(x + i);
+				const __m256i xb = _mm256_castps_si256(v);
+				const __m256i nonfinite = _mm256_cmpeq_epi32(_mm256_and_si256(xb, exponent), exponent);
+				__m256i hb = _mm256_and_si256(_mm256_add_epi32(xb, half), upper);
+				const __m256i overflow = _mm256_andnot_si256(nonfinite, _mm256_cmpeq_epi32(_mm256_and_si256(hb, exponent), exponent));
+				hb = _mm256_blendv_epi8(hb, _mm256_and_si256(xb, upper), overflow);
+				const __m256 h = _mm256_castsi256_ps(hb);
+				const __m256 r1 = _mm256_andnot_ps(_mm256_castsi256_ps(nonfinite), _mm256_sub_ps(v, h));
+				const __m256 md = _mm256_castsi256_ps(_mm256_and_si256(_mm256_add_epi32(_mm256_castps_si256(r1), half), upper));
+				store8(hi + i, h);
+				store8(mid + i, md);
+				store8(lo + i, _mm256_sub_ps(r1, md));
+			}
+#endif
+			for (; i < n; ++i) {
+				const uint32_t xb = std::bit_cast<uint32_t>(x[i]);
+				const uint32_t hb = leading_bits(xb);
+				const float r1 = (xb & 0x7F800000u) != 0x7F800000u ? x[i] - std::bit_cast<float>(hb) : 0.0f;
+				hi[i] = bfloat16_t::from_bits(static_cast<uint16_t>(hb >> 16));
+				mid[i] = narrow(r1);
+				lo[i] = narrow(r1 - widen(mid[i]));
+			}
+		}
+
+		// Exponent e with 2^-e * max in [0.5, 1), held to +-126 so 2^-e is a
+		// normal float; 0 for zero or non-finite max
+		inline int split_exponent(float max) noexcept {
+			if (max == 0.0f || !std::isfinite(max)) return 0;
+			int e = 0;
+			std::frexp(max, &e);
+			return std::clamp(e, -126, 126);
+		}
+
+		// The (A term, B term) products of each mode, smallest first; 0 = hi, 1 = mid, 2 = lo
+		inline constexpr std::pair<int, int> split_products3[] = {{1, 0}, {0, 1}, {0, 0}};
+		inline constexpr std::pair<int, int> split_products6[] = {{2, 0}, {0, 2}, {1, 1}, {1, 0}, {0, 1}, {0, 0}};
+
+#if defined(BF16_HAVE_AVX512BF16)
+		inline constexpr std::size_t split_mr = 6;
+		inline constexpr std::size_t split_nr = 32;
+		inline constexpr std::size_t split_mc = 16 * split_mr;
+		inline constexpr std::size_t split_kc = 512;
+		inline constexpr std::size_t split_nc = 1024;
+
+		// Pack a (kc x nc) block of B (kc even) into nr-column panels of row
+		// pairs, panel[(p / 2) * 2 * nr + 2 * j + p % 2], zero past the last column
+		inline void pack_b_pairs(std::size_t kc, std::size_t nc, const bfloat16_t* b, std::size_t ldb, bfloat16_t* dst) noexcept {
+			for (std::size_t j0 = 0; j0 < nc; j0 += split_nr) {
+				const std::size_t cols = std::min(split_nr, nc - j0);
+				for (std::size_t p = 0; p < kc; p += 2) {
+					bfloat16_t* out = dst + p * split_nr;
+					interleave_rows(b + p * ldb + j0, b + (p + 1) * ldb + j0, cols, out);
+					std::fill(out + 2 * cols, out + 2 * split_nr, bfloat16_t());
+				}
+				dst += split_nr * kc;
+			}
+		}
+
+		// C[Rows x cols] += A[Rows x kc] * panel, A row-major with kc even
+		template<std::size_t Rows>
+		inline void split_micro_kernel(std::size_t kc, const bfloat16_t* a, std::size_t lda, const bfloat16_t* b,
+				float* c, std::size_t ldc, std::size_t cols, bool overwrite) noexcept {
+			__m512 acc[Rows][2];
+			for (auto& row : acc) {
+				row[0] = _mm512_setzero_ps();
+				row[1] = _mm512_setzero_ps();
+			}
+			// Rows unrolled so the accumulators stay in registers
+			for (std::size_t p = 0; p < kc; p += 2) {
+				const __m512bh b0 = (__m512bh)_mm512_loadu_si512(b + p * split_nr);
+				const __m512bh b1 = (__m512bh)_mm512_loadu_si512(b + p * split_nr + split_nr);
+				[&]<std::size_t... I>(std::index_sequence<I...>) {
+					([&] {
+						const __m512bh ai = (__m512bh)_mm512_maskz_broadcastd_epi32(full16, _mm_loadu_si32(a + I * lda + p));
+						acc[I][0] = _mm512_dpbf16_ps(acc[I][0], ai, b0);
+						acc[I][1] = _mm512_dpbf16_ps(acc[I][1], ai, b1);
+					}(), ...);
+				}(std::make_index_sequence<Rows>{});
+			}
+			const __mmask16 m0 = tail_mask16(cols);
+			const __mmask16 m1 = tail_mask16(cols > 16 ? cols - 16 : 0);
+			for (std::size_t i = 0; i < Rows; ++i) {
+				float* row = c + i * ldc;
+				if (!overwrite) {
+					acc[i][0] = _mm512_add_ps(acc[i][0], _mm512_maskz_loadu_ps(m0, row));
+					acc[i][1] = _mm512_add_ps(acc[i][1], _mm512_maskz_loadu_ps(m1, row + 16));
+				}
+				_mm512_mask_storeu_ps(row, m0, acc[i][0]);
+				_mm512_mask_storeu_ps(row + 16, m1, acc[i][1]);
+			}
+		}
+
+		// C (+)= A * B for bf16 A[m x k] (lda even, zero-padded to an even k)
+		// and B with an even number of rows, via vdpbf16ps
+		inline void gemm_pairs(std::size_t m, std::size_t n, std::size_t k,
+				const bfloat16_t* a, std::size_t lda,
+				const bfloat16_t* b, std::size_t ldb,
+				float* c, std::size_t ldc, bool accumulate) {
+			std::vector<bfloat16_t> b_pack(split_kc * ((std::min(split_nc, n) + split_nr - 1) / split_nr) * split_nr);
+			for (std::size_t jc = 0; jc < n; jc += split_nc) {
+				const std::size_t nc = std::min(split_nc, n - jc);
+				for (std::size_t pc = 0; pc < k; pc += split_kc) {
+					const std::size_t kc = std::min(split_kc, k - pc);
+					const bool overwrite = pc == 0 && !accumulate;
+					pack_b_pairs(kc, nc, b + pc * ldb + jc, ldb, b_pack.data());
+					for (std::size_t ic = 0; ic < m; ic += split_mc) {
+						const std::size_t i1 = std::min(m, ic + split_mc);
+						for (std::size_t jr = 0; jr < nc; jr += split_nr) {
+							const std::size_t cols = std::min(split_nr, nc - jr);
+							const bfloat16_t* bp = b_pack.data() + jr * kc;
+							std::size_t i = ic;
+							for (; i + split_mr <= i1; i += split_mr) {
+								split_micro_kernel<split_mr>(kc, a + i * lda + pc, lda, bp, c + i * ldc + jc + jr, ldc, cols, overwrite);
+							}
+							for (; i < i1; ++i) {
+								split_micro_kernel<1>(kc, a + i * lda + pc, lda, bp, c + i * ldc + jc + jr, ldc, cols, overwrite);
+							}
+						}
+					}
+				}
+			}
+		}
+#endif
+
+		BF16_ISA_END
+
+	} // namespace detail
+
+	BF16_ISA_BEGIN
+
+	inline split_terms split(float x) noexcept {
+		split_terms t;
+		detail::split_kernel(&x, 1, &t.hi, &t.mid, &t.lo);
+		return t;
+	}
+
+	// Elementwise split of x; hi, mid and lo must hold x.size() elements
+	inline void split(std::span<const float> x, std::span<bfloat16_t> hi, std::span<bfloat16_t> mid, std::span<bfloat16_t> lo) noexcept {
+		assert(hi.size() >= x.size() && mid.size() >= x.size() && lo.size() >= x.size());
+		detail::split_kernel(x.data(), x.size(), hi.data(), mid.data(), lo.data());
+	}
+
+	// out = hi + mid + lo, which is exact for the output of split
+	inline void join(std::span<const bfloat16_t> hi, std::span<const bfloat16_t> mid, std::span<const bfloat16_t> lo, std::span<float> out) noexcept {
+		assert(mid.size() == hi.size() && lo.size() == hi.size() && out.size() >= hi.size());
+		for (std::size_t i = 0; i < hi.size(); ++i) {
+			out[i] = (detail::widen(lo[i]) + detail::widen(mid[i])) + detail::widen(hi[i]);
+		}
+	}
+
+	// C[m x n] = A[m x k] * B[k x n] on float operands through bf16 splits;
+	// with accumulate, C += A * B
+	inline void gemm(std::size_t m, std::size_t n, std::size_t k,
+			const float* a, std::size_t lda,
+			const float* b, std::size_t ldb,
+			float* c, std::size_t ldc, split_passes passes, bool accumulate = false) {
+		if (m == 0 || n == 0) return;
+		if (k == 0) {
+			if (!accumulate) {
+				for (std::size_t i = 0; i < m; ++i) std::fill(c + i * ldc, c + i * ldc + n, 0.0f);
+			}
+			return;
+		}
+		const std::size_t terms = passes == split_passes::six ? 3 : 2;
+
+		// Power-of-two scales per row of A and column of B (see the file comment)
+		std::vector<int> ea(m), eb(n);
+		std::vector<float> colmax(n, 0.0f);
+		for (std::size_t i = 0; i < m; ++i) {
+			float rowmax = 0.0f;
+			for (std::size_t p = 0; p < k; ++p) rowmax = std::max(rowmax, std::abs(a[i * lda + p]));
+			ea[i] = detail::split_exponent(rowmax);
+		}
+		for (std::size_t p = 0; p < k; ++p) {
+			for (std::size_t j = 0; j < n; ++j) colmax[j] = std::max(colmax[j], std::abs(b[p * ldb + j]));
+		}
+		for (std::size_t j = 0; j < n; ++j) eb[j] = detail::split_exponent(colmax[j]);
+		const bool scaled = std::ranges::any_of(ea, [](int e) { return e != 0; }) || std::ranges::any_of(eb, [](int e) { return e != 0; });
+		std::vector<float> sb(n);
+		for (std::size_t j = 0; j < n; ++j) sb[j] = std::ldexp(1.0f, -eb[j]);
+
+		// Split copies of A with an even row length and of B with an even row
+		// count, zero-padded, so row pairs never read past the data
+		const std::size_t kp = k + (k & 1);
+		std::vector<bfloat16_t> as(terms * m * kp), bs(terms * kp * n);
+		std::vector<bfloat16_t> scratch(3 * std::max(kp, n));
+		std::vector<float> row(std::max(k, n));
+		const auto split_into = [&](const float* src, std::size_t len, std::vector<bfloat16_t>& dst, std::size_t offset, std::size_t stride) {
+			bfloat16_t* parts = scratch.data();
+			split({src, len}, {parts, len}, {parts + len, len}, {parts + 2 * len, len});
+			for (std::size_t t = 0; t < terms; ++t) std::copy(parts + t * len, parts + (t + 1) * len, dst.data() + t * stride + offset);
+		};
+		for (std::size_t i = 0; i < m; ++i) {
+			const float sa = std::ldexp(1.0f, -ea[i]);
+			for (std::size_t p = 0; p < k; ++p) row[p] = a[i * lda + p] * sa;
+			split_into(row.data(), k, as, i * kp, m * kp);
+		}
+		for (std::size_t p = 0; p < k; ++p) {
+			for (std::size_t j = 0; j < n; ++j) row[j] = b[p * ldb + j] * sb[j];
+			split_into(row.data(), n, bs, p * n, kp * n);
+		}
+
+		// Scaled products go to a scratch C and are scaled back into c
+		std::vector<float> cs(scaled ? m * n : 0);
+		float* out = scaled ? cs.data() : c;
+		const std::size_t ldo = scaled ? n : ldc;
+		const std::span<const std::pair<int, int>> products = passes == split_passes::six
+			? std::span<const std::pair<int, int>>(detail::split_products6)
+			: std::span<const std::pair<int, int>>(detail::split_products3);
+		bool acc = accumulate && !scaled;
+		for (const auto& [ta, tb] : products) {
+			const bfloat16_t* at = as.data() + static_cast<std::size_t>(ta) * m * kp;
+			const bfloat16_t* bt = bs.data() + static_cast<std::size_t>(tb) * kp * n;
+#if defined(BF16_HAVE_AVX512BF16)
+			detail::gemm_pairs(m, n, kp, at, kp, bt, n, out, ldo, acc);
+#else
+			gemm(m, n, k, at, kp, bt, n, out, ldo, acc);
+#endif
+			acc = true;
+		}
+		if (!scaled) return;
+		for (std::size_t i = 0; i < m; ++i) {
+			for (std::size_t j = 0; j < n; ++j) {
+				const float v = std::ldexp(cs[i * n + j], ea[i] + eb[j]);
+				c[i * ldc + j] = accumulate ? c[i * ldc + j] + v : v;
+			}
+		}
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
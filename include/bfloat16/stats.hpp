@@ -0,0 +1,234 @@
+/**
+ * @file stats.hpp
+ * @brief Streaming, mergeable moments of bfloat16_t data
+ *
+ * Spans are consumed in cache-sized chunks: each chunk gets its mean from a
+ * vectorised fp32 sum, its centred moments from a second pass while it is
+ * still in L1, and is then folded into the running totals (kept in double)
+ * with the pairwise update of Chan et al. / Pebay. The same update merges
+ * partial results from other threads or shards. The update is numerically
+ * stable, so results from different splits of the data agree to within a few
+ * rounding errors; they are not bit-identical. The per-chunk power sums are
+ * accumulated in fp32, with a worst-case relative error of about
+ * chunk * 2^-24 (typically far less). NaN propagates: once any added or
+ * merged value is NaN, every statistic, min() and max() included, is NaN.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_STATS_HPP
+#define BFLOAT16_STATS_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/parallel.hpp>
+#include <bfloat16/detail/isa.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace bf16 {
+
+	BF16_ISA_BEGIN
+
+	// HigherMoments additionally tracks the third and fourth central moments
+	// for skewness and kurtosis
+	template<bool HigherMoments = false>
+	class running_stats {
+		private:
+			uint64_t n = 0;
+			double mu = 0.0;
+			double m2 = 0.0;
+			double m3 = 0.0;
+			double m4 = 0.0;
+			float lo = std::numeric_limits<float>::infinity();
+			float hi = -std::numeric_limits<float>::infinity();
+
+			// Chunk length for span updates; small enough to stay in L1 between passes
+			static constexpr std::size_t chunk = 4096;
+
+			void merge_moments(uint64_t nb, double mean_b, double m2b, double m3b, double m4b) noexcept {
+				if (nb == 0) return;
+				if (n == 0) {
+					n = nb;
+					mu = mean_b;
+					m2 = m2b;
+					m3 = m3b;
+					m4 = m4b;
+					return;
+				}
+				const double na = static_cast<double>(n), nbd = static_cast<double>(nb);
+				const double total = na + nbd;
+				const double delta = mean_b - mu;
+				const double delta_n = delta / total;
+
+				if constexpr (HigherMoments) {
+					const double delta_n2 = delta_n * delta_n;
+					m4 = m4 + m4b
+						+ delta * delta_n * delta_n2 * na * nbd * (na * na - na * nbd + nbd * nbd)
+						+ 6.0 * delta_n2 * (na * na * m2b + nbd * nbd * m2)
+						+ 4.0 * delta_n * (na * m3b - nbd * m3);
+					m3 = m3 + m3b
+						+ delta * delta_n2 * na * nbd * (na - nbd)
+						+ 3.0 * delta_n * (na * m2b - nbd * m2);
+				}
+				m2 = m2 + m2b + delta * delta_n * na * nbd;
+				mu = mu + delta_n * nbd;
+				n += nb;
+			}
+
+			void add_chunk(const bfloat16_t* x, std::size_t len) noexcept {
+				// Both paths leave NaN out of the min/max (vminps and std::min would
+				// each keep or drop it depending on operand order) and record it in a
+				// flag that makes both results NaN
+				float sum = 0.0f, cmin = lo, cmax = hi;
+				bool nan = std::isnan(lo);
+				std::size_t i = 0;
+#if defined(BF16_HAVE_AVX512)
+				__m512 vs = _mm512_setzero_ps();
+				__m512 vmin = _mm512_set1_ps(cmin), vmax = _mm512_set1_ps(cmax);
+				__mmask16 unordered = 0;
+				for (; i + 16 <= len; i += 16) {
+					const __m512 v = detail::load16(x + i);
+					const __mmask16 ordered = _mm512_cmp_ps_mask(v, v, _CMP_ORD_Q);
+					unordered |= static_cast<__mmask16>(~ordered);
+					vs = _mm512_add_ps(vs, v);
+					vmin = _mm512_mask_min_ps(vmin, ordered, vmin, v);
+					vmax = _mm512_mask_max_ps(vmax, ordered, vmax, v);
+				}
+				sum = detail::hsum16(vs);
+				cmin = detail::hmin16(vmin);
+				cmax = detail::hmax16(vmax);
+				nan = nan || unordered != 0;
+#endif
+				for (; i < len; ++i) {
+					const float v = detail::widen(x[i]);
+					sum += v;
+					if (std::isnan(v)) {
+						nan = true;
+						continue;
+					}
+					cmin = std::min(cmin, v);
+					cmax = std::max(cmax, v);
+				}
+				lo = nan ? std::numeric_limits<float>::quiet_NaN() : cmin;
+				hi = nan ? std::numeric_limits<float>::quiet_NaN() : cmax;
+
+				// Second pass: power sums of d = x - shift around the rough fp32 mean.
+				// The first-moment residual s1 corrects them for the rounding error
+				// in shift, which leaves only the fp32 rounding of the sums.
+				const float shift = sum / static_cast<float>(len);
+				float s1 = 0.0f, s2 = 0.0f, s3 = 0.0f, s4 = 0.0f;
+				i = 0;
+#if defined(BF16_HAVE_AVX512)
+				const __m512 vshift = _mm512_set1_ps(shift);
+				__m512 v1 = _mm512_setzero_ps(), v2 = _mm512_setzero_ps(), v3 = _mm512_setzero_ps(), v4 = _mm512_setzero_ps();
+				for (; i + 16 <= len; i += 16) {
+					const __m512 d = _mm512_sub_ps(detail::load16(x + i), vshift);
+					const __m512 d2 = _mm512_mul_ps(d, d);
+					v1 = _mm512_add_ps(v1, d);
+					v2 = _mm512_add_ps(v2, d2);
+					if constexpr (HigherMoments) {
+						v3 = _mm512_fmadd_ps(d2, d, v3);
+						v4 = _mm512_fmadd_ps(d2, d2, v4);
+					}
+				}
+				s1 = detail::hsum16(v1);
+				s2 = detail::hsum16(v2);
+				s3 = detail::hsum16(v3);
+				s4 = detail::hsum16(v4);
+#endif
+				for (; i < len; ++i) {
+					const float d = detail::widen(x[i]) - shift;
+					s1 += d;
+					s2 += d * d;
+					if constexpr (HigherMoments) {
+						s3 += d * d * d;
+						s4 += d * d * d * d;
+					}
+				}
+
+				const double len_d = static_cast<double>(len);
+				const double c = static_cast<double>(s1) / len_d;
+				const double p2 = s2, p3 = s3, p4 = s4;
+				const double m2c = p2 - len_d * c * c;
+				double m3c = 0.0, m4c = 0.0;
+				if constexpr (HigherMoments) {
+					m3c = p3 - 3.0 * c * p2 + 2.0 * len_d * c * c * c;
+					m4c = p4 - 4.0 * c * p3 + 6.0 * c * c * p2 - 3.0 * len_d * c * c * c * c;
+				}
+				merge_moments(len, static_cast<double>(shift) + c, std::max(m2c, 0.0), m3c, m4c);
+			}
+
+		public:
+			void add(bfloat16_t x) noexcept {
+				add_chunk(&x, 1);
+			}
+
+			void add(std::span<const bfloat16_t> x) noexcept {
+				for (std::size_t i = 0; i < x.size(); i += chunk) {
+					add_chunk(x.data() + i, std::min(chunk, x.size() - i));
+				}
+			}
+
+			// Fold in statistics gathered elsewhere (another thread, shard or batch)
+			void merge(const running_stats& other) noexcept {
+				if (other.n == 0) return;
+				// std::min/max keep their first argument when either is NaN
+				lo = std::isnan(other.lo) ? other.lo : std::min(lo, other.lo);
+				hi = std::isnan(other.hi) ? other.hi : std::max(hi, other.hi);
+				merge_moments(other.n, other.mu, other.m2, other.m3, other.m4);
+			}
+
+			uint64_t count() const noexcept { return n; }
+			double mean() const noexcept { return n ? mu : std::numeric_limits<double>::quiet_NaN(); }
+			float min() const noexcept { return lo; }
+			float max() const noexcept { return hi; }
+
+			// Population variance; sample_variance() applies Bessel's correction
+			double variance() const noexcept {
+				return n ? m2 / static_cast<double>(n) : std::numeric_limits<double>::quiet_NaN();
+			}
+
+			double sample_variance() const noexcept {
+				return n > 1 ? m2 / static_cast<double>(n - 1) : std::numeric_limits<double>::quiet_NaN();
+			}
+
+			double stddev() const noexcept { return std::sqrt(variance()); }
+
+			double skewness() const noexcept requires HigherMoments {
+				return std::sqrt(static_cast<double>(n)) * m3 / std::pow(m2, 1.5);
+			}
+
+			// Excess kurtosis (0 for a normal distribution)
+			double kurtosis() const noexcept requires HigherMoments {
+				return static_cast<double>(n) * m4 / (m2 * m2) - 3.0;
+			}
+	};
+
+	// Statistics of a whole span, computed over threads and merged
+	template<bool HigherMoments = false>
+	running_stats<HigherMoments> compute_stats(std::span<const bfloat16_t> x) {
+		constexpr std::size_t grain = std::size_t{1} << 18;
+		const std::size_t parts = std::max<std::size_t>(1, std::min(get_num_threads(), x.size() / grain));
+		const std::size_t len = (x.size() + parts - 1) / parts;
+
+		std::vector<running_stats<HigherMoments>> partial(parts);
+		parallel_for(parts, [&](std::size_t p) {
+			const std::size_t begin = std::min(x.size(), p * len);
+			partial[p].add(x.subspan(begin, std::min(len, x.size() - begin)));
+		});
+
+		running_stats<HigherMoments> result;
+		for (const auto& s : partial) result.merge(s);
+		return result;
+	}
+
+	BF16_ISA_END
+
+} // namespace bf16
+
+#endif
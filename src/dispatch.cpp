@@ -0,0 +1,139 @@
+/**
+ * @file dispatch.cpp
+ * @brief Binds the bfloat16_kernels entry points to the best tier for the host
+ *
+ * Built with baseline flags. The table is chosen on first use from
+ * cpu_features() and the BF16_KERNELS_ISA cap, and can be rebound with
+ * set_max_isa(); every call is one atomic load and an indirect jump.
+ * @author Narayan S(Vortex)
+ */
+
+#include "kernel_table.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+
+namespace bf16::kernels {
+
+	namespace detail {
+
+		namespace {
+
+			const kernel_table& tier_table(isa_level isa) noexcept {
+#if defined(BF16_KERNELS_X86)
+				switch (isa) {
+					case isa_level::generic: break;
+					case isa_level::sse42: return tier_table_sse42();
+					case isa_level::avx2: return tier_table_avx2();
+					case isa_level::avx512: return tier_table_avx512();
+					case isa_level::avx512bf16: return tier_table_avx512bf16();
+				}
+#endif
+				(void)isa;
+				return tier_table_generic();
+			}
+
+			isa_level supported() noexcept {
+#if defined(BF16_KERNELS_X86)
+				static const isa_level isa = isa_from_features(cpu_features());
+				return isa;
+#else
+				return isa_level::generic;
+#endif
+			}
+
+			const kernel_table* select_table() noexcept {
+				isa_level isa = supported();
+				// An unrecognised value is ignored rather than silently running generic code
+				if (const char* env = std::getenv("BF16_KERNELS_ISA")) {
+					if (const auto cap = parse_isa(env)) isa = std::min(isa, *cap);
+				}
+				return &tier_table(isa);
+			}
+
+			// Resolved on first use; racing first calls pick the same table
+			std::atomic<const kernel_table*> active{nullptr};
+
+			const kernel_table& table() noexcept {
+				const kernel_table* t = active.load(std::memory_order_acquire);
+				if (t == nullptr) {
+					const kernel_table* expected = nullptr;
+					t = select_table();
+					if (!active.compare_exchange_strong(expected, t, std::memory_order_acq_rel)) t = expected;
+				}
+				return *t;
+			}
+
+		} // namespace
+
+	} // namespace detail
+
+	isa_level supported_isa() noexcept {
+		return detail::supported();
+	}
+
+	isa_level active_isa() noexcept {
+		return detail::table().isa;
+	}
+
+	isa_level resolved_isa(operation op) noexcept {
+		return detail::table().resolved[static_cast<std::size_t>(op)];
+	}
+
+	isa_level set_max_isa(isa_level level) noexcept {
+		const detail::kernel_table& t = detail::tier_table(std::min(level, detail::supported()));
+		detail::active.store(&t, std::memory_order_release);
+		return t.isa;
+	}
+
+	void to_float(std::span<const bfloat16_t> src, std::span<float> dst) noexcept {
+		assert(dst.size() >= src.size());
+		detail::table().to_float(src.data(), dst.data(), src.size());
+	}
+
+	void from_float(std::span<const float> src, std::span<bfloat16_t> dst) noexcept {
+		assert(dst.size() >= src.size());
+		detail::table().from_float(src.data(), dst.data(), src.size());
+	}
+
+	float dot(std::span<const bfloat16_t> a, std::span<const bfloat16_t> b) noexcept {
+		assert(a.size() == b.size());
+		return detail::table().dot(a.data(), b.data(), a.size());
+	}
+
+	float sum(std::span<const bfloat16_t> x) noexcept {
+		return detail::table().sum(x.data(), x.size());
+	}
+
+	float norm(std::span<const bfloat16_t> x) noexcept {
+		return detail::table().norm(x.data(), x.size());
+	}
+
+	void exp(std::span<const bfloat16_t> x, std::span<bfloat16_t> out) noexcept {
+		assert(out.size() >= x.size());
+		detail::table().exp(x.data(), out.data(), x.size());
+	}
+
+	void gemm(std::size_t m, std::size_t n, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* b, std::size_t ldb,
+			float* c, std::size_t ldc, bool accumulate) {
+		detail::table().gemm_f32(m, n, k, a, lda, b, ldb, c, ldc, accumulate);
+	}
+
+	void gemm(std::size_t m, std::size_t n, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* b, std::size_t ldb,
+			bfloat16_t* c, std::size_t ldc) {
+		detail::table().gemm_bf16(m, n, k, a, lda, b, ldb, c, ldc);
+	}
+
+	void gemv(std::size_t m, std::size_t k,
+			const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* x, float* y) noexcept {
+		detail::table().gemv(m, k, a, lda, x, y);
+	}
+
+} // namespace bf16::kernels
@@ -0,0 +1,48 @@
+/**
+ * @file kernel_table.hpp
+ * @brief Per-tier function table shared by the tier builds and the dispatcher
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_SRC_KERNEL_TABLE_HPP
+#define BFLOAT16_SRC_KERNEL_TABLE_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <bfloat16/kernels.hpp>
+
+#include <cstddef>
+#include <iterator>
+
+namespace bf16::kernels::detail {
+
+	// Raw-pointer signatures so every tier exports exactly the same types
+	struct kernel_table {
+		isa_level isa;
+		// Code path of each operation, indexed by operation
+		isa_level resolved[std::size(all_operations)];
+		void (*to_float)(const bfloat16_t* src, float* dst, std::size_t n) noexcept;
+		void (*from_float)(const float* src, bfloat16_t* dst, std::size_t n) noexcept;
+		float (*dot)(const bfloat16_t* a, const bfloat16_t* b, std::size_t n) noexcept;
+		float (*sum)(const bfloat16_t* x, std::size_t n) noexcept;
+		float (*norm)(const bfloat16_t* x, std::size_t n) noexcept;
+		void (*exp)(const bfloat16_t* x, bfloat16_t* out, std::size_t n) noexcept;
+		void (*gemm_f32)(std::size_t m, std::size_t n, std::size_t k, const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* b, std::size_t ldb, float* c, std::size_t ldc, bool accumulate);
+		void (*gemm_bf16)(std::size_t m, std::size_t n, std::size_t k, const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* b, std::size_t ldb, bfloat16_t* c, std::size_t ldc);
+		void (*gemv)(std::size_t m, std::size_t k, const bfloat16_t* a, std::size_t lda,
+			const bfloat16_t* x, float* y) noexcept;
+	};
+
+	// Defined by src/kernels_tier.cpp, once per tier that was built
+	const kernel_table& tier_table_generic() noexcept;
+#if defined(BF16_KERNELS_X86)
+	const kernel_table& tier_table_sse42() noexcept;
+	const kernel_table& tier_table_avx2() noexcept;
+	const kernel_table& tier_table_avx512() noexcept;
+	const kernel_table& tier_table_avx512bf16() noexcept;
+#endif
+
+} // namespace bf16::kernels::detail
+
+#endif
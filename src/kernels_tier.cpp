@@ -0,0 +1,101 @@
+/**
+ * @file kernels_tier.cpp
+ * @brief One instruction-set tier of bfloat16_kernels
+ *
+ * Compiled once per tier with that tier's -m flags, BF16_KERNELS_TIER set to
+ * its name and BF16_ISA_NAMESPACE pinned to a tier-specific namespace, so the
+ * header kernels instantiated here never collide with another tier's copy.
+ * @author Narayan S(Vortex)
+ */
+
+#include "kernel_table.hpp"
+
+#include <bfloat16/convert.hpp>
+#include <bfloat16/elementwise.hpp>
+#include <bfloat16/gemm.hpp>
+#include <bfloat16/reduce.hpp>
+
+#if !defined(BF16_KERNELS_TIER)
+#error "BF16_KERNELS_TIER must name the tier being built"
+#endif
+
+#define BF16_KERNELS_CONCAT_(a, b) a##_##b
+#define BF16_KERNELS_CONCAT(a, b) BF16_KERNELS_CONCAT_(a, b)
+
+namespace bf16::kernels::detail {
+
+	namespace {
+
+		static_assert(compiled_isa(operation::dot) == isa_level::BF16_KERNELS_TIER
+			|| (isa_level::BF16_KERNELS_TIER == isa_level::sse42 && compiled_isa(operation::dot) == isa_level::generic),
+			"tier compile flags do not match BF16_KERNELS_TIER");
+
+		void to_float_impl(const bfloat16_t* src, float* dst, std::size_t n) noexcept {
+			bf16::to_float({src, n}, {dst, n});
+		}
+
+		void from_float_impl(const float* src, bfloat16_t* dst, std::size_t n) noexcept {
+			bf16::from_float({src, n}, {dst, n});
+		}
+
+		float dot_impl(const bfloat16_t* a, const bfloat16_t* b, std::size_t n) noexcept {
+			return bf16::dot({a, n}, {b, n});
+		}
+
+		float sum_impl(const bfloat16_t* x, std::size_t n) noexcept {
+			return bf16::sum({x, n});
+		}
+
+		float norm_impl(const bfloat16_t* x, std::size_t n) noexcept {
+			return bf16::norm({x, n});
+		}
+
+		void exp_impl(const bfloat16_t* x, bfloat16_t* out, std::size_t n) noexcept {
+			bf16::exp(std::span<const bfloat16_t>(x, n), std::span<bfloat16_t>(out, n));
+		}
+
+		void gemm_f32_impl(std::size_t m, std::size_t n, std::size_t k, const bfloat16_t* a, std::size_t lda,
+				const bfloat16_t* b, std::size_t ldb, float* c, std::size_t ldc, bool accumulate) {
+			bf16::gemm(m, n, k, a, lda, b, ldb, c, ldc, accumulate);
+		}
+
+		void gemm_bf16_impl(std::size_t m, std::size_t n, std::size_t k, const bfloat16_t* a, std::size_t lda,
+				const bfloat16_t* b, std::size_t ldb, bfloat16_t* c, std::size_t ldc) {
+			bf16::gemm(m, n, k, a, lda, b, ldb, c, ldc);
+		}
+
+		void gemv_impl(std::size_t m, std::size_t k, const bfloat16_t* a, std::size_t lda,
+				const bfloat16_t* x, float* y) noexcept {
+			bf16::gemv(m, k, a, lda, x, y);
+		}
+
+		constexpr kernel_table table = {
+			isa_level::BF16_KERNELS_TIER,
+			{
+				compiled_isa(operation::to_float),
+				compiled_isa(operation::from_float),
+				compiled_isa(operation::dot),
+				compiled_isa(operation::sum),
+				compiled_isa(operation::norm),
+				compiled_isa(operation::exp),
+				compiled_isa(operation::gemm),
+				compiled_isa(operation::gemv),
+			},
+			to_float_impl,
+			from_float_impl,
+			dot_impl,
+			sum_impl,
+			norm_impl,
+			exp_impl,
+			gemm_f32_impl,
+			gemm_bf16_impl,
+			gemv_impl,
+		};
+
+	} // namespace
+
+	const kernel_table& BF16_KERNELS_CONCAT(tier_table, BF16_KERNELS_TIER)() noexcept {
+		return table;
+	}
+
+} // namespace bf16::kernels::detail
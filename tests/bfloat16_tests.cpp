@@ -10,6 +10,9 @@
 #include <array>
 #include <cmath>
 #include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 using namespace bf16;
 
@@ -207,6 +210,17 @@ TEST_CASE("BFloat16 Special Values", "[bfloat16][special]") {
 		REQUIRE((normal + nan_val).is_nan());
 		REQUIRE((inf + nan_val).is_nan());
 	}
+
+	SECTION("Equality compares values, bitwise_equal compares bits") {
+		const bfloat16_t nan_val = bfloat16_t::nan(), pos_zero(0.0f), neg_zero(-0.0f);
+		REQUIRE_FALSE(nan_val == nan_val);
+		REQUIRE(nan_val != nan_val);
+		REQUIRE(bitwise_equal(nan_val, nan_val));
+		REQUIRE(pos_zero == neg_zero);
+		REQUIRE_FALSE(bitwise_equal(pos_zero, neg_zero));
+		REQUIRE(bitwise_equal(bfloat16_t(1.5f), bfloat16_t(1.5f)));
+		static_assert(bfloat16_t(0.0f) == bfloat16_t(-0.0f) && !(bfloat16_t::nan() == bfloat16_t::nan()));
+	}
 }
 
 TEST_CASE("BFloat16 Numeric Limits", "[bfloat16][limits]") {
@@ -306,3 +320,139 @@ TEST_CASE("BFloat16 Precision Loss", "[bfloat16][precision]") {
 		REQUIRE(ratio < 2.0);
 	}
 }
+
+namespace {
+
+	// Inputs spanning the interesting ranges of each function
+	constexpr float sweep_input(std::size_t i) {
+		return (static_cast<float>(i) - 256.0f) * 0.0371f;
+	}
+
+	template<typename Fn>
+	constexpr std::array<bfloat16_t, 512> make_table(Fn fn) {
+		std::array<bfloat16_t, 512> t{};
+		for (std::size_t i = 0; i < t.size(); ++i) t[i] = fn(bfloat16_t(sweep_input(i)));
+		return t;
+	}
+
+	template<typename Fn>
+	void check_table(const std::array<bfloat16_t, 512>& table, Fn fn) {
+		for (std::size_t i = 0; i < table.size(); ++i) {
+			const bfloat16_t expected = fn(bfloat16_t(sweep_input(i)));
+			if (expected.is_nan()) {
+				REQUIRE(table[i].is_nan());
+			} else {
+				REQUIRE(table[i].bits() == expected.bits());
+			}
+		}
+	}
+
+}
+
+TEST_CASE("BFloat16 Constant Evaluation", "[bfloat16][constexpr]") {
+	SECTION("Arithmetic, comparison and classification") {
+		constexpr bfloat16_t a(1.5f), b(-2.25f);
+		static_assert(static_cast<float>(a + b) == -0.75f);
+		static_assert(static_cast<float>(a * b) == -3.375f);
+		static_assert(static_cast<float>(b / a) == -1.5f);
+		static_assert(static_cast<float>(-(a - b)) == -3.75f);
+		static_assert(b < a && a == bfloat16_t(1.5f));
+		static_assert(bfloat16_t::nan().is_nan() && bfloat16_t::infinity().is_infinity());
+		static_assert(bfloat16_t(-0.0f).is_zero() && b.is_negative() && b.get_sign());
+		static_assert(a.get_exponent() == 0 && a.get_mantissa() == 0x40);
+		static_assert(abs(b) == bfloat16_t(2.25f));
+		static_assert(bfloat16_t::from_bits(0x3F80) == bfloat16_t(1.0f));
+		constexpr bfloat16_t acc = [] {
+			bfloat16_t s;
+			for (int i = 1; i <= 4; ++i) s += bfloat16_t(static_cast<float>(i));
+			s.bits() |= 0x8000;
+			return s;
+		}();
+		static_assert(static_cast<float>(acc) == -10.0f);
+	}
+
+	SECTION("Numeric limits") {
+		using limits = std::numeric_limits<bfloat16_t>;
+		static_assert(limits::min().bits() == 0x0080);
+		static_assert(limits::max().bits() == 0x7F7F);
+		static_assert(limits::lowest() == -limits::max());
+		static_assert(static_cast<float>(limits::epsilon()) == 0.0078125f);
+		static_assert(limits::denorm_min().bits() == 0x0001);
+	}
+
+	SECTION("Math functions match run-time results") {
+		static_assert(sqrt(bfloat16_t(16.0f)) == bfloat16_t(4.0f));
+		static_assert(exp(bfloat16_t(0.0f)) == bfloat16_t(1.0f));
+		static_assert(log(bfloat16_t(1.0f)) == bfloat16_t(0.0f));
+		static_assert(pow(bfloat16_t(2.0f), bfloat16_t(10.0f)) == bfloat16_t(1024.0f));
+		static_assert(exp(bfloat16_t(100.0f)).is_infinity());
+		static_assert(log(bfloat16_t(0.0f)) == bfloat16_t::negative_infinity());
+		static_assert(sqrt(bfloat16_t(-1.0f)).is_nan());
+
+		constexpr auto sqrt_table = make_table([](bfloat16_t x) { return sqrt(abs(x)); });
+		constexpr auto exp_table = make_table([](bfloat16_t x) { return exp(x * bfloat16_t(5.0f)); });
+		constexpr auto log_table = make_table([](bfloat16_t x) { return log(abs(x) * bfloat16_t(100.0f)); });
+		constexpr auto pow_table = make_table([](bfloat16_t x) { return pow(x, bfloat16_t(3.0f)); });
+		constexpr auto sin_table = make_table([](bfloat16_t x) { return sin(x * bfloat16_t(20.0f)); });
+		constexpr auto cos_table = make_table([](bfloat16_t x) { return cos(x * bfloat16_t(20.0f)); });
+		constexpr auto tan_table = make_table([](bfloat16_t x) { return tan(x); });
+
+		check_table(sqrt_table, [](bfloat16_t x) { return sqrt(abs(x)); });
+		check_table(exp_table, [](bfloat16_t x) { return exp(x * bfloat16_t(5.0f)); });
+		check_table(log_table, [](bfloat16_t x) { return log(abs(x) * bfloat16_t(100.0f)); });
+		check_table(pow_table, [](bfloat16_t x) { return pow(x, bfloat16_t(3.0f)); });
+		check_table(sin_table, [](bfloat16_t x) { return sin(x * bfloat16_t(20.0f)); });
+		check_table(cos_table, [](bfloat16_t x) { return cos(x * bfloat16_t(20.0f)); });
+		check_table(tan_table, [](bfloat16_t x) { return tan(x); });
+	}
+}
+
+TEST_CASE("BFloat16 Mixed Precision", "[bfloat16][mixed]") {
+	SECTION("Mixed operators return float") {
+		constexpr bfloat16_t a(1.0f);
+		static_assert(std::is_same_v<decltype(a * 2.0f), float>);
+		static_assert(std::is_same_v<decltype(2.0f - a), float>);
+		static_assert(std::is_same_v<decltype(a + a), bfloat16_t>);
+		// 1 + 2^-12 is not representable in bf16 but survives in the fp32 result
+		static_assert(a + 0.000244140625f == 1.000244140625f);
+		static_assert(0.000244140625f + a == 1.000244140625f);
+		static_assert(a < 1.5f && 0.5f < a && a == 1.0f && a != 1.000244140625f);
+	}
+
+	SECTION("Float accumulators are never narrowed") {
+		// Each of these was ambiguous before the mixed overloads, or narrowed
+		// the fp32 side to bf16
+		static_assert(std::is_same_v<decltype(std::declval<float&>() += std::declval<bfloat16_t>()), float&>);
+		static_assert(std::is_same_v<decltype(std::declval<bfloat16_t>() + 1.0f), float>);
+		static_assert(std::is_same_v<decltype(1.0f * std::declval<bfloat16_t>()), float>);
+		static_assert(std::is_same_v<decltype(fma(bfloat16_t(), bfloat16_t(), 0.0f)), float>);
+
+		// 1 + 2^-10 needs 11 significant bits: a bf16 intermediate would give 1
+		const float sum = bfloat16_t(1.0f) + 0.0009765625f;
+		REQUIRE(sum == 1.0009765625f);
+		float acc = 1.0f;
+		acc += bfloat16_t(0.0009765625f);
+		REQUIRE(acc == 1.0009765625f);
+	}
+
+	SECTION("Compound assignment with float rounds once") {
+		bfloat16_t b(1.0f);
+		b += 0.00390625f;  // exactly half an ulp: ties round toward zero, so stays at 1
+		REQUIRE(b == bfloat16_t(1.0f));
+		b += 0.005859375f;  // three quarters of an ulp rounds up to the next value
+		REQUIRE(b.bits() == 0x3F81);
+		b += 0.00390625f;  // a tie from an odd mantissa stays too (ties-to-even would give 0x3F82)
+		REQUIRE(b.bits() == 0x3F81);
+		b *= 2.0f;
+		REQUIRE(b.bits() == 0x4001);
+	}
+
+	SECTION("fma matches a fused multiply-add") {
+		for (int i = -40; i <= 40; ++i) {
+			const bfloat16_t a(static_cast<float>(i) * 0.173f), b(static_cast<float>(i) * -1.37f + 0.5f);
+			const float c = static_cast<float>(i) * 0.0123f;
+			REQUIRE(fma(a, b, c) == std::fma(static_cast<float>(a), static_cast<float>(b), c));
+		}
+		static_assert(fma(bfloat16_t(2.0f), bfloat16_t(3.0f), bfloat16_t(1.0f)) == bfloat16_t(7.0f));
+	}
+}
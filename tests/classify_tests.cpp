@@ -0,0 +1,85 @@
+/**
+ * @file classify_tests.cpp
+ * @brief Tests for non-finite scanning and classification
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <bfloat16/classify.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace bf16;
+
+namespace {
+
+	// Finite values whose bit patterns OR together into an all-ones exponent
+	std::vector<bfloat16_t> make_finite(std::size_t n) {
+		std::vector<bfloat16_t> v(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			v[i] = bfloat16_t(i % 2 ? 2.0f : 1.5f);
+		}
+		return v;
+	}
+
+}
+
+TEST_CASE("Non-finite scanning", "[classify]") {
+	auto x = make_finite(1000);
+
+	SECTION("Clean buffer") {
+		REQUIRE(count_nonfinite(x) == 0);
+		REQUIRE(all_finite(x));
+		REQUIRE(find_first_nan(x) == x.size());
+	}
+
+	SECTION("Infinities and NaNs") {
+		x[700] = bfloat16_t::infinity();
+		x[999] = bfloat16_t::negative_infinity();
+		x[333] = -bfloat16_t::nan();
+		x[800] = bfloat16_t::nan();
+
+		REQUIRE(count_nonfinite(x) == 4);
+		REQUIRE_FALSE(all_finite(x));
+		REQUIRE(find_first_nan(x) == 333);
+		REQUIRE(find_first_nan(std::span<const bfloat16_t>(x).subspan(334)) == 800 - 334);
+		// An infinity is not a NaN
+		REQUIRE(find_first_nan(std::span<const bfloat16_t>(x).subspan(600, 150)) == 150);
+	}
+
+	SECTION("Only the tail is non-finite") {
+		x.back() = bfloat16_t::infinity();
+		REQUIRE_FALSE(all_finite(x));
+		REQUIRE(count_nonfinite(x) == 1);
+	}
+}
+
+TEST_CASE("Classification", "[classify]") {
+	std::vector<bfloat16_t> x{
+		bfloat16_t(0.0f), bfloat16_t(-0.0f), bfloat16_t(1e-39f), bfloat16_t(-1.0f),
+		bfloat16_t::infinity(), bfloat16_t::negative_infinity(), bfloat16_t::nan(),
+		std::numeric_limits<bfloat16_t>::min(), std::numeric_limits<bfloat16_t>::denorm_min()};
+	std::vector<value_class> out(x.size());
+
+	classify(x, out);
+
+	const std::vector<value_class> expected{
+		value_class::zero, value_class::zero, value_class::subnormal, value_class::normal,
+		value_class::infinite, value_class::infinite, value_class::nan,
+		value_class::normal, value_class::subnormal};
+	REQUIRE(out == expected);
+
+	// Agrees with the scalar predicates over the whole 16-bit space
+	std::vector<bfloat16_t> all(65536);
+	for (std::size_t i = 0; i < all.size(); ++i) all[i].bits() = static_cast<uint16_t>(i);
+	std::vector<value_class> classes(all.size());
+	classify(all, classes);
+	for (std::size_t i = 0; i < all.size(); ++i) {
+		REQUIRE((classes[i] == value_class::nan) == all[i].is_nan());
+		REQUIRE((classes[i] == value_class::infinite) == all[i].is_infinity());
+		REQUIRE((classes[i] == value_class::zero) == all[i].is_zero());
+	}
+	REQUIRE(count_nonfinite(all) == 2 * 128);
+}
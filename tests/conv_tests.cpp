@@ -0,0 +1,187 @@
+/**
+ * @file conv_tests.cpp
+ * @brief Tests for bf16::conv2d against a naive fp32 reference
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/conv.hpp>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+using namespace bf16;
+
+namespace {
+
+	std::vector<bfloat16_t> make_data(std::size_t n, unsigned seed) {
+		std::vector<bfloat16_t> v(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			v[i] = bfloat16_t(static_cast<float>(static_cast<int>((i * 7 + seed * 13) % 17) - 8) / 8.0f);
+		}
+		return v;
+	}
+
+	std::size_t index(const conv2d_shape& s, std::size_t n, std::size_t c, std::size_t y, std::size_t x,
+			std::size_t channels, std::size_t h, std::size_t w) {
+		return s.layout == tensor_layout::nchw
+			? ((n * channels + c) * h + y) * w + x
+			: ((n * h + y) * w + x) * channels + c;
+	}
+
+	std::vector<float> reference_conv(const conv2d_shape& s, const std::vector<bfloat16_t>& in,
+			const std::vector<bfloat16_t>& w, const std::vector<bfloat16_t>& bias) {
+		const std::size_t oh = s.out_height(), ow = s.out_width();
+		const std::size_t icg = s.in_channels / s.groups, ocg = s.out_channels / s.groups;
+		std::vector<float> out(s.output_size());
+		for (std::size_t n = 0; n < s.batch; ++n)
+		for (std::size_t oc = 0; oc < s.out_channels; ++oc)
+		for (std::size_t y = 0; y < oh; ++y)
+		for (std::size_t x = 0; x < ow; ++x) {
+			float acc = bias.empty() ? 0.0f : static_cast<float>(bias[oc]);
+			const std::size_t g = oc / ocg;
+			for (std::size_t c = 0; c < icg; ++c)
+			for (std::size_t ky = 0; ky < s.kernel_height; ++ky)
+			for (std::size_t kx = 0; kx < s.kernel_width; ++kx) {
+				long iy = static_cast<long>(y * s.stride_h + ky * s.dilation_h) - static_cast<long>(s.pad_h);
+				long ix = static_cast<long>(x * s.stride_w + kx * s.dilation_w) - static_cast<long>(s.pad_w);
+				if (iy < 0 || ix < 0 || iy >= static_cast<long>(s.in_height) || ix >= static_cast<long>(s.in_width)) continue;
+				float xv = in[index(s, n, g * icg + c, iy, ix, s.in_channels, s.in_height, s.in_width)];
+				float wv = w[((oc * icg + c) * s.kernel_height + ky) * s.kernel_width + kx];
+				acc += xv * wv;
+			}
+			out[index(s, n, oc, y, x, s.out_channels, oh, ow)] = acc;
+		}
+		return out;
+	}
+
+	void check_conv(const conv2d_shape& s, conv_algorithm algorithm) {
+		auto in = make_data(s.input_size(), 1);
+		auto w = make_data(s.weight_size(), 2);
+		auto bias = make_data(s.out_channels, 3);
+		std::vector<bfloat16_t> out(s.output_size());
+
+		conv2d(s, in, w, bias, out, algorithm);
+		auto expected = reference_conv(s, in, w, bias);
+
+		for (std::size_t i = 0; i < out.size(); ++i) {
+			REQUIRE_THAT(static_cast<float>(out[i]),
+				Catch::Matchers::WithinAbs(expected[i], std::abs(expected[i]) * 0.01f + 1e-2f));
+		}
+	}
+
+	conv2d_shape make_shape(tensor_layout layout) {
+		conv2d_shape s;
+		s.batch = 2;
+		s.in_channels = 6;
+		s.in_height = 9;
+		s.in_width = 11;
+		s.out_channels = 10;
+		s.kernel_height = 3;
+		s.kernel_width = 3;
+		s.layout = layout;
+		return s;
+	}
+
+}
+
+TEST_CASE("Conv2d matches reference", "[conv]") {
+	auto check_all = [](auto&& configure) {
+		for (tensor_layout layout : {tensor_layout::nchw, tensor_layout::nhwc}) {
+			for (conv_algorithm algorithm : {conv_algorithm::im2col, conv_algorithm::direct, conv_algorithm::automatic}) {
+				auto s = make_shape(layout);
+				configure(s);
+				check_conv(s, algorithm);
+			}
+		}
+	};
+
+	SECTION("Plain 3x3") {
+		check_all([](conv2d_shape&) {});
+	}
+
+	SECTION("Stride, padding and dilation") {
+		check_all([](conv2d_shape& s) {
+			s.stride_h = 2;
+			s.stride_w = 3;
+			s.pad_h = 2;
+			s.pad_w = 1;
+			s.dilation_h = 2;
+		});
+	}
+
+	SECTION("Grouped") {
+		check_all([](conv2d_shape& s) {
+			s.groups = 2;
+			s.pad_h = s.pad_w = 1;
+		});
+	}
+
+	SECTION("Depthwise with channel multiplier") {
+		check_all([](conv2d_shape& s) {
+			s.groups = 6;
+			s.out_channels = 12;
+			s.pad_h = s.pad_w = 1;
+		});
+	}
+
+	SECTION("Pointwise") {
+		check_all([](conv2d_shape& s) {
+			s.kernel_height = s.kernel_width = 1;
+			s.in_channels = 40;
+		});
+	}
+}
+
+TEST_CASE("Conv2d output shape", "[conv]") {
+	conv2d_shape s;
+	s.in_height = 32;
+	s.in_width = 32;
+	s.kernel_height = 5;
+	s.kernel_width = 5;
+	s.stride_h = s.stride_w = 2;
+	s.pad_h = s.pad_w = 2;
+
+	REQUIRE(s.out_height() == 16);
+	REQUIRE(s.out_width() == 16);
+	REQUIRE(s.valid());
+
+	// Dilated kernel spans 9 rows/columns: fits 5 + 2 * 2 exactly, not 4 + 2 * 2
+	s.in_height = 5;
+	s.in_width = 4;
+	s.stride_h = s.stride_w = 1;
+	s.kernel_height = s.kernel_width = 3;
+	s.dilation_h = s.dilation_w = 4;
+	REQUIRE(s.out_height() == 1);
+	REQUIRE(s.out_width() == 0);
+	REQUIRE(s.output_size() == 0);
+
+	std::vector<bfloat16_t> in(s.input_size(), bfloat16_t(1.0f)), w(s.weight_size(), bfloat16_t(1.0f));
+	std::vector<bfloat16_t> out(1, bfloat16_t(7.0f));
+	conv2d(s, in, w, {}, out);
+	REQUIRE(static_cast<float>(out[0]) == 7.0f);
+
+	s.stride_w = 0;
+	REQUIRE_FALSE(s.valid());
+	REQUIRE(s.out_width() == 0);
+}
+
+TEST_CASE("GEMM matches naive product", "[gemm]") {
+	const std::size_t m = 37, n = 45, k = 300;
+	auto a = make_data(m * k, 4);
+	auto b = make_data(k * n, 5);
+	std::vector<float> c(m * n);
+
+	gemm(m, n, k, a.data(), k, b.data(), n, c.data(), n);
+
+	for (std::size_t i = 0; i < m; ++i) {
+		for (std::size_t j = 0; j < n; ++j) {
+			float expected = 0.0f;
+			for (std::size_t p = 0; p < k; ++p) {
+				expected += static_cast<float>(a[i * k + p]) * static_cast<float>(b[p * n + j]);
+			}
+			REQUIRE_THAT(c[i * n + j], Catch::Matchers::WithinAbs(expected, 1e-3f));
+		}
+	}
+}
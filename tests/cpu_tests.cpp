@@ -0,0 +1,31 @@
+/**
+ * @file cpu_tests.cpp
+ * @brief Tests for run-time CPU feature detection
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <bfloat16/cpu.hpp>
+
+using namespace bf16;
+
+TEST_CASE("CPU features", "[cpu]") {
+	const cpu_feature_set& f = cpu_features();
+	REQUIRE(&f == &cpu_features());
+
+	// CPUs never expose the wider extensions without their base
+	if (f.avx512bw || f.avx512vl || f.avx512dq || f.avx512bf16 || f.avx512vbmi2) REQUIRE(f.avx512f);
+	if (f.avx512f) REQUIRE(f.avx2);
+	if (f.avx2) REQUIRE(f.sse42);
+
+	// A binary built for an extension only runs where it exists
+#if defined(__AVX2__)
+	REQUIRE(f.avx2);
+#endif
+#if defined(__AVX512F__)
+	REQUIRE(f.avx512f);
+#endif
+#if defined(__AVX512BF16__)
+	REQUIRE(f.avx512bf16);
+#endif
+}
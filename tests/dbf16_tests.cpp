@@ -0,0 +1,94 @@
+/**
+ * @file dbf16_tests.cpp
+ * @brief Tests for the double-bfloat16 pair type
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <bfloat16/dbf16.hpp>
+#include "test_inputs.hpp"
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace bf16;
+
+namespace {
+
+	// 2^-16 relative: the pair keeps at least 16 significant bits
+	bool close(double got, double want) {
+		return std::abs(got - want) <= std::abs(want) * std::ldexp(1.0, -16);
+	}
+
+}
+
+TEST_CASE("dbf16 representation", "[dbf16]") {
+	static_assert(sizeof(dbf16) == 4);
+
+	for (float x : test::wide_input(2000, 1, 20)) {
+		const dbf16 d(x);
+		REQUIRE(d.hi().bits() == bfloat16_t(x).bits());
+		REQUIRE(close(static_cast<float>(d), x));
+		REQUIRE(std::abs(static_cast<float>(d.lo())) <= std::abs(static_cast<float>(d.hi())) * std::ldexp(1.0f, -8));
+	}
+
+	// 16 significant bits are stored exactly
+	REQUIRE(static_cast<float>(dbf16(1.0f + std::ldexp(1.0f, -15))) == 1.0f + std::ldexp(1.0f, -15));
+	REQUIRE(static_cast<float>(dbf16(bfloat16_t(3.0f))) == 3.0f);
+
+	const float max = std::numeric_limits<float>::max();
+	REQUIRE(std::isfinite(static_cast<float>(dbf16(max))));
+	REQUIRE(close(static_cast<float>(dbf16(-max)), -max));
+	REQUIRE(static_cast<float>(dbf16(std::numeric_limits<float>::infinity())) == std::numeric_limits<float>::infinity());
+	REQUIRE(std::isnan(static_cast<float>(dbf16(std::numeric_limits<float>::quiet_NaN()))));
+	REQUIRE(std::signbit(static_cast<float>(dbf16(-0.0f))));
+}
+
+TEST_CASE("dbf16 arithmetic", "[dbf16]") {
+	const auto xs = test::wide_input(500, 2, 20), ys = test::wide_input(500, 3, 20);
+	for (std::size_t i = 0; i < xs.size(); ++i) {
+		const dbf16 a(xs[i]), b(ys[i]);
+		const double da = static_cast<float>(a), db = static_cast<float>(b);
+		REQUIRE(close(static_cast<float>(a + b), da + db));
+		REQUIRE(close(static_cast<float>(a - b), da - db));
+		REQUIRE(close(static_cast<float>(a * b), da * db));
+		REQUIRE(close(static_cast<float>(a / b), da / db));
+		REQUIRE(close(static_cast<float>(sqrt(abs(a))), std::sqrt(std::abs(da))));
+		REQUIRE((a < b) == (da < db));
+	}
+
+	SECTION("Small updates that bfloat16_t loses accumulate") {
+		dbf16 acc(1.0f);
+		bfloat16_t plain(1.0f);
+		for (int i = 0; i < 256; ++i) {
+			acc += dbf16(std::ldexp(1.0f, -12));
+			plain += bfloat16_t(std::ldexp(1.0f, -12));
+		}
+		REQUIRE(static_cast<float>(acc) == 1.0625f);
+		REQUIRE(static_cast<float>(plain) == 1.0f);
+	}
+}
+
+TEST_CASE("dbf16 bulk conversion", "[dbf16]") {
+	for (std::size_t n : {0, 1, 7, 8, 9, 16, 17, 100}) {
+		auto x = test::wide_input(n, 4, 20);
+		if (n > 3) {
+			x[1] = std::numeric_limits<float>::max();
+			x[2] = -std::numeric_limits<float>::infinity();
+			x[3] = -0.0f;
+		}
+		std::vector<dbf16> d(n);
+		std::vector<float> back(n);
+		from_float(x, d);
+		to_float(d, back);
+		for (std::size_t i = 0; i < n; ++i) {
+			const dbf16 ref(x[i]);
+			REQUIRE(d[i].hi().bits() == ref.hi().bits());
+			REQUIRE(d[i].lo().bits() == ref.lo().bits());
+			REQUIRE(std::bit_cast<uint32_t>(back[i]) == std::bit_cast<uint32_t>(static_cast<float>(ref)));
+		}
+	}
+}
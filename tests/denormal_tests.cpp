@@ -0,0 +1,110 @@
+/**
+ * @file denormal_tests.cpp
+ * @brief Tests for flush-to-zero control and the flushing kernel variants
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/denormal.hpp>
+#include "test_inputs.hpp"
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinRel;
+
+namespace {
+
+	// Normals, subnormals of both signs, zeros, infinities and NaN, repeated
+	// past the vector widths
+	constexpr uint16_t pattern[] = {0x3F80, 0x0001, 0x8040, 0x0000, 0x8000, 0x007F, 0x0080, 0x8080,
+		0x7F80, 0xFF80, 0x7FC0, 0xC2F7, 0x807F, 0x0010, 0x4000, 0x8001, 0x00FF};
+
+	uint16_t flushed(uint16_t bits) {
+		return (bits & 0x7F80) == 0 ? static_cast<uint16_t>(bits & 0x8000) : bits;
+	}
+
+}
+
+TEST_CASE("Flush denormals guard", "[denormal]") {
+	const bool before = denormals_flushed();
+	{
+		flush_denormals_guard outer;
+		if (detail::fp_flush_bits != 0) {
+			REQUIRE(denormals_flushed());
+			volatile float tiny = std::numeric_limits<float>::denorm_min() * 64.0f;
+			volatile float one = 1.0f;
+			REQUIRE(tiny * one == 0.0f);
+		}
+		{
+			flush_denormals_guard inner;
+		}
+		REQUIRE(denormals_flushed() == (detail::fp_flush_bits != 0));
+	}
+	REQUIRE(denormals_flushed() == before);
+}
+
+TEST_CASE("Flushing kernels", "[denormal]") {
+	for (std::size_t n : {0, 1, 15, 16, 17, 33, 100, 2100}) {
+		const auto x = test::repeat_bits(n, pattern);
+
+		std::vector<bfloat16_t> y = x;
+		flush_denormals(y);
+		for (std::size_t i = 0; i < n; ++i) REQUIRE(y[i].bits() == flushed(x[i].bits()));
+
+		std::vector<float> f(n), g(n);
+		to_float(x, f, denormal_mode::flush);
+		to_float(x, g, denormal_mode::preserve);
+		for (std::size_t i = 0; i < n; ++i) {
+			REQUIRE(std::bit_cast<uint32_t>(f[i]) == static_cast<uint32_t>(flushed(x[i].bits())) << 16);
+			REQUIRE(std::bit_cast<uint32_t>(g[i]) == static_cast<uint32_t>(x[i].bits()) << 16);
+		}
+
+		// Round trips, plus fp32 values that only become subnormal when narrowed
+		for (std::size_t i = 0; i < n; i += 3) g[i] = (i % 2 ? -1.0f : 1.0f) * 3e-39f;
+		std::vector<bfloat16_t> p(n), q(n);
+		from_float(g, p, denormal_mode::preserve);
+		from_float(g, q, denormal_mode::flush);
+		for (std::size_t i = 0; i < n; ++i) REQUIRE(q[i].bits() == flushed(p[i].bits()));
+	}
+}
+
+TEST_CASE("Flushing reductions", "[denormal]") {
+	// Subnormal inputs contribute nothing once flushed
+	std::vector<bfloat16_t> a(100, bfloat16_t::from_bits(0x0040)), b(100, bfloat16_t(1.0f));
+	REQUIRE(sum(a, denormal_mode::preserve) > 0.0f);
+	REQUIRE(norm(a, denormal_mode::preserve) == norm(a));
+	REQUIRE(sum(a, denormal_mode::flush) == 0.0f);
+	REQUIRE(dot(a, b, denormal_mode::flush) == 0.0f);
+	a[7] = bfloat16_t(2.0f);
+	REQUIRE(norm(a, denormal_mode::flush) == 2.0f);
+	REQUIRE(!denormals_flushed());
+
+	// The operands are flushed explicitly, whatever the FP environment, and
+	// across more than one buffer
+	std::vector<bfloat16_t> c(3000, bfloat16_t::from_bits(0x8001)), d(3000, bfloat16_t(1.0f));
+	c[2500] = bfloat16_t(3.0f);
+	d[2500] = bfloat16_t(4.0f);
+	REQUIRE(sum(c, denormal_mode::flush) == 3.0f);
+	REQUIRE(dot(c, d, denormal_mode::flush) == 12.0f);
+	REQUIRE(norm(c, denormal_mode::flush) == 3.0f);
+	// Squares that overflow, with a largest magnitude whose reciprocal is subnormal
+	c[10] = c[2900] = bfloat16_t::from_bits(0x7F00);
+	REQUIRE_THAT(norm(c, denormal_mode::flush), WithinRel(std::sqrt(2.0f) * 0x1p127f, 1e-6f));
+}
+
+TEST_CASE("Norm inside a flush guard", "[denormal]") {
+	flush_denormals_guard guard;
+	// 1 / 2e38 is an fp32 subnormal, so the rescaling must not divide by amax
+	const std::vector<bfloat16_t> big(2, bfloat16_t(2e38f));
+	REQUIRE_THAT(norm(big), WithinRel(static_cast<float>(big[0]) * std::sqrt(2.0f), 1e-6f));
+	// Squares far below the normal range, for a normal norm
+	const std::vector<bfloat16_t> tiny(100, bfloat16_t(1e-25f));
+	REQUIRE_THAT(norm(tiny), WithinRel(static_cast<float>(tiny[0]) * 10.0f, 1e-5f));
+	REQUIRE_THAT(norm(tiny, denormal_mode::flush), WithinRel(static_cast<float>(tiny[0]) * 10.0f, 1e-5f));
+}
@@ -0,0 +1,152 @@
+/**
+ * @file elementwise_tests.cpp
+ * @brief Tests for compare/where/clamp/relu/leaky_relu/nan_to_num
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <bfloat16/elementwise.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace bf16;
+
+namespace {
+
+	// Mix of signs, zeros, infinities and NaN, long enough to cover vector bodies and tails
+	std::vector<bfloat16_t> make_values() {
+		std::vector<bfloat16_t> v;
+		const float specials[] = {0.0f, -0.0f, 1.0f, -1.0f, 2.5f, -2.5f, 1e-40f, -1e30f,
+			std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+			std::numeric_limits<float>::quiet_NaN()};
+		for (int i = 0; i < 7; ++i) {
+			for (float f : specials) v.emplace_back(f * (i % 2 ? 1.0f : 0.5f));
+		}
+		return v;
+	}
+
+	bool same_bits(const std::vector<bfloat16_t>& a, const std::vector<bfloat16_t>& b) {
+		if (a.size() != b.size()) return false;
+		for (std::size_t i = 0; i < a.size(); ++i) {
+			if (a[i].bits() != b[i].bits()) return false;
+		}
+		return true;
+	}
+
+}
+
+TEST_CASE("Compare matches float semantics", "[elementwise]") {
+	auto a = make_values();
+	std::vector<bfloat16_t> b(a.rbegin(), a.rend());
+	std::vector<uint8_t> mask(a.size());
+
+	const compare_op ops[] = {compare_op::eq, compare_op::ne, compare_op::lt, compare_op::le, compare_op::gt, compare_op::ge};
+	for (compare_op op : ops) {
+		compare(a, b, op, mask);
+		for (std::size_t i = 0; i < a.size(); ++i) {
+			const float x = static_cast<float>(a[i]), y = static_cast<float>(b[i]);
+			bool expected = false;
+			switch (op) {
+				case compare_op::eq: expected = x == y; break;
+				case compare_op::ne: expected = x != y; break;
+				case compare_op::lt: expected = x < y; break;
+				case compare_op::le: expected = x <= y; break;
+				case compare_op::gt: expected = x > y; break;
+				case compare_op::ge: expected = x >= y; break;
+			}
+			REQUIRE(mask[i] == (expected ? 1 : 0));
+		}
+	}
+}
+
+TEST_CASE("Scalar ordering handles negatives", "[elementwise]") {
+	REQUIRE(bfloat16_t(-2.0f) < bfloat16_t(-1.0f));
+	REQUIRE(bfloat16_t(-1.0f) < bfloat16_t(0.5f));
+	REQUIRE_FALSE(bfloat16_t::nan() < bfloat16_t(1.0f));
+}
+
+TEST_CASE("Selection and clamping", "[elementwise]") {
+	auto x = make_values();
+	std::vector<bfloat16_t> out(x.size());
+
+	SECTION("Where") {
+		std::vector<bfloat16_t> zeros(x.size());
+		std::vector<uint8_t> mask(x.size());
+		for (std::size_t i = 0; i < mask.size(); ++i) mask[i] = i % 3 == 0;
+		where(mask, x, zeros, out);
+		for (std::size_t i = 0; i < x.size(); ++i) {
+			REQUIRE(out[i].bits() == (i % 3 == 0 ? x[i].bits() : uint16_t{0}));
+		}
+	}
+
+	SECTION("Clamp") {
+		clamp(x, bfloat16_t(-1.0f), bfloat16_t(2.0f), out);
+		for (std::size_t i = 0; i < x.size(); ++i) {
+			const float v = static_cast<float>(x[i]);
+			if (std::isnan(v)) {
+				REQUIRE(out[i].is_nan());
+			} else {
+				REQUIRE(static_cast<float>(out[i]) == std::fmin(std::fmax(v, -1.0f), 2.0f));
+			}
+		}
+	}
+
+	SECTION("ReLU and leaky ReLU") {
+		relu(x, out);
+		std::vector<bfloat16_t> leaky(x.size());
+		leaky_relu(x, 0.25f, leaky);
+		for (std::size_t i = 0; i < x.size(); ++i) {
+			const float v = static_cast<float>(x[i]);
+			if (std::isnan(v)) {
+				REQUIRE(out[i].is_nan());
+				REQUIRE(leaky[i].is_nan());
+				continue;
+			}
+			REQUIRE(static_cast<float>(out[i]) == (v > 0.0f ? v : 0.0f));
+			REQUIRE(leaky[i].bits() == (v < 0.0f ? bfloat16_t(v * 0.25f) : x[i]).bits());
+		}
+	}
+
+	SECTION("nan_to_num") {
+		nan_to_num(x, out);
+		for (std::size_t i = 0; i < x.size(); ++i) {
+			REQUIRE_FALSE(out[i].is_nan());
+			REQUIRE_FALSE(out[i].is_infinity());
+		}
+
+		std::vector<bfloat16_t> in{bfloat16_t::nan(), bfloat16_t::infinity(), bfloat16_t::negative_infinity(), bfloat16_t(3.0f)};
+		std::vector<bfloat16_t> res(in.size());
+		nan_to_num(in, res, bfloat16_t(-7.0f), bfloat16_t(100.0f), bfloat16_t(-100.0f));
+		REQUIRE(same_bits(res, {bfloat16_t(-7.0f), bfloat16_t(100.0f), bfloat16_t(-100.0f), bfloat16_t(3.0f)}));
+	}
+}
+
+TEST_CASE("exp covers the full input range", "[elementwise]") {
+	const float inf = std::numeric_limits<float>::infinity();
+	// Repeated past one vector width so the SIMD bodies and tails both see each value
+	const float specials[] = {-inf, -200.0f, -104.5f, -90.0f, -87.5f, -10.0f, 0.0f, 1.0f, 88.0f, 88.5f, 89.0f, 100.0f, inf};
+	std::vector<bfloat16_t> x;
+	for (int i = 0; i < 5; ++i) {
+		for (float f : specials) x.emplace_back(f);
+	}
+	std::vector<bfloat16_t> out(x.size());
+	exp(x, out);
+
+	for (std::size_t i = 0; i < x.size(); ++i) {
+		const float v = static_cast<float>(x[i]);
+		const float want = static_cast<float>(bfloat16_t(static_cast<float>(std::exp(static_cast<double>(v)))));
+		const float got = static_cast<float>(out[i]);
+		if (want == 0.0f || std::isinf(want)) {
+			REQUIRE(got == want);
+			REQUIRE_FALSE(std::signbit(got));
+		} else {
+			// One bf16 ulp, which also holds for the -90 subnormal
+			REQUIRE(std::abs(got - want) <= std::abs(want) / 128.0f);
+		}
+	}
+	REQUIRE(static_cast<float>(out[3]) > 0.0f);
+	REQUIRE(out[3].bits() < 0x0080);
+}
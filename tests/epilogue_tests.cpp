@@ -0,0 +1,184 @@
+/**
+ * @file epilogue_tests.cpp
+ * @brief Tests for GEMM/GEMV fused epilogues against separate passes
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/elementwise.hpp>
+#include <bfloat16/gemm.hpp>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinAbs;
+using Catch::Matchers::WithinRel;
+
+namespace {
+
+	std::vector<bfloat16_t> make_data(std::size_t n, unsigned seed) {
+		std::vector<bfloat16_t> v(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			v[i] = bfloat16_t(static_cast<float>(static_cast<int>((i * 7 + seed * 13) % 17) - 8) / 16.0f);
+		}
+		return v;
+	}
+
+	float gelu_ref(float x) {
+		return 0.5f * x * (1.0f + std::tanh(0.7978845608f * (x + 0.044715f * x * x * x)));
+	}
+
+	float silu_ref(float x) {
+		return x / (1.0f + std::exp(-x));
+	}
+
+	// Unfused reference: fp32 GEMM, then bias, GELU, scale and residual as separate passes
+	std::vector<float> reference(std::size_t m, std::size_t n, std::size_t k,
+			const std::vector<bfloat16_t>& a, const std::vector<bfloat16_t>& b,
+			const std::vector<bfloat16_t>& bias, const std::vector<bfloat16_t>& res) {
+		std::vector<float> c(m * n);
+		gemm(m, n, k, a.data(), k, b.data(), n, c.data(), n);
+		for (std::size_t i = 0; i < m; ++i) {
+			for (std::size_t j = 0; j < n; ++j) {
+				float v = c[i * n + j] + static_cast<float>(bias[j]);
+				v = gelu_ref(v) * 0.5f;
+				c[i * n + j] = v + static_cast<float>(res[i * n + j]);
+			}
+		}
+		return c;
+	}
+
+}
+
+TEST_CASE("Exp approximation is accurate", "[epilogue]") {
+	for (float x = -80.0f; x <= 80.0f; x += 0.37f) {
+		REQUIRE_THAT(detail::exp_approx(x), WithinRel(std::exp(x), 1e-6f));
+	}
+	REQUIRE(detail::exp_approx(200.0f) > 1e38f);
+	REQUIRE(detail::exp_approx(-200.0f) < 1e-37f);
+	REQUIRE(std::isnan(detail::exp_approx(std::numeric_limits<float>::quiet_NaN())));
+}
+
+TEST_CASE("Activation epilogues match reference functions", "[epilogue]") {
+	std::vector<float> x;
+	for (float v = -12.0f; v <= 12.0f; v += 0.093f) x.push_back(v);
+	std::vector<float> g = x, s = x, r = x;
+	epilogue::gelu{}(g.data(), g.size(), 0, 0);
+	epilogue::silu{}(s.data(), s.size(), 0, 0);
+	epilogue::relu{}(r.data(), r.size(), 0, 0);
+	for (std::size_t i = 0; i < x.size(); ++i) {
+		REQUIRE_THAT(g[i], WithinAbs(gelu_ref(x[i]), 1e-5f));
+		REQUIRE_THAT(s[i], WithinAbs(silu_ref(x[i]), 1e-5f));
+		REQUIRE(r[i] == (x[i] < 0.0f ? 0.0f : x[i]));
+	}
+}
+
+TEST_CASE("Activation epilogues at infinities and NaN", "[epilogue]") {
+	const float inf = std::numeric_limits<float>::infinity(), nan = std::numeric_limits<float>::quiet_NaN();
+	// Long enough for the vector bodies and the scalar tail
+	std::vector<float> x;
+	for (std::size_t i = 0; i < 19; ++i) x.push_back(i % 3 == 0 ? -inf : i % 3 == 1 ? inf : nan);
+	std::vector<float> g = x, s = x, r = x;
+	epilogue::gelu{}(g.data(), g.size(), 0, 0);
+	epilogue::silu{}(s.data(), s.size(), 0, 0);
+	epilogue::relu{}(r.data(), r.size(), 0, 0);
+	for (std::size_t i = 0; i < x.size(); ++i) {
+		for (float y : {g[i], s[i]}) {
+			if (i % 3 == 0) REQUIRE((y == 0.0f && std::signbit(y)));
+			else if (i % 3 == 1) REQUIRE(y == inf);
+			else REQUIRE(std::isnan(y));
+		}
+		if (i % 3 == 0) REQUIRE(r[i] == 0.0f);
+		else if (i % 3 == 1) REQUIRE(r[i] == inf);
+		else REQUIRE(std::isnan(r[i]));
+	}
+}
+
+TEST_CASE("ReLU epilogue matches bf16::relu on signed zeros", "[epilogue]") {
+	const std::vector<float> x{-0.0f, 0.0f, -1.0f, 2.0f, -std::numeric_limits<float>::denorm_min()};
+	std::vector<float> r = x;
+	epilogue::relu{}(r.data(), r.size(), 0, 0);
+
+	std::vector<bfloat16_t> xb(x.begin(), x.end()), rb(x.size());
+	relu(xb, rb);
+	for (std::size_t i = 0; i < x.size(); ++i) {
+		REQUIRE(r[i] == static_cast<float>(rb[i]));
+		REQUIRE_FALSE(std::signbit(r[i]));
+	}
+}
+
+TEST_CASE("Activation epilogues keep normal tails near the exp limit", "[epilogue]") {
+	// e^88.5 is finite in fp32, so x * sigmoid(x) is a tiny normal value rather than -0
+	std::vector<float> x(19, -88.5f);
+	std::vector<float> s = x;
+	epilogue::silu{}(s.data(), s.size(), 0, 0);
+	for (float y : s) {
+		REQUIRE(y < 0.0f);
+		REQUIRE(std::isnormal(y));
+		REQUIRE_THAT(y, WithinRel(silu_ref(-88.5f), 1e-5f));
+	}
+}
+
+TEST_CASE("Fused GEMM epilogue matches separate passes", "[epilogue]") {
+	// k > gemm_kc exercises the multi-block accumulation path
+	for (std::size_t k : {std::size_t{40}, std::size_t{300}}) {
+		const std::size_t m = 23, n = 70;
+		auto a = make_data(m * k, 1);
+		auto b = make_data(k * n, 2);
+		auto bias = make_data(n, 3);
+		auto res = make_data(m * n, 4);
+		const auto expected = reference(m, n, k, a, b, bias, res);
+
+		const auto ep = epilogue::fuse(epilogue::bias{bias.data()}, epilogue::gelu{},
+			epilogue::scale{0.5f}, epilogue::residual{res.data(), n});
+
+		std::vector<float> cf(m * n);
+		gemm(m, n, k, a.data(), k, b.data(), n, cf.data(), n, ep);
+
+		// bf16 C narrowed at tile store; the residual may alias C itself
+		std::vector<bfloat16_t> cb = res;
+		gemm(m, n, k, a.data(), k, b.data(), n, cb.data(), n,
+			epilogue::fuse(epilogue::bias{bias.data()}, epilogue::gelu{}, epilogue::scale{0.5f}, epilogue::residual{cb.data(), n}));
+
+		for (std::size_t i = 0; i < m * n; ++i) {
+			REQUIRE_THAT(cf[i], WithinAbs(expected[i], 1e-4f));
+			REQUIRE(cb[i].bits() == bfloat16_t(cf[i]).bits());
+		}
+	}
+}
+
+TEST_CASE("Epilogue-free GEMM into bf16 narrows the fp32 result", "[epilogue]") {
+	const std::size_t m = 9, n = 33, k = 600;
+	auto a = make_data(m * k, 5);
+	auto b = make_data(k * n, 6);
+	std::vector<float> cf(m * n);
+	std::vector<bfloat16_t> cb(m * n);
+	gemm(m, n, k, a.data(), k, b.data(), n, cf.data(), n);
+	gemm(m, n, k, a.data(), k, b.data(), n, cb.data(), n);
+	for (std::size_t i = 0; i < m * n; ++i) {
+		REQUIRE(cb[i].bits() == bfloat16_t(cf[i]).bits());
+	}
+}
+
+TEST_CASE("Fused GEMV epilogue indexes outputs by column", "[epilogue]") {
+	const std::size_t m = 150, k = 77;
+	auto a = make_data(m * k, 7);
+	auto x = make_data(k, 8);
+	auto bias = make_data(m, 9);
+
+	std::vector<float> plain(m), fused(m);
+	std::vector<bfloat16_t> fused_bf(m);
+	gemv(m, k, a.data(), k, x.data(), plain.data());
+	const auto ep = epilogue::fuse(epilogue::bias{bias.data()}, epilogue::silu{});
+	gemv(m, k, a.data(), k, x.data(), fused.data(), ep);
+	gemv(m, k, a.data(), k, x.data(), fused_bf.data(), ep);
+
+	for (std::size_t i = 0; i < m; ++i) {
+		const float expected = silu_ref(plain[i] + static_cast<float>(bias[i]));
+		REQUIRE_THAT(fused[i], WithinAbs(expected, 1e-5f));
+		REQUIRE(fused_bf[i].bits() == bfloat16_t(fused[i]).bits());
+	}
+}
@@ -0,0 +1,98 @@
+/**
+ * @file histogram_tests.cpp
+ * @brief Tests for exact histograms and quantiles
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/histogram.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinAbs;
+
+namespace {
+
+	// -50 .. 49 in shuffled order plus a NaN, which quantiles must ignore
+	std::vector<bfloat16_t> make_values() {
+		std::vector<bfloat16_t> v;
+		for (int i = 0; i < 100; ++i) v.emplace_back(static_cast<float>((i * 37) % 100 - 50));
+		v.push_back(bfloat16_t::nan());
+		return v;
+	}
+
+}
+
+TEST_CASE("Exact histogram", "[histogram]") {
+	auto x = make_values();
+	auto counts = histogram(x);
+
+	REQUIRE(counts.size() == histogram_bins);
+	REQUIRE(std::accumulate(counts.begin(), counts.end(), uint64_t{0}) == x.size());
+	REQUIRE(counts[bfloat16_t(-50.0f).bits()] == 1);
+	REQUIRE(counts[bfloat16_t::nan().bits()] == 1);
+
+	SECTION("Multithreaded counts match") {
+		set_num_threads(3);
+		std::vector<bfloat16_t> big((std::size_t{1} << 24) + 12345, bfloat16_t(2.0f));
+		big[7] = bfloat16_t(-1.0f);
+		auto c = histogram(big);
+		REQUIRE(c[bfloat16_t(2.0f).bits()] == big.size() - 1);
+		REQUIRE(c[bfloat16_t(-1.0f).bits()] == 1);
+		set_num_threads(0);
+	}
+}
+
+TEST_CASE("Quantiles", "[histogram]") {
+	auto x = make_values();
+
+	REQUIRE(quantile(x, 0.0) == -50.0f);
+	REQUIRE(quantile(x, 1.0) == 49.0f);
+	REQUIRE_THAT(median(x), WithinAbs(-0.5f, 1e-6f));
+	// Rank 0.25 * 99 = 24.75 lies between -26 and -25
+	REQUIRE_THAT(quantile(x, 0.25), WithinAbs(-25.25f, 1e-5f));
+
+	SECTION("Negative values are ordered correctly") {
+		std::vector<bfloat16_t> v{bfloat16_t(-3.0f), bfloat16_t(-1.0f), bfloat16_t(-2.0f)};
+		REQUIRE(median(v) == -2.0f);
+	}
+
+	SECTION("Infinite endpoints") {
+		const float inf = std::numeric_limits<float>::infinity();
+		std::vector<bfloat16_t> low{bfloat16_t(-inf), bfloat16_t(1.0f), bfloat16_t(2.0f)};
+		REQUIRE(quantile(low, 0.0) == -inf);
+		REQUIRE(quantile(low, 0.25) == -inf);
+		REQUIRE(quantile(low, 1.0) == 2.0f);
+
+		std::vector<bfloat16_t> high{bfloat16_t(1.0f), bfloat16_t(inf), bfloat16_t(inf)};
+		REQUIRE(quantile(high, 0.0) == 1.0f);
+		REQUIRE(median(high) == inf);
+		REQUIRE(quantile(high, 0.25) == inf);
+		REQUIRE(quantile(high, 1.0) == inf);
+	}
+
+	SECTION("Only NaNs") {
+		std::vector<bfloat16_t> v{bfloat16_t::nan()};
+		REQUIRE(std::isnan(median(v)));
+	}
+}
+
+TEST_CASE("Exponent histogram", "[histogram]") {
+	std::vector<bfloat16_t> x{bfloat16_t(1.0f), bfloat16_t(-1.5f), bfloat16_t(3.0f), bfloat16_t(0.0f), bfloat16_t(1000.0f)};
+	auto counts = exponent_histogram(x);
+
+	REQUIRE(counts[127] == 2);
+	REQUIRE(counts[128] == 1);
+	REQUIRE(counts[0] == 1);
+	REQUIRE(counts[127 + 9] == 1);
+
+	// 80% of magnitudes are below 2^2
+	REQUIRE(exponent_quantile(counts, 0.8) == 1);
+	REQUIRE(exponent_quantile(counts, 1.0) == 9);
+}
@@ -0,0 +1,45 @@
+/**
+ * @file kernels_native_tests.cpp
+ * @brief Tests for the compile-time (BF16_KERNELS_NATIVE) mode of kernels.hpp
+ * @author Narayan S(Vortex)
+ */
+
+#define BF16_KERNELS_NATIVE
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/kernels.hpp>
+#include <cstddef>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("Compile-time kernel selection", "[kernels]") {
+	// The tier is a constant of this translation unit's flags
+	static_assert(kernels::active_isa() == kernels::detail::compiled_isa(kernels::operation::dot));
+	static_assert(kernels::set_max_isa(kernels::isa_level::generic) == kernels::active_isa());
+#if defined(BF16_HAVE_AVX512BF16)
+	static_assert(kernels::resolved_isa(kernels::operation::dot) == kernels::isa_level::avx512bf16);
+	static_assert(kernels::resolved_isa(kernels::operation::exp) == kernels::isa_level::avx512);
+#elif defined(BF16_HAVE_AVX512)
+	static_assert(kernels::active_isa() == kernels::isa_level::avx512);
+#elif defined(BF16_HAVE_AVX2)
+	static_assert(kernels::active_isa() == kernels::isa_level::avx2);
+#else
+	static_assert(kernels::active_isa() == kernels::isa_level::generic);
+#endif
+	REQUIRE(kernels::active_isa() <= kernels::supported_isa());
+
+	std::vector<bfloat16_t> a(100), b(100);
+	for (std::size_t i = 0; i < a.size(); ++i) {
+		a[i] = bfloat16_t(static_cast<float>(i % 9) * 0.5f);
+		b[i] = bfloat16_t(1.0f - static_cast<float>(i % 4) * 0.25f);
+	}
+	REQUIRE_THAT(kernels::dot(a, b), WithinAbs(bf16::dot(a, b), 1e-6));
+	REQUIRE(kernels::sum(a) == bf16::sum(a));
+
+	std::vector<float> y(4), y_ref(4);
+	kernels::gemv(4, 25, a.data(), 25, b.data(), y.data());
+	bf16::gemv(4, 25, a.data(), 25, b.data(), y_ref.data());
+	REQUIRE(y == y_ref);
+}
@@ -0,0 +1,163 @@
+/**
+ * @file kernels_tests.cpp
+ * @brief Tests for the runtime-dispatched bfloat16_kernels library
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/convert.hpp>
+#include <bfloat16/cpu.hpp>
+#include <bfloat16/gemm.hpp>
+#include <bfloat16/kernels.hpp>
+#include "test_inputs.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinAbs;
+using Catch::Matchers::WithinRel;
+
+namespace {
+
+	constexpr test::cyclic_input make_input{.period = 11, .step = 0.25f, .offset = -1.25f, .stride = 5};
+
+}
+
+TEST_CASE("Dispatched kernels", "[kernels]") {
+	const kernels::isa_level isa = kernels::active_isa();
+	REQUIRE(kernels::active_isa() == isa);
+	REQUIRE(std::string_view(kernels::isa_name(isa)) != "unknown");
+	REQUIRE(std::string_view(kernels::isa_name(kernels::isa_level::avx512bf16)) == "avx512bf16");
+	REQUIRE(isa <= kernels::supported_isa());
+	for (kernels::operation op : kernels::all_operations) {
+		REQUIRE(kernels::resolved_isa(op) <= isa);
+		REQUIRE(std::string_view(kernels::operation_name(op)) != "unknown");
+	}
+	const cpu_feature_set& f = cpu_features();
+	if (f.avx2 && f.fma && f.f16c && f.bmi1 && f.bmi2) REQUIRE(kernels::supported_isa() >= kernels::isa_level::avx2);
+
+	SECTION("Conversions are bit-exact in every tier") {
+		std::vector<float> src;
+		for (int i = -600; i < 600; ++i) src.push_back(static_cast<float>(i) * 1.37e-3f + 0.5f / (i | 1));
+		std::vector<bfloat16_t> narrowed(src.size());
+		std::vector<float> widened(src.size());
+		kernels::from_float(src, narrowed);
+		kernels::to_float(narrowed, widened);
+		for (std::size_t i = 0; i < src.size(); ++i) {
+			REQUIRE(narrowed[i].bits() == bfloat16_t(src[i]).bits());
+			REQUIRE(widened[i] == static_cast<float>(narrowed[i]));
+		}
+	}
+
+	SECTION("Reductions match the header kernels") {
+		for (std::size_t n : {0, 3, 33, 100, 1000}) {
+			const auto a = make_input(n, 2), b = make_input(n, 7);
+			REQUIRE_THAT(kernels::dot(a, b), WithinAbs(bf16::dot(a, b), 1e-3));
+			REQUIRE_THAT(kernels::sum(a), WithinAbs(bf16::sum(a), 1e-3));
+			REQUIRE_THAT(kernels::norm(a), WithinAbs(bf16::norm(a), 1e-3));
+		}
+		// Squares that overflow or underflow fp32 take the rescaled path
+		for (float v : {1e37f, 1e-25f}) {
+			const std::vector<bfloat16_t> x(100, bfloat16_t(v));
+			REQUIRE_THAT(kernels::norm(x), WithinRel(static_cast<float>(x[0]) * 10.0f, 1e-5f));
+		}
+	}
+
+	SECTION("exp") {
+		const auto x = make_input(200, 3);
+		std::vector<bfloat16_t> out(x.size());
+		kernels::exp(x, out);
+		for (std::size_t i = 0; i < x.size(); ++i) {
+			REQUIRE_THAT(static_cast<float>(out[i]), WithinRel(std::exp(static_cast<float>(x[i])), 1.0f / 128.0f));
+		}
+	}
+
+	SECTION("GEMM and GEMV") {
+		const std::size_t m = 19, n = 37, k = 300;
+		const auto a = make_input(m * k, 1), b = make_input(k * n, 4), x = make_input(k, 6);
+		std::vector<float> c(m * n, 1.0f), ref(m * n, 1.0f);
+		kernels::gemm(m, n, k, a.data(), k, b.data(), n, c.data(), n, true);
+		bf16::gemm(m, n, k, a.data(), k, b.data(), n, ref.data(), n, true);
+		for (std::size_t i = 0; i < c.size(); ++i) REQUIRE_THAT(c[i], WithinAbs(ref[i], 1e-3));
+
+		std::vector<bfloat16_t> cb(m * n);
+		kernels::gemm(m, n, k, a.data(), k, b.data(), n, cb.data(), n);
+		kernels::gemm(m, n, k, a.data(), k, b.data(), n, c.data(), n);
+		for (std::size_t i = 0; i < c.size(); ++i) {
+			REQUIRE_THAT(static_cast<float>(cb[i]), WithinAbs(c[i], std::abs(c[i]) / 128.0f + 1e-6f));
+		}
+
+		std::vector<float> y(m), y_ref(m);
+		kernels::gemv(m, k, a.data(), k, x.data(), y.data());
+		bf16::gemv(m, k, a.data(), k, x.data(), y_ref.data());
+		for (std::size_t i = 0; i < m; ++i) REQUIRE_THAT(y[i], WithinAbs(y_ref[i], 1e-3));
+	}
+}
+
+TEST_CASE("Dispatched exp at the top of the range", "[kernels]") {
+	// e^88.5 is finite in fp32 and bf16; e^89 is not. Repeated past one
+	// vector width so the SIMD bodies and the tails both see each value.
+	std::vector<bfloat16_t> x;
+	for (int i = 0; i < 12; ++i) {
+		for (float v : {88.0f, 88.5f, 89.0f}) x.emplace_back(v);
+	}
+	std::vector<bfloat16_t> out(x.size());
+
+	const kernels::isa_level before = kernels::active_isa();
+	for (kernels::isa_level isa : {kernels::isa_level::generic, kernels::isa_level::sse42,
+			kernels::isa_level::avx2, kernels::isa_level::avx512, kernels::isa_level::avx512bf16}) {
+		kernels::set_max_isa(isa);
+		kernels::exp(x, out);
+		for (std::size_t i = 0; i < x.size(); ++i) {
+			const float want = static_cast<float>(bfloat16_t(std::exp(static_cast<float>(x[i]))));
+			const float got = static_cast<float>(out[i]);
+			if (std::isinf(want)) REQUIRE(got == want);
+			else REQUIRE_THAT(got, WithinRel(want, 1.0f / 128.0f));
+		}
+	}
+	kernels::set_max_isa(before);
+}
+
+TEST_CASE("Kernel tier override", "[kernels]") {
+	REQUIRE(kernels::parse_isa("sse4.2") == kernels::isa_level::sse42);
+	REQUIRE(kernels::parse_isa("sse42") == kernels::isa_level::sse42);
+	REQUIRE(kernels::parse_isa("avx512bf16") == kernels::isa_level::avx512bf16);
+	REQUIRE_FALSE(kernels::parse_isa("avx3").has_value());
+
+	// A tier is only picked when the host has every extension it is built with
+	cpu_feature_set f{.sse42 = true, .popcnt = true, .avx2 = true, .fma = true, .f16c = true};
+	REQUIRE(kernels::detail::isa_from_features(f) == kernels::isa_level::sse42);
+	f.bmi1 = f.bmi2 = true;
+	REQUIRE(kernels::detail::isa_from_features(f) == kernels::isa_level::avx2);
+	f.avx512f = f.avx512bw = f.avx512vl = f.avx512dq = f.avx512bf16 = true;
+	REQUIRE(kernels::detail::isa_from_features(f) == kernels::isa_level::avx512bf16);
+	f.f16c = false;
+	REQUIRE(kernels::detail::isa_from_features(f) == kernels::isa_level::sse42);
+
+	const kernels::isa_level before = kernels::active_isa();
+	const auto a = make_input(1000, 1), b = make_input(1000, 8);
+	const float expected = bf16::dot(a, b);
+
+	// Every tier up to the host's best gives the same answer
+	for (kernels::isa_level isa : {kernels::isa_level::generic, kernels::isa_level::sse42,
+			kernels::isa_level::avx2, kernels::isa_level::avx512, kernels::isa_level::avx512bf16}) {
+		const kernels::isa_level bound = kernels::set_max_isa(isa);
+		REQUIRE(bound == std::min(isa, kernels::supported_isa()));
+		REQUIRE(kernels::active_isa() == bound);
+		REQUIRE(kernels::resolved_isa(kernels::operation::dot) <= bound);
+		REQUIRE_THAT(kernels::dot(a, b), WithinAbs(expected, 1e-3));
+	}
+	REQUIRE(kernels::resolved_isa(kernels::operation::sum) <= kernels::isa_level::avx512);
+
+	kernels::set_max_isa(kernels::isa_level::sse42);
+	if (kernels::supported_isa() >= kernels::isa_level::sse42) {
+		// No SSE4.2-specific code paths exist
+		REQUIRE(kernels::resolved_isa(kernels::operation::gemm) == kernels::isa_level::generic);
+	}
+	kernels::set_max_isa(before);
+	REQUIRE(kernels::active_isa() == before);
+}
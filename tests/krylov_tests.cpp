@@ -0,0 +1,159 @@
+/**
+ * @file krylov_tests.cpp
+ * @brief Tests for CG and GMRES on bf16 operators
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <bfloat16/krylov.hpp>
+#include "test_inputs.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace bf16;
+
+namespace {
+
+	constexpr test::uniform_input<float> make_input{};
+
+	// 5-point operator on a g x g grid: 4 + shift on the diagonal, -1 - c / -1 + c
+	// to the west / east neighbours (c = 0 is the symmetric Laplacian)
+	std::vector<bfloat16_t> grid_operator(std::size_t g, float shift, float c) {
+		const std::size_t n = g * g;
+		std::vector<bfloat16_t> a(n * n);
+		for (std::size_t y = 0; y < g; ++y) {
+			for (std::size_t x = 0; x < g; ++x) {
+				const std::size_t i = y * g + x;
+				a[i * n + i] = bfloat16_t(4.0f + shift);
+				if (x > 0) a[i * n + i - 1] = bfloat16_t(-1.0f - c);
+				if (x + 1 < g) a[i * n + i + 1] = bfloat16_t(-1.0f + c);
+				if (y > 0) a[i * n + i - g] = bfloat16_t(-1.0f);
+				if (y + 1 < g) a[i * n + i + g] = bfloat16_t(-1.0f);
+			}
+		}
+		return a;
+	}
+
+	// Dense SPD: X X^T / m + I, or a nonsymmetric matrix with a dominant diagonal
+	std::vector<bfloat16_t> dense_operator(std::size_t n, bool symmetric, uint32_t seed) {
+		if (symmetric) {
+			const auto spd = test::spd_matrix(n, seed);
+			std::vector<bfloat16_t> a(n * n);
+			for (std::size_t i = 0; i < n * n; ++i) a[i] = bfloat16_t(static_cast<float>(spd[i]));
+			return a;
+		}
+		const auto x = make_input(n * n, seed);
+		std::vector<bfloat16_t> a(n * n);
+		for (std::size_t i = 0; i < n; ++i) {
+			for (std::size_t j = 0; j < n; ++j) {
+				a[i * n + j] = bfloat16_t(x[i * n + j] / std::sqrt(static_cast<float>(n)) + (i == j ? 1.0f : 0.0f));
+			}
+		}
+		return a;
+	}
+
+	// ||b - A x|| / ||b|| in fp64 with the bf16 operator values
+	double relative_residual(std::size_t n, const std::vector<bfloat16_t>& a, const std::vector<float>& b, const std::vector<float>& x) {
+		double rr = 0.0, bb = 0.0;
+		for (std::size_t i = 0; i < n; ++i) {
+			double s = b[i];
+			for (std::size_t j = 0; j < n; ++j) s -= static_cast<double>(static_cast<float>(a[i * n + j])) * x[j];
+			rr += s * s;
+			bb += static_cast<double>(b[i]) * b[i];
+		}
+		return std::sqrt(rr / bb);
+	}
+
+}
+
+TEST_CASE("CG on bf16 operators", "[krylov]") {
+	krylov_options opt;
+	opt.tolerance = 1e-5f;
+
+	SECTION("Sparse Laplacian") {
+		const std::size_t g = 24, n = g * g;
+		const auto dense = grid_operator(g, 0.0f, 0.0f);
+		const csr_matrix a = csr_matrix::from_dense(n, n, dense.data(), n);
+		const auto b = make_input(n, 1);
+		std::vector<float> x(n, 0.0f);
+		const krylov_result r = cg(a, b, x, opt);
+		REQUIRE(r.converged);
+		REQUIRE(r.iterations > 10);
+		REQUIRE(r.residual <= opt.tolerance);
+		REQUIRE(relative_residual(n, dense, b, x) <= 2e-5);
+
+		// Restarting from the solution needs no iterations
+		const krylov_result again = cg(a, b, x, opt);
+		REQUIRE(again.converged);
+		REQUIRE(again.iterations == 0);
+	}
+
+	SECTION("Dense covariance") {
+		const std::size_t n = 150;
+		const auto a = dense_operator(n, true, 2);
+		const auto b = make_input(n, 3);
+		std::vector<float> x(n, 0.0f);
+		const krylov_result r = cg(n, a.data(), n, b, x, opt);
+		REQUIRE(r.converged);
+		REQUIRE(relative_residual(n, a, b, x) <= 2e-5);
+	}
+}
+
+TEST_CASE("GMRES on bf16 operators", "[krylov]") {
+	krylov_options opt;
+	opt.tolerance = 1e-5f;
+
+	SECTION("Sparse convection-diffusion") {
+		const std::size_t g = 20, n = g * g;
+		const auto dense = grid_operator(g, 0.5f, 0.5f);
+		const csr_matrix a = csr_matrix::from_dense(n, n, dense.data(), n);
+		const auto b = make_input(n, 4);
+		for (std::size_t restart : {5, 30}) {
+			opt.restart = restart;
+			std::vector<float> x(n, 0.0f);
+			const krylov_result r = gmres(a, b, x, opt);
+			REQUIRE(r.converged);
+			REQUIRE(r.residual <= opt.tolerance);
+			REQUIRE(relative_residual(n, dense, b, x) <= 2e-5);
+		}
+	}
+
+	SECTION("Dense nonsymmetric") {
+		const std::size_t n = 120;
+		const auto a = dense_operator(n, false, 5);
+		const auto b = make_input(n, 6);
+		std::vector<float> x(n, 0.0f);
+		const krylov_result r = gmres(n, a.data(), n, b, x, opt);
+		REQUIRE(r.converged);
+		REQUIRE(relative_residual(n, a, b, x) <= 2e-5);
+	}
+}
+
+TEST_CASE("Krylov edge cases", "[krylov]") {
+	const std::size_t g = 16, n = g * g;
+	const auto dense = grid_operator(g, 0.0f, 0.0f);
+	const csr_matrix a = csr_matrix::from_dense(n, n, dense.data(), n);
+
+	std::vector<float> zero(n, 0.0f), x(n, 3.0f);
+	REQUIRE(cg(a, zero, x).converged);
+	for (float v : x) REQUIRE(v == 0.0f);
+	std::fill(x.begin(), x.end(), 3.0f);
+	REQUIRE(gmres(a, zero, x).converged);
+	for (float v : x) REQUIRE(v == 0.0f);
+
+	krylov_options opt;
+	opt.max_iterations = 3;
+	const auto b = make_input(n, 7);
+	std::fill(x.begin(), x.end(), 0.0f);
+	const krylov_result rc = cg(a, b, x, opt);
+	REQUIRE_FALSE(rc.converged);
+	REQUIRE(rc.iterations == 3);
+	REQUIRE(rc.residual < 1.0f);
+	std::fill(x.begin(), x.end(), 0.0f);
+	const krylov_result rg = gmres(a, b, x, opt);
+	REQUIRE_FALSE(rg.converged);
+	REQUIRE(rg.iterations == 3);
+	REQUIRE(rg.residual < 1.0f);
+}
@@ -0,0 +1,105 @@
+/**
+ * @file layout_tests.cpp
+ * @brief Tests for transpose, VNNI and tile packing
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <bfloat16/layout.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace bf16;
+
+namespace {
+
+	std::vector<bfloat16_t> make_matrix(std::size_t n) {
+		std::vector<bfloat16_t> v(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			v[i].bits() = static_cast<uint16_t>(i + 1);
+		}
+		return v;
+	}
+
+}
+
+TEST_CASE("Transpose", "[layout]") {
+	SECTION("Out of place, odd shape") {
+		const std::size_t rows = 37, cols = 21;
+		auto a = make_matrix(rows * cols);
+		std::vector<bfloat16_t> t(rows * cols);
+
+		transpose(rows, cols, a.data(), cols, t.data(), rows);
+
+		for (std::size_t i = 0; i < rows; ++i) {
+			for (std::size_t j = 0; j < cols; ++j) {
+				REQUIRE(t[j * rows + i].bits() == a[i * cols + j].bits());
+			}
+		}
+	}
+
+	SECTION("In place") {
+		for (std::size_t n : {5, 16, 35}) {
+			auto a = make_matrix(n * n);
+			auto original = a;
+
+			transpose_inplace(n, a.data(), n);
+
+			for (std::size_t i = 0; i < n; ++i) {
+				for (std::size_t j = 0; j < n; ++j) {
+					REQUIRE(a[j * n + i].bits() == original[i * n + j].bits());
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("VNNI packing", "[layout]") {
+	SECTION("Pairs rows along k and round-trips") {
+		const std::size_t k = 7, n = 19;
+		auto b = make_matrix(k * n);
+		std::vector<bfloat16_t> packed(vnni_size(k, n));
+
+		pack_vnni(k, n, b.data(), n, packed.data());
+
+		for (std::size_t p = 0; p < k; ++p) {
+			for (std::size_t j = 0; j < n; ++j) {
+				REQUIRE(packed[(p / 2) * 2 * n + 2 * j + p % 2].bits() == b[p * n + j].bits());
+			}
+		}
+		// Odd k: the last pair is completed with zeros
+		REQUIRE(packed[(k / 2) * 2 * n + 1].is_zero());
+
+		std::vector<bfloat16_t> back(k * n);
+		unpack_vnni(k, n, packed.data(), back.data(), n);
+		REQUIRE(back == b);
+	}
+
+	SECTION("In place matches out of place") {
+		const std::size_t k = 6, n = 37;
+		auto b = make_matrix(k * n);
+		std::vector<bfloat16_t> expected(vnni_size(k, n));
+		pack_vnni(k, n, b.data(), n, expected.data());
+
+		pack_vnni_inplace(k, n, b.data());
+		REQUIRE(b == expected);
+	}
+}
+
+TEST_CASE("Tile packing", "[layout]") {
+	const std::size_t rows = 10, cols = 13, tr = 4, tc = 8;
+	auto a = make_matrix(rows * cols);
+	std::vector<bfloat16_t> tiles(tiled_size(rows, cols, tr, tc));
+
+	pack_tiles(rows, cols, a.data(), cols, tr, tc, tiles.data());
+
+	// Second tile of the first tile row starts at column 8
+	REQUIRE(tiles[tr * tc].bits() == a[8].bits());
+	// Padding past column 13 in that tile
+	REQUIRE(tiles[tr * tc + 5].is_zero());
+
+	std::vector<bfloat16_t> back(rows * cols);
+	unpack_tiles(rows, cols, tiles.data(), tr, tc, back.data(), cols);
+	REQUIRE(back == a);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file mdspan_tests.cpp
+ * @brief Tests for the widening mdspan accessors and the mdspan kernel overloads
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/mdspan.hpp>
+#include "test_mdspan.hpp"
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinAbs;
+
+// The kernel overloads are duck-typed; run them against md::mdspan where the
+// library has it and against the stand-in everywhere else
+#if defined(__cpp_lib_mdspan)
+namespace md = std;
+#else
+namespace md = bf16::test;
+#endif
+
+TEST_CASE("Widening accessors", "[mdspan]") {
+	std::vector<bfloat16_t> data(8);
+	for (std::size_t i = 0; i < data.size(); ++i) data[i] = bfloat16_t(static_cast<float>(i) + 0.5f);
+
+	static_assert(std::is_same_v<widening_accessor<const bfloat16_t>::reference, float>);
+
+	const widening_accessor<bfloat16_t> acc;
+	const widening_accessor<const bfloat16_t> cacc = acc;
+	REQUIRE(cacc.access(data.data(), 3) == 3.5f);
+	REQUIRE(cacc.offset(data.data(), 2) == data.data() + 2);
+
+	// Writes round like bfloat16_t(float)
+	acc.access(data.data(), 0) = 1.0f + 1.0f / 64.0f + 1.0f / 1024.0f;
+	REQUIRE(data[0].bits() == bfloat16_t(1.0f + 1.0f / 64.0f + 1.0f / 1024.0f).bits());
+	acc.access(data.data(), 1) += 2.0f;
+	REQUIRE(static_cast<float>(data[1]) == 3.5f);
+	acc.access(data.data(), 2) = acc.access(data.data(), 7);
+	REQUIRE(data[2].bits() == data[7].bits());
+	const float widened = acc.access(data.data(), 4);
+	REQUIRE(widened == 4.5f);
+}
+
+TEST_CASE("mdspan kernels", "[mdspan]") {
+	using ext2 = md::dextents<std::size_t, 2>;
+	using widening = md::mdspan<const bfloat16_t, ext2, md::layout_right, widening_accessor<const bfloat16_t>>;
+	using narrowing = md::mdspan<bfloat16_t, ext2, md::layout_right, widening_accessor<bfloat16_t>>;
+	const std::size_t rows = 5, cols = 21;
+	std::vector<bfloat16_t> a(rows * cols), b(rows * cols);
+	for (std::size_t i = 0; i < a.size(); ++i) {
+		a[i] = bfloat16_t(static_cast<float>(i % 13) * 0.25f);
+		b[i] = bfloat16_t(1.0f - static_cast<float>(i % 5) * 0.5f);
+	}
+
+	SECTION("Element access widens and narrows") {
+		const widening va(a.data(), rows, cols);
+		REQUIRE(va[2, 3] == static_cast<float>(a[2 * cols + 3]));
+
+		std::vector<bfloat16_t> out(rows * cols);
+		const narrowing vo(out.data(), rows, cols);
+		vo[1, 2] = 0.1f;
+		REQUIRE(out[cols + 2].bits() == bfloat16_t(0.1f).bits());
+	}
+
+	SECTION("Conversions across layouts") {
+		std::vector<float> right(rows * cols), left(rows * cols), back_f(rows * cols);
+		to_float(md::mdspan<const bfloat16_t, ext2>(a.data(), rows, cols), md::mdspan<float, ext2>(right.data(), rows, cols));
+		to_float(md::mdspan<bfloat16_t, ext2>(a.data(), rows, cols),
+			md::mdspan<float, ext2, md::layout_left>(left.data(), rows, cols));
+		for (std::size_t r = 0; r < rows; ++r) {
+			for (std::size_t c = 0; c < cols; ++c) {
+				REQUIRE(right[r * cols + c] == static_cast<float>(a[r * cols + c]));
+				REQUIRE(left[c * rows + r] == static_cast<float>(a[r * cols + c]));
+			}
+		}
+
+		// Column-major float back into row-major bf16
+		std::vector<bfloat16_t> back(rows * cols);
+		from_float(md::mdspan<const float, ext2, md::layout_left>(left.data(), rows, cols),
+			narrowing(back.data(), rows, cols));
+		for (std::size_t i = 0; i < a.size(); ++i) REQUIRE(back[i].bits() == a[i].bits());
+	}
+
+	SECTION("Strided views and reductions") {
+		// Every other column: rows stay addressable, the inner stride is 2
+		using mapping = md::layout_stride::mapping<ext2>;
+		const mapping strided(ext2(rows, cols / 2), std::array<std::size_t, 2>{cols, 2});
+		const md::mdspan<const bfloat16_t, ext2, md::layout_stride> sa(a.data(), strided), sb(b.data(), strided);
+
+		float ref_sum = 0.0f, ref_dot = 0.0f;
+		for (std::size_t r = 0; r < rows; ++r) {
+			for (std::size_t c = 0; c < cols / 2; ++c) {
+				ref_sum += static_cast<float>(a[r * cols + 2 * c]);
+				ref_dot += static_cast<float>(a[r * cols + 2 * c]) * static_cast<float>(b[r * cols + 2 * c]);
+			}
+		}
+		REQUIRE_THAT(sum(sa), WithinAbs(ref_sum, 1e-3));
+		REQUIRE_THAT(dot(sa, sb), WithinAbs(ref_dot, 1e-3));
+
+		const widening full(a.data(), rows, cols);
+		REQUIRE_THAT(sum(full), WithinAbs(sum(std::span<const bfloat16_t>(a)), 1e-3));
+	}
+}
@@ -0,0 +1,120 @@
+/**
+ * @file packed_tests.cpp
+ * @brief Tests for bit-packed reduced-mantissa bf16 storage
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <bfloat16/packed.hpp>
+#include "test_inputs.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// The bfloat16_packed_pdep_tests target builds this file again with
+// BF16_USE_PDEP, so both the shift and the PDEP/PEXT paths meet the same checks
+#if defined(BF16_USE_PDEP) && !defined(BF16_HAVE_PDEP)
+#error "BF16_USE_PDEP is defined but the PDEP paths are disabled; build with AVX2, FMA and BMI2"
+#endif
+
+using namespace bf16;
+
+namespace {
+
+	// Round to k mantissa bits one value at a time
+	uint16_t reference(uint16_t v, unsigned k) {
+		const unsigned shift = 7 - k;
+		const uint16_t mask = static_cast<uint16_t>(0xFFFF << shift);
+		if ((v & 0x7F80) == 0x7F80) {
+			if ((v & 0x007F) == 0 || (v & mask & 0x007F) != 0) return static_cast<uint16_t>(v & mask);
+			return static_cast<uint16_t>((v | 0x0040) & mask);
+		}
+		if (shift == 0) return v;
+		return static_cast<uint16_t>((v + (1u << (shift - 1)) - 1) & mask);
+	}
+
+}
+
+TEST_CASE("Packed storage rounding and size", "[packed]") {
+	const auto x = test::random_bits(1000, 1);
+	for (unsigned k = 0; k <= 7; ++k) {
+		const packed_bf16_array p = pack_bf16(x, k);
+		REQUIRE(p.size == x.size());
+		REQUIRE(p.bits_per_value() == 9 + k);
+		REQUIRE(p.storage_bytes() == 125 * (9 + k));
+
+		std::vector<bfloat16_t> back(x.size());
+		unpack_bf16(p, back);
+		for (std::size_t i = 0; i < x.size(); ++i) {
+			REQUIRE(back[i].bits() == reference(x[i].bits(), k));
+			REQUIRE(packed_get(p, i).bits() == back[i].bits());
+		}
+	}
+}
+
+TEST_CASE("Packed bytes follow the bit-stream layout", "[packed]") {
+	const auto x = test::random_bits(203, 3);
+	for (unsigned k = 0; k <= 7; ++k) {
+		const packed_bf16_array p = pack_bf16(x, k);
+		const unsigned b = 9 + k;
+		std::vector<uint8_t> want(p.storage_bytes());
+		for (std::size_t i = 0; i < x.size(); ++i) {
+			const unsigned code = reference(x[i].bits(), k) >> (7 - k);
+			for (unsigned t = 0; t < b; ++t) {
+				const std::size_t bit = i * b + t;
+				if ((code >> t) & 1) want[bit / 8] |= static_cast<uint8_t>(1u << (bit % 8));
+			}
+		}
+		REQUIRE(std::equal(want.begin(), want.end(), p.bytes.begin()));
+	}
+}
+
+TEST_CASE("Packed storage keeps every bf16 value at k = 7", "[packed]") {
+	std::vector<bfloat16_t> all(65536);
+	for (std::size_t i = 0; i < all.size(); ++i) all[i] = bfloat16_t::from_bits(static_cast<uint16_t>(i));
+	const packed_bf16_array p = pack_bf16(all, 7);
+	std::vector<bfloat16_t> back(all.size());
+	unpack_bf16(p, back);
+	for (std::size_t i = 0; i < all.size(); ++i) REQUIRE(back[i].bits() == all[i].bits());
+}
+
+TEST_CASE("Packed storage special values", "[packed]") {
+	const float inf = std::numeric_limits<float>::infinity();
+	const std::vector<bfloat16_t> x = {bfloat16_t(inf), bfloat16_t(-inf), bfloat16_t::from_bits(0x7F81),
+		bfloat16_t(-0.0f), bfloat16_t::from_bits(0x7F7F), bfloat16_t(1.0f)};
+	for (unsigned k = 0; k <= 7; ++k) {
+		const packed_bf16_array p = pack_bf16(x, k);
+		REQUIRE(packed_get(p, 0).is_infinity());
+		REQUIRE(packed_get(p, 1).bits() == 0xFF80);
+		if (k > 0) REQUIRE(packed_get(p, 2).is_nan());
+		else REQUIRE(packed_get(p, 2).is_infinity());
+		REQUIRE(packed_get(p, 3).bits() == 0x8000);
+		REQUIRE(packed_get(p, 5).bits() == bfloat16_t(1.0f).bits());
+	}
+	// Rounds up past the largest finite value with fewer mantissa bits
+	REQUIRE(packed_get(pack_bf16(x, 3), 4).is_infinity());
+}
+
+TEST_CASE("Packed storage range access", "[packed]") {
+	const auto x = test::random_bits(301, 2);
+	for (unsigned k : {0u, 3u, 4u, 7u}) {
+		const packed_bf16_array p = pack_bf16(x, k);
+		for (std::size_t first : {0, 1, 7, 8, 13, 290}) {
+			for (std::size_t len : {0, 1, 5, 8, 11, 40}) {
+				if (first + len > x.size()) continue;
+				std::vector<bfloat16_t> part(len);
+				std::vector<float> wide(len);
+				unpack_bf16(p, first, std::span<bfloat16_t>(part));
+				unpack_bf16(p, first, std::span<float>(wide));
+				for (std::size_t i = 0; i < len; ++i) {
+					REQUIRE(part[i].bits() == reference(x[first + i].bits(), k));
+					const float want = static_cast<float>(part[i]);
+					REQUIRE((wide[i] == want || (std::isnan(wide[i]) && std::isnan(want))));
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,90 @@
+/**
+ * @file ranges_tests.cpp
+ * @brief Tests for the chunked as_float / as_bf16 views
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <bfloat16/ranges.hpp>
+#include "test_inputs.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+#include <vector>
+
+using namespace bf16;
+
+namespace {
+
+	constexpr test::cyclic_input make_input{.period = 17, .step = 0.125f, .offset = -1.0f};
+
+}
+
+TEST_CASE("Chunked conversion views", "[ranges]") {
+	static_assert(std::ranges::forward_range<decltype(std::declval<std::vector<bfloat16_t>&>() | views::as_float)>);
+	static_assert(std::ranges::sized_range<decltype(std::declval<std::vector<float>&>() | views::as_bf16)>);
+
+	SECTION("as_float matches element-wise widening across chunk boundaries") {
+		for (std::size_t n : {0, 1, 127, 128, 129, 1000}) {
+			const auto x = make_input(n);
+			auto view = x | views::as_float;
+			REQUIRE(view.size() == n);
+			std::vector<float> out;
+			std::ranges::copy(view, std::back_inserter(out));
+			REQUIRE(out.size() == n);
+			for (std::size_t i = 0; i < n; ++i) REQUIRE(out[i] == static_cast<float>(x[i]));
+		}
+	}
+
+	SECTION("Generic algorithms run on bf16 storage") {
+		const auto x = make_input(1000);
+		auto view = x | views::as_float;
+		float expected = 0.0f;
+		for (const bfloat16_t& v : x) expected += static_cast<float>(v);
+		REQUIRE(std::accumulate(view.begin(), view.end(), 0.0f) == expected);
+
+		// Composes with the standard adaptors on either side
+		auto squares = x | std::views::take(300) | views::as_float | std::views::transform([](float v) { return v * v; });
+		float sq = 0.0f;
+		for (float v : squares) sq += v;
+		float sq_ref = 0.0f;
+		for (std::size_t i = 0; i < 300; ++i) sq_ref += static_cast<float>(x[i]) * static_cast<float>(x[i]);
+		REQUIRE(sq == sq_ref);
+	}
+
+	SECTION("Iterators far apart stay correct") {
+		const auto x = make_input(600);
+		auto view = x | views::as_float;
+		auto a = view.begin();
+		auto b = std::ranges::next(view.begin(), 500);
+		for (std::size_t i = 0; i < 100; ++i, ++a, ++b) {
+			REQUIRE(*a == static_cast<float>(x[i]));
+			REQUIRE(*b == static_cast<float>(x[i + 500]));
+		}
+	}
+
+	SECTION("Iterators outlive the view and const views iterate") {
+		const auto x = make_input(300);
+		auto it = [&x] {
+			auto view = x | views::as_float;
+			return std::ranges::next(view.begin(), 130);
+		}();
+		for (std::size_t i = 130; i < 200; ++i, ++it) REQUIRE(*it == static_cast<float>(x[i]));
+
+		const auto view = x | views::as_float;
+		static_assert(std::ranges::forward_range<decltype(view)>);
+		std::size_t i = 0;
+		for (float v : view) REQUIRE(v == static_cast<float>(x[i++]));
+		REQUIRE(i == x.size());
+	}
+
+	SECTION("as_bf16 narrows with bfloat16_t rounding") {
+		std::vector<float> f(333);
+		for (std::size_t i = 0; i < f.size(); ++i) f[i] = static_cast<float>(i) * 1.0001f + 0.3f;
+		std::vector<bfloat16_t> out(f.size());
+		std::ranges::copy(f | views::as_bf16, out.begin());
+		for (std::size_t i = 0; i < f.size(); ++i) REQUIRE(out[i].bits() == bfloat16_t(f[i]).bits());
+	}
+}
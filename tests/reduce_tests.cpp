@@ -0,0 +1,113 @@
+/**
+ * @file reduce_tests.cpp
+ * @brief Tests for dot products, sums and norms
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/elementwise.hpp>
+#include <bfloat16/reduce.hpp>
+#include "test_inputs.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinAbs;
+using Catch::Matchers::WithinRel;
+
+namespace {
+
+	constexpr test::cyclic_input make_input{.period = 13, .step = 0.125f, .offset = -0.75f, .stride = 7};
+
+	// The run-time dot out of line: inlined next to a buffer shorter than one
+	// vector, GCC flags the full-width loads of the kernel's skipped main loop
+	// under -Warray-bounds before it learns the length
+	[[gnu::noinline]] float runtime_dot(std::span<const bfloat16_t> a, std::span<const bfloat16_t> b) {
+		return dot(a, b);
+	}
+
+}
+
+TEST_CASE("Reductions", "[reduce]") {
+	SECTION("Dot and sum match a double reference") {
+		for (std::size_t n : {0, 1, 7, 16, 31, 32, 33, 64, 65, 1000}) {
+			const auto a = make_input(n, 1), b = make_input(n, 5);
+			double ref_dot = 0.0, ref_sum = 0.0, ref_ss = 0.0;
+			for (std::size_t i = 0; i < n; ++i) {
+				ref_dot += static_cast<double>(static_cast<float>(a[i])) * static_cast<float>(b[i]);
+				ref_sum += static_cast<float>(a[i]);
+				ref_ss += static_cast<double>(static_cast<float>(a[i])) * static_cast<float>(a[i]);
+			}
+			REQUIRE_THAT(dot(a, b), WithinAbs(ref_dot, 1e-4));
+			REQUIRE_THAT(sum(a), WithinAbs(ref_sum, 1e-4));
+			REQUIRE_THAT(norm(a), WithinAbs(std::sqrt(ref_ss), 1e-4));
+		}
+	}
+
+	SECTION("Fixed-length dot matches the run-time length") {
+		const auto check = [&]<std::size_t N>() {
+			const auto a = make_input(N, 3), b = make_input(N, 9);
+			std::array<bfloat16_t, N> fa{}, fb{};
+			std::copy(a.begin(), a.end(), fa.begin());
+			std::copy(b.begin(), b.end(), fb.begin());
+			const float expected = runtime_dot(a, b);
+			REQUIRE_THAT(dot<N>(fa, fb), WithinAbs(expected, 1e-4));
+			REQUIRE_THAT(dot(std::span<const bfloat16_t, N>(fa), std::span<const bfloat16_t, N>(fb)), WithinAbs(expected, 1e-4));
+		};
+		check.operator()<1>();
+		check.operator()<7>();
+		check.operator()<16>();
+		check.operator()<33>();
+		check.operator()<64>();
+		check.operator()<100>();
+		check.operator()<256>();
+		check.operator()<300>();
+	}
+
+	SECTION("Norm survives fp32 overflow of the squares") {
+		std::vector<bfloat16_t> x(40, bfloat16_t(1e30f));
+		REQUIRE(std::isinf(static_cast<float>(x[0]) * static_cast<float>(x[0])));
+		REQUIRE_THAT(norm(x), WithinRel(static_cast<float>(x[0]) * std::sqrt(40.0f), 1e-5f));
+
+		x[3] = std::numeric_limits<bfloat16_t>::infinity();
+		REQUIRE(std::isinf(norm(x)));
+		x[3] = std::numeric_limits<bfloat16_t>::quiet_NaN();
+		REQUIRE(std::isnan(norm(x)));
+	}
+
+	SECTION("Norm survives fp32 underflow of the squares") {
+		// 1e-50 squares flush to zero, but the norm itself is a normal value
+		std::vector<bfloat16_t> x(100, bfloat16_t(1e-25f));
+		REQUIRE(static_cast<float>(x[0]) * static_cast<float>(x[0]) == 0.0f);
+		REQUIRE_THAT(norm(x), WithinRel(static_cast<float>(x[0]) * 10.0f, 1e-5f));
+
+		// Subnormal inputs are scaled into range as well
+		std::vector<bfloat16_t> s(4, bfloat16_t::from_bits(0x0001));
+		REQUIRE_THAT(norm(s), WithinRel(static_cast<float>(s[0]) * 2.0f, 1e-5f));
+		REQUIRE(norm(std::vector<bfloat16_t>(5, bfloat16_t(-0.0f))) == 0.0f);
+	}
+}
+
+TEST_CASE("Elementwise exp", "[reduce][elementwise]") {
+	std::vector<bfloat16_t> x, out;
+	for (float v = -80.0f; v <= 80.0f; v += 0.37f) x.push_back(bfloat16_t(v));
+	x.push_back(std::numeric_limits<bfloat16_t>::infinity());
+	x.push_back(-std::numeric_limits<bfloat16_t>::infinity());
+	out.resize(x.size());
+	bf16::exp(x, out);
+
+	for (std::size_t i = 0; i + 2 < x.size(); ++i) {
+		const float ref = std::exp(static_cast<float>(x[i]));
+		REQUIRE_THAT(static_cast<float>(out[i]), WithinRel(ref, 1.0f / 128.0f));
+	}
+	// The argument is clamped to the normal fp32 range, so infinities saturate
+	REQUIRE(static_cast<float>(out[x.size() - 2]) > 1e38f);
+	REQUIRE(static_cast<float>(out[x.size() - 1]) >= 0.0f);
+	REQUIRE(static_cast<float>(out[x.size() - 1]) < 1e-37f);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file reproducible_tests.cpp
+ * @brief Tests for the bit-reproducible reductions and GEMM
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/denormal.hpp>
+#include <bfloat16/reproducible.hpp>
+#include "test_inputs.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinRel;
+
+namespace {
+
+	constexpr test::uniform_input<bfloat16_t> make_input{.scale = 32.0f};
+
+	// The documented order written out directly: lanes per block, the lane
+	// fold, then neighbours added level by level across blocks
+	float reference_dot(const std::vector<bfloat16_t>& a, const std::vector<bfloat16_t>* b) {
+		std::vector<float> partial;
+		for (std::size_t off = 0; off < a.size(); off += 4096) {
+			float lanes[16] = {};
+			for (std::size_t i = off; i < std::min(a.size(), off + 4096); ++i) {
+				float& lane = lanes[(i - off) % 16];
+				if (b) lane = std::fma(static_cast<float>(a[i]), static_cast<float>((*b)[i]), lane);
+				else lane += static_cast<float>(a[i]);
+			}
+			for (std::size_t w = 8; w > 0; w /= 2) {
+				for (std::size_t j = 0; j < w; ++j) lanes[j] += lanes[j + w];
+			}
+			partial.push_back(lanes[0]);
+		}
+		if (partial.empty()) return 0.0f;
+		for (std::size_t stride = 1; stride < partial.size(); stride *= 2) {
+			for (std::size_t i = 0; i + stride < partial.size(); i += 2 * stride) partial[i] += partial[i + stride];
+		}
+		return partial[0];
+	}
+
+	uint32_t bits_of(float f) {
+		return std::bit_cast<uint32_t>(f);
+	}
+
+}
+
+TEST_CASE("Reproducible reductions", "[reproducible]") {
+	SECTION("Results follow the fixed order exactly") {
+		for (std::size_t n : {0, 1, 15, 16, 17, 4095, 4096, 4097, 3 * 4096 + 5, 17 * 4096, 40 * 4096 + 123}) {
+			const auto a = make_input(n, 1), b = make_input(n, 2);
+			REQUIRE(bits_of(reproducible::sum(a)) == bits_of(reference_dot(a, nullptr)));
+			REQUIRE(bits_of(reproducible::dot(a, b)) == bits_of(reference_dot(a, &b)));
+		}
+	}
+
+	SECTION("Thread count does not change a bit") {
+		const auto a = make_input(100 * 4096 + 77, 3), b = make_input(100 * 4096 + 77, 4);
+		set_num_threads(1);
+		const float s1 = reproducible::sum(a), d1 = reproducible::dot(a, b), n1 = reproducible::norm(a);
+		for (std::size_t threads : {2, 3, 8, 128}) {
+			set_num_threads(threads);
+			REQUIRE(bits_of(reproducible::sum(a)) == bits_of(s1));
+			REQUIRE(bits_of(reproducible::dot(a, b)) == bits_of(d1));
+			REQUIRE(bits_of(reproducible::norm(a)) == bits_of(n1));
+		}
+		set_num_threads(0);
+		REQUIRE_THAT(n1, WithinRel(std::sqrt(reproducible::dot(a, a)), 1e-6f));
+	}
+
+	SECTION("Norm survives overflowing squares") {
+		std::vector<bfloat16_t> x(1000, bfloat16_t(1e30f));
+		REQUIRE_THAT(reproducible::norm(x), WithinRel(static_cast<float>(bfloat16_t(1e30f)) * std::sqrt(1000.0f), 1e-3f));
+	}
+
+	SECTION("Norm survives underflowing squares and FTZ") {
+		std::vector<bfloat16_t> tiny(100 * 4096 + 77, bfloat16_t(1e-25f));
+		const std::vector<bfloat16_t> big(2, bfloat16_t(2e38f));
+		set_num_threads(1);
+		const float n1 = reproducible::norm(tiny);
+		REQUIRE_THAT(n1, WithinRel(static_cast<float>(tiny[0]) * std::sqrt(static_cast<float>(tiny.size())), 1e-3f));
+		// The rescaled pass keeps the fixed order
+		set_num_threads(8);
+		REQUIRE(bits_of(reproducible::norm(tiny)) == bits_of(n1));
+		set_num_threads(0);
+
+		// 1 / 2e38 is an fp32 subnormal, which DAZ would read as zero
+		flush_denormals_guard guard;
+		REQUIRE_THAT(reproducible::norm(big), WithinRel(static_cast<float>(big[0]) * std::sqrt(2.0f), 1e-6f));
+		REQUIRE(bits_of(reproducible::norm(tiny)) == bits_of(n1));
+	}
+}
+
+TEST_CASE("Reproducible GEMM", "[reproducible]") {
+	const std::size_t m = 37, n = 29, k = 4096 + 300;
+	const auto a = make_input(m * k, 5), b = make_input(k * n, 6);
+
+	std::vector<float> c1(m * n), c8(m * n);
+	set_num_threads(1);
+	reproducible::gemm(m, n, k, a.data(), k, b.data(), n, c1.data(), n);
+	set_num_threads(8);
+	reproducible::gemm(m, n, k, a.data(), k, b.data(), n, c8.data(), n);
+	set_num_threads(0);
+
+	for (std::size_t i = 0; i < m; ++i) {
+		std::vector<bfloat16_t> row(a.begin() + static_cast<std::ptrdiff_t>(i * k), a.begin() + static_cast<std::ptrdiff_t>((i + 1) * k));
+		for (std::size_t j = 0; j < n; ++j) {
+			std::vector<bfloat16_t> col(k);
+			for (std::size_t p = 0; p < k; ++p) col[p] = b[p * n + j];
+			REQUIRE(bits_of(c1[i * n + j]) == bits_of(reference_dot(row, &col)));
+			REQUIRE(bits_of(c8[i * n + j]) == bits_of(c1[i * n + j]));
+		}
+	}
+
+	SECTION("Accumulate and bf16 output") {
+		std::vector<float> acc(m * n, 1.0f);
+		reproducible::gemm(m, n, k, a.data(), k, b.data(), n, acc.data(), n, true);
+		std::vector<bfloat16_t> cb(m * n);
+		reproducible::gemm(m, n, k, a.data(), k, b.data(), n, cb.data(), n);
+		for (std::size_t i = 0; i < m * n; ++i) {
+			REQUIRE(bits_of(acc[i]) == bits_of(c1[i] + 1.0f));
+			REQUIRE(cb[i].bits() == bfloat16_t(c1[i]).bits());
+		}
+	}
+}
@@ -0,0 +1,67 @@
+/**
+ * @file scan_tests.cpp
+ * @brief Tests for inclusive/exclusive prefix sums
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/scan.hpp>
+#include "test_inputs.hpp"
+#include <cstddef>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinRel;
+using Catch::Matchers::WithinAbs;
+
+namespace {
+
+	constexpr test::cyclic_input make_input{.period = 5, .step = 0.25f};
+
+	void check_scans(std::size_t n) {
+		auto x = make_input(n);
+		std::vector<float> inc(n), exc(n);
+		inclusive_scan(x, inc);
+		exclusive_scan(x, exc, 1.0f);
+
+		double running = 0.0;
+		for (std::size_t i = 0; i < n; ++i) {
+			REQUIRE_THAT(exc[i], WithinAbs(running + 1.0, running * 1e-5 + 1e-6));
+			running += static_cast<float>(x[i]);
+			REQUIRE_THAT(inc[i], WithinAbs(running, running * 1e-5 + 1e-6));
+		}
+	}
+
+}
+
+TEST_CASE("Prefix sums", "[scan]") {
+	SECTION("Short and odd lengths") {
+		for (std::size_t n : {0, 1, 15, 16, 17, 100}) check_scans(n);
+	}
+
+	SECTION("Multithreaded") {
+		set_num_threads(4);
+		check_scans(300000);
+		set_num_threads(0);
+	}
+
+	SECTION("fp32 carry does not stall") {
+		// In bf16, 256 + 1 rounds back to 256; the fp32 carry keeps counting
+		std::vector<bfloat16_t> ones(1000, bfloat16_t(1.0f));
+		std::vector<bfloat16_t> out(ones.size());
+		inclusive_scan(ones, out);
+		REQUIRE_THAT(static_cast<float>(out.back()), WithinRel(1000.0f, 0.01f));
+	}
+
+	SECTION("bf16 output narrows each prefix") {
+		auto x = make_input(50);
+		std::vector<bfloat16_t> out(x.size());
+		std::vector<float> ref(x.size());
+		exclusive_scan(x, out);
+		exclusive_scan(x, ref);
+		for (std::size_t i = 0; i < x.size(); ++i) {
+			REQUIRE(out[i].bits() == bfloat16_t(ref[i]).bits());
+		}
+	}
+}
@@ -0,0 +1,112 @@
+/**
+ * @file simd_tests.cpp
+ * @brief Tests for the data-parallel simd<N> type
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+
+#if __has_include(<experimental/simd>)
+
+#include <bfloat16/simd.hpp>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+using namespace bf16;
+
+namespace {
+
+	// Portable reference kernel, written once in data-parallel style:
+	// y = a * x + y over a ragged length
+	void axpy(float a, const std::vector<bfloat16_t>& x, std::vector<bfloat16_t>& y) {
+		using V = simd<>;
+		const V::float_type va(a);
+		std::size_t i = 0;
+		for (; i + V::size() <= x.size(); i += V::size()) {
+			V vy = V(va * V(x.data() + i) + V(y.data() + i));
+			vy.copy_to(y.data() + i);
+		}
+		const auto tail = simd_tail_mask(x.size() - i);
+		V vx(bfloat16_t::zero()), vy(bfloat16_t::zero());
+		where(tail, vx).copy_from(x.data() + i);
+		where(tail, vy).copy_from(y.data() + i);
+		vy = V(va * vx + vy);
+		where(tail, vy).copy_to(y.data() + i);
+	}
+
+}
+
+TEST_CASE("bf16 simd", "[simd]") {
+	using V = simd<16>;
+	std::vector<bfloat16_t> data(16);
+	for (std::size_t i = 0; i < 16; ++i) data[i] = bfloat16_t(static_cast<float>(i) * 0.75f - 4.0f);
+
+	SECTION("Load, widen and store round-trip") {
+		const V v(data.data());
+		const V::float_type f = v.to_float();
+		for (std::size_t i = 0; i < 16; ++i) {
+			REQUIRE(v[i].bits() == data[i].bits());
+			REQUIRE(f[i] == static_cast<float>(data[i]));
+		}
+		std::vector<bfloat16_t> out(16);
+		V(f).copy_to(out.data());
+		for (std::size_t i = 0; i < 16; ++i) REQUIRE(out[i].bits() == data[i].bits());
+	}
+
+	SECTION("Arithmetic rounds like the scalar type") {
+		const V a(data.data());
+		const V b(bfloat16_t(1.0f / 3.0f));
+		const V sum = a + b, prod = a * b, quot = a / b, neg = -a;
+		const V::float_type mixed = a * V::float_type(0.1f);
+		for (std::size_t i = 0; i < 16; ++i) {
+			REQUIRE(sum[i].bits() == (data[i] + bfloat16_t(1.0f / 3.0f)).bits());
+			REQUIRE(prod[i].bits() == (data[i] * bfloat16_t(1.0f / 3.0f)).bits());
+			REQUIRE(quot[i].bits() == (data[i] / bfloat16_t(1.0f / 3.0f)).bits());
+			REQUIRE(neg[i].bits() == (data[i].bits() ^ 0x8000));
+			REQUIRE(mixed[i] == static_cast<float>(data[i]) * 0.1f);
+		}
+	}
+
+	SECTION("Comparisons, where and reductions") {
+		V v(data.data());
+		v[3] = std::numeric_limits<bfloat16_t>::quiet_NaN();
+		const V::mask_type neg = v < V(bfloat16_t::zero());
+		REQUIRE(std::experimental::popcount(neg) == 5);  // -4, -3.25, -2.5, -1 (lane 3 is NaN), -0.25
+		REQUIRE_FALSE(neg[3]);
+		REQUIRE((v != v)[3]);
+
+		where(neg, v) = V(bfloat16_t::zero());
+		where(v > V(bfloat16_t(5.0f)), v) *= V::float_type(2.0f);
+		REQUIRE(v[0].bits() == 0);
+		REQUIRE(static_cast<float>(v[15]) == 14.5f);
+		REQUIRE(std::isnan(static_cast<float>(v[3])));
+
+		v[3] = bfloat16_t::zero();
+		float expected = 0.0f, masked = 0.0f;
+		for (std::size_t i = 0; i < 16; ++i) {
+			expected += static_cast<float>(v[i]);
+			if (i < 10) masked += static_cast<float>(v[i]);
+		}
+		REQUIRE(reduce(v) == expected);
+		REQUIRE(reduce(v, simd_tail_mask<16>(10)) == masked);
+		REQUIRE(static_cast<float>(hmax(v)) == 14.5f);
+		REQUIRE(static_cast<float>(hmin(v)) == 0.0f);
+	}
+
+	SECTION("Kernel over a ragged length") {
+		for (std::size_t n : {0, 5, 16, 37}) {
+			std::vector<bfloat16_t> x(n + 3), y(n + 3, bfloat16_t(1.0f));
+			for (std::size_t i = 0; i < x.size(); ++i) x[i] = bfloat16_t(static_cast<float>(i));
+			x.resize(n);
+			y.resize(n);
+			axpy(0.5f, x, y);
+			for (std::size_t i = 0; i < n; ++i) {
+				REQUIRE(y[i].bits() == bfloat16_t(0.5f * static_cast<float>(i) + 1.0f).bits());
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,168 @@
+/**
+ * @file solve_tests.cpp
+ * @brief Tests for the bf16 LU / Cholesky factorizations and refined solves
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <bfloat16/solve.hpp>
+#include <bfloat16/parallel.hpp>
+#include "test_inputs.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace bf16;
+
+namespace {
+
+	constexpr test::uniform_input<double> make_input{};
+
+	// Nonsymmetric, needs pivoting: random entries plus a shifted diagonal
+	// placed one row down, so the natural diagonal is small
+	std::vector<double> general_matrix(std::size_t n, uint32_t seed) {
+		auto a = make_input(n * n, seed);
+		for (std::size_t i = 0; i < n; ++i) a[i * n + (i + 1) % n] += 2.0 * std::sqrt(static_cast<double>(n));
+		return a;
+	}
+
+	template<typename Real>
+	std::vector<Real> cast(const std::vector<double>& v) {
+		return std::vector<Real>(v.begin(), v.end());
+	}
+
+	// b = A x_true in fp64, rounded to Real
+	template<typename Real>
+	std::vector<Real> rhs(std::size_t n, const std::vector<Real>& a, const std::vector<double>& x) {
+		std::vector<Real> b(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			double s = 0.0;
+			for (std::size_t j = 0; j < n; ++j) s += static_cast<double>(a[i * n + j]) * x[j];
+			b[i] = static_cast<Real>(s);
+		}
+		return b;
+	}
+
+}
+
+TEST_CASE("bf16 LU factors reproduce P A", "[solve]") {
+	for (std::size_t n : {1, 5, 64, 65, 150}) {
+		const auto a = cast<float>(general_matrix(n, 1));
+		const auto f = lu_factor(n, a.data(), n);
+		REQUIRE(f.has_value());
+
+		std::vector<float> pa(a);
+		for (std::size_t j = 0; j < n; ++j) {
+			REQUIRE(f->pivots[j] >= j);
+			for (std::size_t c = 0; c < n; ++c) std::swap(pa[j * n + c], pa[f->pivots[j] * n + c]);
+		}
+		double scale = 0.0;
+		for (float v : a) scale = std::max(scale, std::abs(static_cast<double>(v)));
+		for (std::size_t i = 0; i < n; ++i) {
+			for (std::size_t j = 0; j < n; ++j) {
+				double s = 0.0;
+				for (std::size_t p = 0; p <= std::min(i, j); ++p) {
+					const double l = p == i ? 1.0 : static_cast<float>(f->lu[i * n + p]);
+					s += l * static_cast<float>(f->lu[p * n + j]);
+				}
+				// A few bf16 roundings per element, each relative to the matrix scale
+				REQUIRE(std::abs(s - pa[i * n + j]) <= scale * 0.05);
+			}
+		}
+	}
+}
+
+TEST_CASE("bf16 Cholesky factor reproduces A", "[solve]") {
+	for (std::size_t n : {1, 7, 64, 130}) {
+		const auto a = cast<float>(test::spd_matrix(n, 2));
+		const auto f = cholesky_factor(n, a.data(), n);
+		REQUIRE(f.has_value());
+		for (std::size_t i = 0; i < n; ++i) {
+			for (std::size_t j = 0; j < n; ++j) {
+				if (j > i) {
+					REQUIRE(f->l[i * n + j].bits() == 0);
+					continue;
+				}
+				double s = 0.0;
+				for (std::size_t p = 0; p <= j; ++p) s += static_cast<double>(static_cast<float>(f->l[i * n + p])) * static_cast<float>(f->l[j * n + p]);
+				REQUIRE(std::abs(s - a[i * n + j]) <= 0.05);
+			}
+		}
+	}
+}
+
+TEST_CASE("Refined solves reach working precision", "[solve]") {
+	for (std::size_t n : {1, 9, 64, 200}) {
+		const auto x_true = make_input(n, 3);
+
+		SECTION("LU, fp32 and fp64") {
+			const auto ad = general_matrix(n, 4);
+			const auto af = cast<float>(ad);
+			const auto bf = rhs(n, af, x_true);
+			std::vector<float> xf(n);
+			const auto rf = solve_lu<float>(n, af.data(), n, bf, xf);
+			REQUIRE(rf.converged);
+			REQUIRE(rf.backward_error <= std::sqrt(static_cast<double>(n)) * 1.2e-7);
+
+			const auto bd = rhs(n, ad, x_true);
+			std::vector<double> xd(n);
+			const auto rd = solve_lu<double>(n, ad.data(), n, bd, xd);
+			REQUIRE(rd.converged);
+			REQUIRE(rd.iterations >= 1);
+			for (std::size_t i = 0; i < n; ++i) REQUIRE(std::abs(xd[i] - x_true[i]) <= 1e-12);
+		}
+
+		SECTION("Cholesky, fp32 and fp64") {
+			const auto ad = test::spd_matrix(n, 5);
+			const auto af = cast<float>(ad);
+			const auto bf = rhs(n, af, x_true);
+			std::vector<float> xf(n);
+			const auto rf = solve_cholesky<float>(n, af.data(), n, bf, xf);
+			REQUIRE(rf.converged);
+			for (std::size_t i = 0; i < n; ++i) REQUIRE(std::abs(xf[i] - x_true[i]) <= 1e-5);
+
+			const auto bd = rhs(n, ad, x_true);
+			std::vector<double> xd(n);
+			const auto rd = solve_cholesky<double>(n, ad.data(), n, bd, xd);
+			REQUIRE(rd.converged);
+			for (std::size_t i = 0; i < n; ++i) REQUIRE(std::abs(xd[i] - x_true[i]) <= 1e-12);
+		}
+	}
+}
+
+TEST_CASE("Factorizations do not depend on the thread count", "[solve]") {
+	const std::size_t n = 300;
+	const auto a = cast<float>(test::spd_matrix(n, 6));
+	const auto g = cast<float>(general_matrix(n, 7));
+
+	set_num_threads(1);
+	const auto c1 = cholesky_factor(n, a.data(), n);
+	const auto l1 = lu_factor(n, g.data(), n);
+	set_num_threads(4);
+	const auto c4 = cholesky_factor(n, a.data(), n);
+	const auto l4 = lu_factor(n, g.data(), n);
+	set_num_threads(0);
+
+	for (std::size_t i = 0; i < n * n; ++i) {
+		REQUIRE(c1->l[i].bits() == c4->l[i].bits());
+		REQUIRE(l1->lu[i].bits() == l4->lu[i].bits());
+	}
+	REQUIRE(l1->pivots == l4->pivots);
+}
+
+TEST_CASE("Singular and indefinite matrices are rejected", "[solve]") {
+	const std::size_t n = 70;
+	auto a = cast<float>(test::spd_matrix(n, 8));
+	auto singular = a;
+	for (std::size_t i = 0; i < n; ++i) singular[i * n + 5] = 0.0f;
+	REQUIRE_FALSE(lu_factor(n, singular.data(), n).has_value());
+
+	a[66 * n + 66] = -1.0f;
+	REQUIRE_FALSE(cholesky_factor(n, a.data(), n).has_value());
+
+	std::vector<float> b(n, 1.0f), x(n);
+	const auto r = solve_cholesky<float>(n, a.data(), n, b, x);
+	REQUIRE_FALSE(r.converged);
+	REQUIRE(std::isinf(r.backward_error));
+}
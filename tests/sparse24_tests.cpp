@@ -0,0 +1,114 @@
+/**
+ * @file sparse24_tests.cpp
+ * @brief Tests for 2:4 structured sparsity packing and products
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/parallel.hpp>
+#include <bfloat16/sparse24.hpp>
+#include <cstddef>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinAbs;
+
+namespace {
+
+	// Two non-zeros in every group of four, at positions that vary per group
+	std::vector<bfloat16_t> make_24(std::size_t rows, std::size_t cols) {
+		std::vector<bfloat16_t> a(rows * cols);
+		for (std::size_t i = 0; i < rows; ++i) {
+			for (std::size_t g = 0; g * 4 < cols; ++g) {
+				const std::size_t first = (i + g) % 3;
+				const std::size_t second = first + 1 + (i * g) % (3 - first);
+				for (std::size_t j : {first, second}) {
+					if (g * 4 + j < cols) {
+						a[i * cols + g * 4 + j] = bfloat16_t(static_cast<float>(static_cast<int>((i * 5 + g * 3 + j) % 11) - 5) / 4.0f + 0.125f);
+					}
+				}
+			}
+		}
+		return a;
+	}
+
+}
+
+TEST_CASE("2:4 packing", "[sparse24]") {
+	SECTION("Round trip of 2:4 input") {
+		const std::size_t rows = 5, cols = 70;
+		auto a = make_24(rows, cols);
+		auto m = pack_sparse24(rows, cols, a.data(), cols);
+
+		REQUIRE(m.values.size() == rows * 72 / 2);
+		REQUIRE(m.meta.size() == rows * 72 / 8);
+
+		std::vector<bfloat16_t> back(rows * cols);
+		unpack_sparse24(m, back.data(), cols);
+		REQUIRE(back == a);
+	}
+
+	SECTION("Dense input keeps the two largest magnitudes") {
+		std::vector<bfloat16_t> a{bfloat16_t(1.0f), bfloat16_t(-4.0f), bfloat16_t(0.5f), bfloat16_t(3.0f)};
+		auto m = pack_sparse24(1, 4, a.data(), 4);
+
+		std::vector<bfloat16_t> back(4);
+		unpack_sparse24(m, back.data(), 4);
+		REQUIRE(back[0].is_zero());
+		REQUIRE(static_cast<float>(back[1]) == -4.0f);
+		REQUIRE(back[2].is_zero());
+		REQUIRE(static_cast<float>(back[3]) == 3.0f);
+	}
+}
+
+TEST_CASE("2:4 products", "[sparse24]") {
+	const std::size_t rows = 70, cols = 100, n = 19;
+	auto a = make_24(rows, cols);
+	auto m = pack_sparse24(rows, cols, a.data(), cols);
+
+	std::vector<bfloat16_t> b(cols * n);
+	for (std::size_t i = 0; i < b.size(); ++i) b[i] = bfloat16_t(static_cast<float>(i % 13) / 13.0f - 0.5f);
+
+	SECTION("GEMV") {
+		std::vector<bfloat16_t> x(b.begin(), b.begin() + cols);
+		std::vector<float> y(rows);
+		gemv(m, x, y);
+		for (std::size_t i = 0; i < rows; ++i) {
+			float expected = 0.0f;
+			for (std::size_t k = 0; k < cols; ++k) expected += static_cast<float>(a[i * cols + k]) * static_cast<float>(x[k]);
+			REQUIRE_THAT(y[i], WithinAbs(expected, 1e-3f));
+		}
+	}
+
+	SECTION("GEMM") {
+		std::vector<float> c(rows * n);
+		gemm(m, n, b.data(), n, c.data(), n);
+		for (std::size_t i = 0; i < rows; ++i) {
+			for (std::size_t j = 0; j < n; ++j) {
+				float expected = 0.0f;
+				for (std::size_t k = 0; k < cols; ++k) expected += static_cast<float>(a[i * cols + k]) * static_cast<float>(b[k * n + j]);
+				REQUIRE_THAT(c[i * n + j], WithinAbs(expected, 1e-3f));
+			}
+		}
+	}
+}
+
+TEST_CASE("2:4 GEMV split across threads", "[sparse24][parallel]") {
+	// Enough stored values for several sparse_grain parts, with rows that do not divide evenly
+	const std::size_t rows = 301, cols = 512;
+	auto a = make_24(rows, cols);
+	auto m = pack_sparse24(rows, cols, a.data(), cols);
+	std::vector<bfloat16_t> x(cols);
+	for (std::size_t i = 0; i < cols; ++i) x[i] = bfloat16_t(static_cast<float>(i % 7) / 7.0f - 0.5f);
+
+	set_num_threads(3);
+	std::vector<float> y(rows);
+	gemv(m, x, y);
+	set_num_threads(0);
+	for (std::size_t i = 0; i < rows; ++i) {
+		float expected = 0.0f;
+		for (std::size_t k = 0; k < cols; ++k) expected += static_cast<float>(a[i * cols + k]) * static_cast<float>(x[k]);
+		REQUIRE_THAT(y[i], WithinAbs(expected, 1e-3f));
+	}
+}
@@ -0,0 +1,124 @@
+/**
+ * @file sparse_tests.cpp
+ * @brief Tests for CSR/BSR matrices and the row-partitioned executor
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/sparse.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinAbs;
+
+namespace {
+
+	// Roughly 80% zeros, with the non-zeros clustered towards the last rows
+	std::vector<bfloat16_t> make_sparse(std::size_t rows, std::size_t cols) {
+		std::vector<bfloat16_t> a(rows * cols);
+		for (std::size_t i = 0; i < rows; ++i) {
+			for (std::size_t j = 0; j < cols; ++j) {
+				if ((i * 31 + j * 17) % 5 == 0 || (i > rows / 2 && j % 3 == 0)) {
+					a[i * cols + j] = bfloat16_t(static_cast<float>(static_cast<int>((i + 2 * j) % 9) - 4) / 4.0f);
+				}
+			}
+		}
+		return a;
+	}
+
+	std::vector<bfloat16_t> make_dense(std::size_t n) {
+		std::vector<bfloat16_t> v(n);
+		for (std::size_t i = 0; i < n; ++i) v[i] = bfloat16_t(static_cast<float>(i % 7) / 7.0f - 0.5f);
+		return v;
+	}
+
+	std::vector<float> dense_product(const std::vector<bfloat16_t>& a, std::size_t rows, std::size_t cols,
+			const std::vector<bfloat16_t>& b, std::size_t n) {
+		std::vector<float> c(rows * n, 0.0f);
+		for (std::size_t i = 0; i < rows; ++i)
+			for (std::size_t k = 0; k < cols; ++k)
+				for (std::size_t j = 0; j < n; ++j)
+					c[i * n + j] += static_cast<float>(a[i * cols + k]) * static_cast<float>(b[k * n + j]);
+		return c;
+	}
+
+	template<typename Matrix>
+	void check_products(const Matrix& m, const std::vector<bfloat16_t>& a, std::size_t rows, std::size_t cols) {
+		auto x = make_dense(cols);
+		std::vector<float> y(rows);
+		spmv(m, x, y);
+		auto expected_y = dense_product(a, rows, cols, x, 1);
+		for (std::size_t i = 0; i < rows; ++i) {
+			REQUIRE_THAT(y[i], WithinAbs(expected_y[i], 1e-3f));
+		}
+
+		const std::size_t n = 21;
+		auto b = make_dense(cols * n);
+		std::vector<float> c(rows * n);
+		spmm(m, n, b.data(), n, c.data(), n);
+		auto expected_c = dense_product(a, rows, cols, b, n);
+		for (std::size_t i = 0; i < rows * n; ++i) {
+			REQUIRE_THAT(c[i], WithinAbs(expected_c[i], 1e-3f));
+		}
+	}
+
+}
+
+TEST_CASE("Sparse matrix products", "[sparse]") {
+	const std::size_t rows = 67, cols = 93;
+	auto a = make_sparse(rows, cols);
+
+	SECTION("CSR") {
+		auto m = csr_matrix::from_dense(rows, cols, a.data(), cols);
+		REQUIRE(m.row_ptr.size() == rows + 1);
+		REQUIRE(m.nnz() < rows * cols / 2);
+		check_products(m, a, rows, cols);
+	}
+
+	SECTION("BSR 1x8") {
+		check_products(bsr1x8_matrix::from_dense(rows, cols, a.data(), cols), a, rows, cols);
+	}
+
+	SECTION("BSR 4x4") {
+		check_products(bsr4x4_matrix::from_dense(rows, cols, a.data(), cols), a, rows, cols);
+	}
+
+	SECTION("Multithreaded") {
+		set_num_threads(4);
+		const std::size_t big_rows = 2000, big_cols = 300;
+		auto big = make_sparse(big_rows, big_cols);
+		auto m = csr_matrix::from_dense(big_rows, big_cols, big.data(), big_cols);
+		auto x = make_dense(big_cols);
+		std::vector<float> y(big_rows);
+		spmv(m, x, y);
+		auto expected = dense_product(big, big_rows, big_cols, x, 1);
+		for (std::size_t i = 0; i < big_rows; ++i) {
+			REQUIRE_THAT(y[i], WithinAbs(expected[i], 1e-3f));
+		}
+		set_num_threads(0);
+	}
+}
+
+TEST_CASE("Parallel executor", "[parallel]") {
+	SECTION("Partition balances weight, not rows") {
+		// Rows 0-7 hold one value each, row 8 holds 24
+		std::vector<uint32_t> prefix{0, 1, 2, 3, 4, 5, 6, 7, 8, 32};
+		auto bounds = partition_by_weight(std::span<const uint32_t>(prefix), 2);
+		REQUIRE(bounds.front() == 0);
+		REQUIRE(bounds.back() == 9);
+		REQUIRE(bounds.size() == 3);
+		REQUIRE(bounds[1] == 8);
+	}
+
+	SECTION("Every task runs once") {
+		set_num_threads(3);
+		std::vector<std::atomic<int>> hits(100);
+		parallel_for(hits.size(), [&](std::size_t t) { hits[t].fetch_add(1); });
+		for (auto& h : hits) REQUIRE(h.load() == 1);
+		set_num_threads(0);
+	}
+}
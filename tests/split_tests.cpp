@@ -0,0 +1,122 @@
+/**
+ * @file split_tests.cpp
+ * @brief Tests for three-term bf16 splits and the split float GEMM
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <bfloat16/split.hpp>
+#include "test_inputs.hpp"
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+using namespace bf16;
+
+namespace {
+
+	float joined(const split_terms& t) {
+		return (static_cast<float>(t.lo) + static_cast<float>(t.mid)) + static_cast<float>(t.hi);
+	}
+
+}
+
+TEST_CASE("Split into three bf16 terms", "[split]") {
+	SECTION("Exact, with hi the bfloat16_t rounding") {
+		for (float x : test::wide_input(5000, 1, 80)) {
+			const split_terms t = split(x);
+			REQUIRE(joined(t) == x);
+			REQUIRE(t.hi.bits() == bfloat16_t(x).bits());
+		}
+	}
+
+	SECTION("Edge values") {
+		const float max = std::numeric_limits<float>::max();
+		for (float x : {0.0f, -0.0f, 1.0f, max, -max, 3.3961e38f, 1e-30f}) {
+			const split_terms t = split(x);
+			REQUIRE(joined(t) == x);
+			REQUIRE(std::isfinite(static_cast<float>(t.hi)));
+		}
+		const float inf = std::numeric_limits<float>::infinity();
+		const split_terms t = split(-inf);
+		REQUIRE(static_cast<float>(t.hi) == -inf);
+		REQUIRE(static_cast<float>(t.mid) == 0.0f);
+		REQUIRE(static_cast<float>(t.lo) == 0.0f);
+		REQUIRE(split(std::numeric_limits<float>::quiet_NaN()).hi.is_nan());
+	}
+
+	SECTION("Bulk split and join match the scalar split") {
+		for (std::size_t n : {0, 1, 7, 8, 9, 16, 17, 100}) {
+			const auto x = test::wide_input(n, 2, 30);
+			std::vector<bfloat16_t> hi(n), mid(n), lo(n);
+			std::vector<float> back(n);
+			split(x, hi, mid, lo);
+			join(hi, mid, lo, back);
+			for (std::size_t i = 0; i < n; ++i) {
+				const split_terms t = split(x[i]);
+				REQUIRE(hi[i].bits() == t.hi.bits());
+				REQUIRE(mid[i].bits() == t.mid.bits());
+				REQUIRE(lo[i].bits() == t.lo.bits());
+				REQUIRE(back[i] == x[i]);
+			}
+		}
+	}
+}
+
+TEST_CASE("Split float GEMM", "[split]") {
+	for (std::size_t k : {0, 1, 37, 600, 1100}) {
+		const std::size_t m = 13, n = 45;
+		const auto a = test::wide_input(m * k, 3, 4), b = test::wide_input(k * n, 4, 4);
+
+		std::vector<float> c3(m * n, 5.0f), c6(m * n, 5.0f), acc(m * n, 1.0f);
+		gemm(m, n, k, a.data(), k, b.data(), n, c3.data(), n, split_passes::three);
+		gemm(m, n, k, a.data(), k, b.data(), n, c6.data(), n, split_passes::six);
+		gemm(m, n, k, a.data(), k, b.data(), n, acc.data(), n, split_passes::six, true);
+
+		for (std::size_t i = 0; i < m; ++i) {
+			for (std::size_t j = 0; j < n; ++j) {
+				double exact = 0.0, scale = 0.0;
+				for (std::size_t p = 0; p < k; ++p) {
+					exact += static_cast<double>(a[i * k + p]) * b[p * n + j];
+					scale += std::abs(static_cast<double>(a[i * k + p]) * b[p * n + j]);
+				}
+				// Error relative to sum |a * b|: fp32 accumulation for bf16x6,
+				// plus the dropped 2^-16 terms for bf16x3
+				const double tol6 = scale * 1e-6 * (1.0 + static_cast<double>(k) / 64.0);
+				const double tol3 = tol6 + scale * 1e-4;
+				REQUIRE(std::abs(c6[i * n + j] - exact) <= tol6);
+				REQUIRE(std::abs(c3[i * n + j] - exact) <= tol3);
+				REQUIRE(std::abs(acc[i * n + j] - 1.0 - exact) <= tol6 + 1e-6);
+			}
+		}
+	}
+}
+
+TEST_CASE("Split float GEMM on operands below 2^-64", "[split]") {
+	// Unscaled, every product of split terms would be below 2^-126, which
+	// vdpbf16ps flushes to zero. The GEMM scales rows of A and columns of B by
+	// powers of two, so every tier keeps the bf16x6 accuracy.
+	const std::size_t m = 5, n = 21, k = 40;
+	auto a = test::wide_input(m * k, 5, 0), b = test::wide_input(k * n, 6, 0);
+	for (float& v : a) v = std::ldexp(v, -64);
+	for (float& v : b) v = std::ldexp(v, -64);
+
+	std::vector<float> c(m * n);
+	gemm(m, n, k, a.data(), k, b.data(), n, c.data(), n, split_passes::six);
+	std::vector<float> acc = c;
+	gemm(m, n, k, a.data(), k, b.data(), n, acc.data(), n, split_passes::six, true);
+
+	for (std::size_t i = 0; i < m; ++i) {
+		for (std::size_t j = 0; j < n; ++j) {
+			double exact = 0.0, scale = 0.0;
+			for (std::size_t p = 0; p < k; ++p) {
+				exact += static_cast<double>(a[i * k + p]) * b[p * n + j];
+				scale += std::abs(static_cast<double>(a[i * k + p]) * b[p * n + j]);
+			}
+			REQUIRE(scale < 0x1p-118);
+			REQUIRE(std::abs(c[i * n + j] - exact) <= scale * 2e-6);
+			REQUIRE(std::abs(acc[i * n + j] - 2.0 * exact) <= scale * 4e-6);
+		}
+	}
+}
@@ -0,0 +1,131 @@
+/**
+ * @file stats_tests.cpp
+ * @brief Tests for streaming and merged moments
+ * @author Narayan S(Vortex)
+ */
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+#include <bfloat16/stats.hpp>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <vector>
+
+using namespace bf16;
+using Catch::Matchers::WithinRel;
+using Catch::Matchers::WithinAbs;
+
+namespace {
+
+	// Offset far from zero so naive bf16 accumulation would be useless
+	std::vector<bfloat16_t> make_samples(std::size_t n) {
+		std::vector<bfloat16_t> v(n);
+		for (std::size_t i = 0; i < n; ++i) {
+			v[i] = bfloat16_t(100.0f + static_cast<float>((i * 7919) % 61) * 0.125f);
+		}
+		return v;
+	}
+
+	struct reference {
+		double mean = 0.0, var = 0.0, skew = 0.0, kurt = 0.0;
+	};
+
+	reference reference_moments(const std::vector<bfloat16_t>& x) {
+		reference r;
+		for (auto v : x) r.mean += static_cast<float>(v);
+		r.mean /= static_cast<double>(x.size());
+		double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+		for (auto v : x) {
+			const double d = static_cast<float>(v) - r.mean;
+			m2 += d * d;
+			m3 += d * d * d;
+			m4 += d * d * d * d;
+		}
+		const double n = static_cast<double>(x.size());
+		r.var = m2 / n;
+		r.skew = std::sqrt(n) * m3 / std::pow(m2, 1.5);
+		r.kurt = n * m4 / (m2 * m2) - 3.0;
+		return r;
+	}
+
+}
+
+TEST_CASE("Running moments", "[stats]") {
+	auto x = make_samples(10007);
+	auto ref = reference_moments(x);
+
+	running_stats<true> s;
+	s.add(x);
+
+	REQUIRE(s.count() == x.size());
+	REQUIRE_THAT(s.mean(), WithinRel(ref.mean, 1e-6));
+	REQUIRE_THAT(s.variance(), WithinRel(ref.var, 1e-4));
+	REQUIRE_THAT(s.skewness(), WithinAbs(ref.skew, 1e-3));
+	REQUIRE_THAT(s.kurtosis(), WithinAbs(ref.kurt, 1e-3));
+	REQUIRE(s.min() == 100.0f);
+	REQUIRE(s.max() == 107.5f);
+
+	SECTION("Merging shards matches a single pass") {
+		// Chunk boundaries differ from the single pass, so only fp32 rounding inside chunks separates them
+		running_stats<true> a, b, c;
+		std::span<const bfloat16_t> all(x);
+		a.add(all.first(1));
+		b.add(all.subspan(1, 5000));
+		c.add(all.subspan(5001));
+		a.merge(b);
+		a.merge(c);
+
+		REQUIRE(a.count() == s.count());
+		REQUIRE_THAT(a.mean(), WithinRel(s.mean(), 1e-9));
+		REQUIRE_THAT(a.variance(), WithinRel(s.variance(), 1e-5));
+		REQUIRE_THAT(a.skewness(), WithinAbs(s.skewness(), 1e-4));
+		REQUIRE_THAT(a.kurtosis(), WithinAbs(s.kurtosis(), 1e-4));
+	}
+
+	SECTION("Single values") {
+		running_stats<> one;
+		for (auto v : std::span<const bfloat16_t>(x).first(10)) one.add(v);
+		auto r = reference_moments(std::vector<bfloat16_t>(x.begin(), x.begin() + 10));
+		REQUIRE_THAT(one.mean(), WithinRel(r.mean, 1e-9));
+		REQUIRE_THAT(one.sample_variance(), WithinRel(r.var * 10.0 / 9.0, 1e-6));
+	}
+}
+
+TEST_CASE("Parallel statistics", "[stats]") {
+	set_num_threads(4);
+	auto x = make_samples(1 << 20);
+	auto s = compute_stats(x);
+	auto ref = reference_moments(x);
+	REQUIRE(s.count() == x.size());
+	REQUIRE_THAT(s.mean(), WithinRel(ref.mean, 1e-6));
+	REQUIRE_THAT(s.variance(), WithinRel(ref.var, 1e-4));
+	set_num_threads(0);
+}
+
+TEST_CASE("NaN propagates through every statistic", "[stats]") {
+	// 40 values: indices 0-31 go through the vector body, 32-39 the scalar tail
+	for (std::size_t at : {std::size_t{5}, std::size_t{37}}) {
+		auto x = make_samples(40);
+		x[at] = bfloat16_t(std::numeric_limits<float>::quiet_NaN());
+		running_stats<> s;
+		s.add(x);
+		REQUIRE(std::isnan(s.min()));
+		REQUIRE(std::isnan(s.max()));
+		REQUIRE(std::isnan(s.mean()));
+		REQUIRE(std::isnan(s.variance()));
+
+		// Later clean data and merges in either order keep it
+		s.add(make_samples(40));
+		REQUIRE(std::isnan(s.min()));
+		running_stats<> clean;
+		clean.add(make_samples(40));
+		running_stats<> merged = clean;
+		merged.merge(s);
+		REQUIRE(std::isnan(merged.min()));
+		REQUIRE(std::isnan(merged.max()));
+		s.merge(clean);
+		REQUIRE(std::isnan(s.max()));
+	}
+}
@@ -0,0 +1,116 @@
+/**
+ * @file test_inputs.hpp
+ * @brief Deterministic input generators shared by the tests
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_TESTS_TEST_INPUTS_HPP
+#define BFLOAT16_TESTS_TEST_INPUTS_HPP
+
+#include <bfloat16/bfloat16.hpp>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bf16::test {
+
+	// v[i] = ((i * stride + seed) % period) * step + offset. Only a handful of
+	// exactly representable values, so short fp32 sums of them are exact and
+	// tests can compare against a double reference without a tolerance.
+	struct cyclic_input {
+		std::size_t period;
+		float step;
+		float offset = 0.0f;
+		std::size_t stride = 1;
+
+		std::vector<bfloat16_t> operator()(std::size_t n, std::size_t seed = 0) const {
+			std::vector<bfloat16_t> v(n);
+			for (std::size_t i = 0; i < n; ++i) {
+				v[i] = bfloat16_t(static_cast<float>((i * stride + seed) % period) * step + offset);
+			}
+			return v;
+		}
+	};
+
+	// 32-bit LCG (Numerical Recipes constants). Unlike the std:: distributions
+	// it gives the same sequence on every standard library, so tolerances tuned
+	// against one input set hold everywhere.
+	class lcg {
+		private:
+			uint32_t state;
+
+		public:
+			explicit constexpr lcg(uint32_t seed) noexcept : state(seed) {}
+
+			constexpr uint32_t next() noexcept {
+				state = state * 1664525u + 1013904223u;
+				return state;
+			}
+
+			// Uniform in [-1, 1) from the top 24 bits, exact in float
+			constexpr float uniform() noexcept {
+				return static_cast<float>(next() >> 8) / 16777216.0f * 2.0f - 1.0f;
+			}
+	};
+
+	// Uniform in [-scale, scale), rounded once to T
+	template<typename T>
+	struct uniform_input {
+		float scale = 1.0f;
+
+		std::vector<T> operator()(std::size_t n, uint32_t seed) const {
+			std::vector<T> v(n);
+			lcg rng(seed);
+			for (auto& x : v) x = static_cast<T>(rng.uniform() * scale);
+			return v;
+		}
+	};
+
+	// The given bit patterns repeated out to n values
+	template<std::size_t N>
+	std::vector<bfloat16_t> repeat_bits(std::size_t n, const uint16_t (&pattern)[N]) {
+		std::vector<bfloat16_t> v(n);
+		for (std::size_t i = 0; i < n; ++i) v[i] = bfloat16_t::from_bits(pattern[i % N]);
+		return v;
+	}
+
+	// Uniform mantissa in [-1, 1) scaled by 2^e, e uniform in
+	// [-exp_range, exp_range]: exercises every part of a multi-term split
+	inline std::vector<float> wide_input(std::size_t n, uint32_t seed, int exp_range) {
+		std::vector<float> v(n);
+		lcg rng(seed);
+		for (auto& x : v) {
+			const float mant = rng.uniform();
+			x = std::ldexp(mant, static_cast<int>(rng.next() >> 16) % (2 * exp_range + 1) - exp_range);
+		}
+		return v;
+	}
+
+	// Uniformly random bit patterns: every class, NaN payloads included
+	inline std::vector<bfloat16_t> random_bits(std::size_t n, uint32_t seed) {
+		std::vector<bfloat16_t> v(n);
+		lcg rng(seed);
+		for (auto& x : v) x = bfloat16_t::from_bits(static_cast<uint16_t>(rng.next() >> 16));
+		return v;
+	}
+
+	// Covariance-like SPD matrix X X^T / m + I from m = 2n + 8 uniform samples
+	// per row, row-major n x n
+	inline std::vector<double> spd_matrix(std::size_t n, uint32_t seed) {
+		const std::size_t m = 2 * n + 8;
+		const auto x = uniform_input<double>{}(n * m, seed);
+		std::vector<double> a(n * n);
+		for (std::size_t i = 0; i < n; ++i) {
+			for (std::size_t j = 0; j < n; ++j) {
+				double s = 0.0;
+				for (std::size_t p = 0; p < m; ++p) s += x[i * m + p] * x[j * m + p];
+				a[i * n + j] = s / static_cast<double>(m) + (i == j ? 1.0 : 0.0);
+			}
+		}
+		return a;
+	}
+
+} // namespace bf16::test
+
+#endif
@@ -0,0 +1,195 @@
+/**
+ * @file test_mdspan.hpp
+ * @brief Minimal stand-in for C++23 <mdspan> used when the standard library lacks it
+ *
+ * Covers what the mdspan overloads in bfloat16/mdspan.hpp and their tests
+ * touch: dynamic extents, layout_right / layout_left / layout_stride mappings,
+ * default_accessor and an mdspan with a multidimensional operator[]. Names
+ * and semantics follow the standard so the same test code runs against either.
+ * @author Narayan S(Vortex)
+ */
+
+#ifndef BFLOAT16_TESTS_TEST_MDSPAN_HPP
+#define BFLOAT16_TESTS_TEST_MDSPAN_HPP
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+
+namespace bf16::test {
+
+	template<typename IndexType, std::size_t Rank>
+	class dextents {
+		private:
+			std::array<IndexType, Rank> ext{};
+
+		public:
+			using index_type = IndexType;
+			using rank_type = std::size_t;
+
+			static constexpr rank_type rank() noexcept { return Rank; }
+
+			constexpr dextents() noexcept = default;
+
+			template<std::convertible_to<IndexType>... I>
+				requires(sizeof...(I) == Rank)
+			constexpr explicit dextents(I... e) noexcept : ext{static_cast<IndexType>(e)...} {}
+
+			constexpr index_type extent(rank_type r) const noexcept { return ext[r]; }
+
+			friend constexpr bool operator==(const dextents&, const dextents&) noexcept = default;
+	};
+
+	namespace detail {
+
+		template<typename Extents>
+		constexpr std::size_t product(const Extents& e) noexcept {
+			std::size_t n = 1;
+			for (std::size_t r = 0; r < Extents::rank(); ++r) n *= static_cast<std::size_t>(e.extent(r));
+			return n;
+		}
+
+		// Shared by the three layouts: a mapping is an offset from strides
+		template<typename Extents>
+		class strided_mapping {
+			protected:
+				Extents ext;
+				std::array<typename Extents::index_type, Extents::rank()> str{};
+
+			public:
+				using extents_type = Extents;
+				using index_type = typename Extents::index_type;
+
+				constexpr const extents_type& extents() const noexcept { return ext; }
+
+				constexpr index_type stride(std::size_t r) const noexcept { return str[r]; }
+
+				template<std::convertible_to<index_type>... I>
+					requires(sizeof...(I) == Extents::rank())
+				constexpr index_type operator()(I... i) const noexcept {
+					const std::array<index_type, Extents::rank()> idx{static_cast<index_type>(i)...};
+					index_type off = 0;
+					for (std::size_t r = 0; r < Extents::rank(); ++r) off += idx[r] * str[r];
+					return off;
+				}
+
+				constexpr index_type required_span_size() const noexcept {
+					if (product(ext) == 0) return 0;
+					index_type size = 1;
+					for (std::size_t r = 0; r < Extents::rank(); ++r) size += (ext.extent(r) - 1) * str[r];
+					return size;
+				}
+
+				static constexpr bool is_always_strided() noexcept { return true; }
+				static constexpr bool is_strided() noexcept { return true; }
+		};
+
+	} // namespace detail
+
+	struct layout_right {
+		template<typename Extents>
+		class mapping : public detail::strided_mapping<Extents> {
+			public:
+				constexpr explicit mapping(const Extents& e) noexcept {
+					this->ext = e;
+					typename Extents::index_type s = 1;
+					for (std::size_t r = Extents::rank(); r-- > 0;) {
+						this->str[r] = s;
+						s *= e.extent(r);
+					}
+				}
+
+				static constexpr bool is_exhaustive() noexcept { return true; }
+		};
+	};
+
+	struct layout_left {
+		template<typename Extents>
+		class mapping : public detail::strided_mapping<Extents> {
+			public:
+				constexpr explicit mapping(const Extents& e) noexcept {
+					this->ext = e;
+					typename Extents::index_type s = 1;
+					for (std::size_t r = 0; r < Extents::rank(); ++r) {
+						this->str[r] = s;
+						s *= e.extent(r);
+					}
+				}
+
+				static constexpr bool is_exhaustive() noexcept { return true; }
+		};
+	};
+
+	struct layout_stride {
+		template<typename Extents>
+		class mapping : public detail::strided_mapping<Extents> {
+			public:
+				constexpr mapping(const Extents& e, const std::array<typename Extents::index_type, Extents::rank()>& s) noexcept {
+					this->ext = e;
+					this->str = s;
+				}
+
+				// Exhaustive when the strides leave no gaps in the span
+				constexpr bool is_exhaustive() const noexcept {
+					return static_cast<std::size_t>(this->required_span_size()) == detail::product(this->ext);
+				}
+		};
+	};
+
+	template<typename ElementType>
+	struct default_accessor {
+		using offset_policy = default_accessor;
+		using element_type = ElementType;
+		using reference = ElementType&;
+		using data_handle_type = ElementType*;
+
+		constexpr default_accessor() noexcept = default;
+
+		template<typename Other>
+			requires std::convertible_to<Other (*)[], ElementType (*)[]>
+		constexpr default_accessor(default_accessor<Other>) noexcept {}
+
+		constexpr reference access(data_handle_type p, std::size_t i) const noexcept { return p[i]; }
+		constexpr data_handle_type offset(data_handle_type p, std::size_t i) const noexcept { return p + i; }
+	};
+
+	template<typename ElementType, typename Extents, typename LayoutPolicy = layout_right,
+		typename AccessorPolicy = default_accessor<ElementType>>
+	class mdspan {
+		public:
+			using extents_type = Extents;
+			using layout_type = LayoutPolicy;
+			using accessor_type = AccessorPolicy;
+			using mapping_type = typename LayoutPolicy::template mapping<Extents>;
+			using element_type = ElementType;
+			using index_type = typename Extents::index_type;
+			using data_handle_type = typename AccessorPolicy::data_handle_type;
+			using reference = typename AccessorPolicy::reference;
+
+		private:
+			data_handle_type p;
+			mapping_type map;
+			accessor_type acc;
+
+		public:
+			template<std::convertible_to<index_type>... I>
+				requires(sizeof...(I) == Extents::rank())
+			constexpr explicit mdspan(data_handle_type ptr, I... e) noexcept : p(ptr), map(extents_type(e...)), acc() {}
+
+			constexpr mdspan(data_handle_type ptr, const mapping_type& m) noexcept : p(ptr), map(m), acc() {}
+
+			template<std::convertible_to<index_type>... I>
+				requires(sizeof...(I) == Extents::rank())
+			constexpr reference operator[](I... i) const noexcept {
+				return acc.access(p, static_cast<std::size_t>(map(i...)));
+			}
+
+			constexpr const extents_type& extents() const noexcept { return map.extents(); }
+			constexpr const mapping_type& mapping() const noexcept { return map; }
+			constexpr const data_handle_type& data_handle() const noexcept { return p; }
+			constexpr const accessor_type& accessor() const noexcept { return acc; }
+	};
+
+} // namespace bf16::test
+
+#endif